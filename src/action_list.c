@@ -92,7 +92,7 @@ b3_action_list_free_impl(b3_action_t *action)
     b3_action_free(action_iter);
   }
 
-  array_destroy_cb(action_list->action_arr, NULL);
+  array_destroy(action_list->action_arr);
 
   action_list->super_action_free(action);
 
@@ -36,8 +36,6 @@
 
 static wbk_logger_t logger = { "class_condition" };
 
-#define B3_CLASS_CONDITION_CLASS_BUFFER_LENGTH 255
-
 /**
  * Implementation of b3_condition_free().
  */
@@ -50,6 +48,12 @@ b3_class_condition_free_impl(b3_condition_t *condition);
 static int
 b3_class_condition_applies_impl(b3_condition_t *condition, b3_director_t *director, b3_win_t *win);
 
+/**
+ * Implementation of b3_condition_prefilter().
+ */
+static int
+b3_class_condition_prefilter_impl(b3_condition_t *condition, b3_condition_prefilter_t *prefilter);
+
 b3_class_condition_t *
 b3_class_condition_new(const char *pattern)
 {
@@ -79,6 +83,7 @@ b3_class_condition_new(const char *pattern)
 
     class_condition->pattern_condition.condition.condition_free = b3_class_condition_free_impl;
     class_condition->pattern_condition.condition.condition_applies = b3_class_condition_applies_impl;
+    class_condition->pattern_condition.condition.condition_prefilter = b3_class_condition_prefilter_impl;
   }
 
   return class_condition;
@@ -101,53 +106,69 @@ b3_class_condition_applies_impl(b3_condition_t *condition, b3_director_t *direct
 {
   b3_class_condition_t *class_condition;
   int applies;
-	char classname[B3_CLASS_CONDITION_CLASS_BUFFER_LENGTH];
+  const char *classname;
   int pcre_rc;
   pcre *re_compiled;
   pcre_extra *re_extra;
+  b3_win_t *focused_win;
   int error;
 
   class_condition = (b3_class_condition_t *) condition;
   applies = 0;
   error = 0;
 
-  if (!error) {
-    if (b3_pattern_condition_get_use_focused_as_pattern((b3_pattern_condition_t *) class_condition)) {
-      GetClassName(b3_win_get_window_handler(b3_monitor_get_focused_win(b3_director_get_focused_monitor(director))),
-                   classname,
-                   B3_CLASS_CONDITION_CLASS_BUFFER_LENGTH);
-      error = b3_compile_pattern(classname, &re_compiled, &re_extra);
-    } else {
-      re_compiled = b3_pattern_condition_get_re_compiled((b3_pattern_condition_t *) class_condition);
-      re_extra = b3_pattern_condition_get_re_extra((b3_pattern_condition_t *) class_condition);
+  classname = b3_win_get_classname(win);
+
+  if (b3_pattern_condition_get_use_focused_as_pattern((b3_pattern_condition_t *) class_condition)) {
+    /**
+     * Rules depending on the focused window are not decided by the rule
+     * index. b3_director_add_win() evaluates them while the director is
+     * locked, so the focused window does not change meanwhile.
+     */
+    focused_win = b3_monitor_get_focused_win(b3_director_get_focused_monitor(director));
+    error = b3_pattern_condition_compile_focused((b3_pattern_condition_t *) class_condition,
+                                                 focused_win,
+                                                 focused_win ? b3_win_get_classname(focused_win) : NULL,
+                                                 &re_compiled,
+                                                 &re_extra);
+
+    if (!error) {
+      pcre_rc = pcre_exec(re_compiled,
+                          re_extra,
+                          classname,
+                          strlen(classname),
+                          0,
+                          0,
+                          NULL,
+                          0);
+      if (pcre_rc >= 0) {
+        applies = 1;
+      }
     }
+  } else {
+    applies = b3_pattern_condition_matches((b3_pattern_condition_t *) class_condition, classname);
   }
 
-  if (!error) {
-    GetClassName(b3_win_get_window_handler(win), classname, B3_CLASS_CONDITION_CLASS_BUFFER_LENGTH);
-    pcre_rc = pcre_exec(re_compiled,
-                        re_extra,
-                        classname,
-                        strlen(classname),
-                        0,
-                        0,
-                        NULL,
-                        0);
-    if (pcre_rc >= 0) {
-      applies = 1;
-    }
-  }
+  return applies;
+}
 
-  if (!error) {
-    if (b3_pattern_condition_get_use_focused_as_pattern((b3_pattern_condition_t *) class_condition)) {
-      pcre_free(re_compiled);
-#ifdef PCRE_CONFIG_JIT
-      pcre_free_study(re_extra);
-#else
-      pcre_free(re_extra);
-#endif
+int
+b3_class_condition_prefilter_impl(b3_condition_t *condition, b3_condition_prefilter_t *prefilter)
+{
+  b3_pattern_condition_t *pattern_condition;
+
+  pattern_condition = (b3_pattern_condition_t *) condition;
+
+  if (!b3_pattern_condition_get_use_focused_as_pattern(pattern_condition)) {
+    if (b3_pattern_condition_is_anchor_exact(pattern_condition)
+        && prefilter->exact_class == NULL) {
+      prefilter->exact_class = b3_pattern_condition_get_anchor(pattern_condition);
+    } else {
+      array_add(prefilter->class_condition_arr, condition);
     }
+  } else {
+    prefilter->incomplete = 1;
   }
 
-  return applies;
+  return 0;
 }
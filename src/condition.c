@@ -41,6 +41,9 @@ b3_condition_free_impl(b3_condition_t *condition);
 static int
 b3_condition_applies_impl(b3_condition_t *condition, b3_director_t *director, b3_win_t *win);
 
+static int
+b3_condition_prefilter_impl(b3_condition_t *condition, b3_condition_prefilter_t *prefilter);
+
 b3_condition_t *
 b3_condition_new(void)
 {
@@ -51,6 +54,7 @@ b3_condition_new(void)
   if (condition) {
     condition->condition_free = b3_condition_free_impl;
     condition->condition_applies = b3_condition_applies_impl;
+    condition->condition_prefilter = b3_condition_prefilter_impl;
   }
 
   return condition;
@@ -68,6 +72,12 @@ b3_condition_applies(b3_condition_t *condition, b3_director_t *director, b3_win_
   return condition->condition_applies(condition, director, win);
 }
 
+int
+b3_condition_prefilter(b3_condition_t *condition, b3_condition_prefilter_t *prefilter)
+{
+  return condition->condition_prefilter(condition, prefilter);
+}
+
 int
 b3_condition_free_impl(b3_condition_t *condition)
 {
@@ -83,3 +93,10 @@ b3_condition_applies_impl(b3_condition_t *condition, b3_director_t *director, b3
 
   return -1;
 }
+
+int
+b3_condition_prefilter_impl(b3_condition_t *condition, b3_condition_prefilter_t *prefilter)
+{
+  prefilter->incomplete = 1;
+  return 0;
+}
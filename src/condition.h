@@ -31,15 +31,50 @@
 #ifndef B3_CONDITION_H
 #define B3_CONDITION_H
 
+#include <collectc/array.h>
+
 #include "director.h"
 #include "win.h"
 
 typedef struct b3_condition_s b3_condition_t;
 
+/**
+ * Facts every window a condition applies to must fulfill. They are cheaper to
+ * check than the condition itself. Missing facts never exclude a window.
+ */
+typedef struct b3_condition_prefilter_s
+{
+  /**
+   * The class a window must have. NULL if unknown. Owned by the condition.
+   */
+  const char *exact_class;
+
+  /**
+   * Array of b3_condition_t *
+   *
+   * Conditions only depending on the class of a window.
+   */
+  Array *class_condition_arr;
+
+  /**
+   * Array of const char *
+   *
+   * Patterns the title of a window must match. Owned by the conditions.
+   */
+  Array *title_pattern_arr;
+
+  /**
+   * Non-0 if a condition is not covered by the facts above. Otherwise a window
+   * fulfilling all facts is known to fulfill the condition as well.
+   */
+  char incomplete;
+} b3_condition_prefilter_t;
+
 struct b3_condition_s
 {
   int (*condition_free)(b3_condition_t *condition);
   int (*condition_applies)(b3_condition_t *condition, b3_director_t *director, b3_win_t *win);
+  int (*condition_prefilter)(b3_condition_t *condition, b3_condition_prefilter_t *prefilter);
 };
 
 extern b3_condition_t *
@@ -54,4 +89,11 @@ b3_condition_free(b3_condition_t *condition);
 extern int
 b3_condition_applies(b3_condition_t *condition, b3_director_t *director, b3_win_t *win);
 
+/**
+ * Adds the facts known about the windows condition applies to to prefilter.
+ * The arrays of prefilter must already be allocated.
+ */
+extern int
+b3_condition_prefilter(b3_condition_t *condition, b3_condition_prefilter_t *prefilter);
+
 #endif // B3_CONDITION_H
@@ -42,6 +42,12 @@ b3_condition_and_free_impl(b3_condition_t *condition);
 static int
 b3_condition_and_applies_impl(b3_condition_t *condition, b3_director_t *director, b3_win_t *win);
 
+/**
+ * Implementation of b3_condition_prefilter().
+ */
+static int
+b3_condition_and_prefilter_impl(b3_condition_t *condition, b3_condition_prefilter_t *prefilter);
+
 static int
 b3_condition_and_add_impl(b3_condition_and_t *condition_and, b3_condition_t *new_condition);
 
@@ -63,6 +69,7 @@ b3_condition_and_new(void)
 
     condition_and->condition.condition_free = b3_condition_and_free_impl;
     condition_and->condition.condition_applies = b3_condition_and_applies_impl;
+    condition_and->condition.condition_prefilter = b3_condition_and_prefilter_impl;
 
     condition_and->condition_and_add = b3_condition_and_add_impl;
 
@@ -92,7 +99,7 @@ b3_condition_and_free_impl(b3_condition_t *condition)
     b3_condition_free(condition_iter);
   }
 
-  array_destroy_cb(condition_and->condition_arr, NULL);
+  array_destroy(condition_and->condition_arr);
 
   condition_and->super_condition_free(condition);
 
@@ -118,6 +125,26 @@ b3_condition_and_applies_impl(b3_condition_t *condition, b3_director_t *director
   return applies;
 }
 
+int
+b3_condition_and_prefilter_impl(b3_condition_t *condition, b3_condition_prefilter_t *prefilter)
+{
+  b3_condition_and_t *condition_and;
+  ArrayIter iter;
+	b3_condition_t *condition_iter;
+
+  condition_and = (b3_condition_and_t *) condition;
+
+  /**
+   * All conditions have to apply. So the facts of all of them hold.
+   */
+	array_iter_init(&iter, condition_and->condition_arr);
+	while (array_iter_next(&iter, (void*) &condition_iter) != CC_ITER_END) {
+    b3_condition_prefilter(condition_iter, prefilter);
+  }
+
+  return 0;
+}
+
 int
 b3_condition_and_add_impl(b3_condition_and_t *condition_and, b3_condition_t *new_condition)
 {
@@ -38,12 +38,29 @@
 #include "monitor.h"
 #include "ws.h"
 #include "rule.h"
+#include "rule_index.h"
+#include "win_event_queue.h"
 
 static wbk_logger_t logger = { "director" };
 
 static int
 b3_director_free_impl(b3_director_t *director);
 
+/**
+ * Adds the rules applying to win to rule_arr in the order of the rules. It
+ * must not be called while global_mutex is held.
+ *
+ * Rules whose conditions depend on the state of the director (e.g. on the
+ * focused window) cannot be decided yet. If the rule index found them, then
+ * they are added to deferred_rule_arr as well. They must be checked by
+ * b3_rule_applies() while the director is locked, before executing them.
+ *
+ * @param rule_arr Array of b3_rule_t *
+ * @param deferred_rule_arr Array of b3_rule_t *
+ */
+static int
+b3_director_find_rules(b3_director_t *director, b3_win_t *win, Array *rule_arr, Array *deferred_rule_arr);
+
 static b3_win_t *
 b3_director_get_win_at_pos_impl(b3_director_t *director, POINT *position);
 
@@ -53,6 +70,51 @@ b3_director_free_monitor_arr(b3_director_t *director);
 static int
 b3_director_free_rule_arr(b3_director_t *director);
 
+/**
+ * Frees the strings of an exclusion set and the set itself.
+ */
+static int
+b3_director_free_exclusion_table(HashTable *table);
+
+/**
+ * Adds a copy of str to an exclusion set.
+ */
+static int
+b3_director_add_exclusion(b3_director_t *director, HashTable *table, const char *str);
+
+/**
+ * Stores the location of win in the window index. An existing location is
+ * overwritten.
+ */
+static int
+b3_director_index_win(b3_director_t *director, b3_win_t *win, b3_monitor_t *monitor, b3_ws_t *ws);
+
+/**
+ * Removes win from the window index.
+ */
+static int
+b3_director_unindex_win(b3_director_t *director, const b3_win_t *win);
+
+/**
+ * Updates the monitor of all indexed windows of ws.
+ */
+static int
+b3_director_reindex_ws(b3_director_t *director, b3_ws_t *ws, b3_monitor_t *monitor);
+
+/**
+ * Removes all windows from the window index.
+ */
+static int
+b3_director_clear_win_location_table(b3_director_t *director);
+
+/**
+ * Unsynchronized version of b3_director_find_win(). The location is taken from
+ * the window index. Only if the index does not know the window or is
+ * outdated, then all workspaces are searched and the index is updated.
+ */
+static b3_ws_t *
+b3_director_locate_win(b3_director_t *director, const b3_win_t *win, b3_monitor_t **monitor);
+
 /**
  * It is only possible to set a monitor as focused, that is already available
  * in the director.
@@ -76,10 +138,29 @@ b3_director_repaint_all_threaded(_In_ LPVOID param);
 static int
 b3_director_repaint_all(void);
 
+/**
+ * Marks monitor to be arranged by the next b3_director_flush_arrange().
+ */
+static int
+b3_director_mark_monitor_dirty(b3_director_t *director, b3_monitor_t *monitor);
+
+/**
+ * Arranges the dirty monitors immediately or lets the arranger do it.
+ */
+static int
+b3_director_request_arrange(b3_director_t *director);
+
+/**
+ * Main loop of the arranger thread.
+ */
+static DWORD WINAPI
+b3_director_arranger_run(LPVOID param);
+
 b3_director_t *
 b3_director_new(b3_monitor_factory_t *monitor_factory)
 {
 	b3_director_t *director;
+	HashTableConf conf;
 
 	director = NULL;
 	director = malloc(sizeof(b3_director_t));
@@ -99,6 +180,36 @@ b3_director_new(b3_monitor_factory_t *monitor_factory)
         director->monitor_factory = monitor_factory;
 
         array_new(&(director->rule_arr));
+        director->rule_index = b3_rule_index_new();
+        director->rule_index_dirty = 0;
+        director->rule_mutex = CreateMutex(NULL, FALSE, NULL);
+#ifdef DEBUG_ENABLED
+        director->add_win_lock_ticks = 0;
+        director->add_win_count = 0;
+#endif
+
+        director->excluded_class_table = NULL;
+        hashtable_new(&(director->excluded_class_table));
+        director->excluded_title_table = NULL;
+        hashtable_new(&(director->excluded_title_table));
+        director->new_win_grace_period = B3_WIN_EVENT_QUEUE_GRACE_PERIOD;
+
+        hashtable_conf_init(&conf);
+        conf.hash = POINTER_HASH;
+        conf.key_compare = cc_common_cmp_ptr;
+        conf.key_length = KEY_LENGTH_POINTER;
+        director->win_location_table = NULL;
+        hashtable_new_conf(&conf, &(director->win_location_table));
+
+        director->layout_dirty = 0;
+        array_new(&(director->dirty_monitor_arr));
+        director->arrange_delay = B3_DIRECTOR_ARRANGE_DELAY;
+        director->arrange_event = CreateEvent(NULL, FALSE, FALSE, NULL);
+        director->arranger_thread = NULL;
+        director->arranger_running = 0;
+        director->arrange_request_count = 0;
+        director->arrange_perform_count = 0;
+        director->arrange_monitor_count = 0;
     }
 
 	return director;
@@ -125,6 +236,8 @@ b3_director_free_monitor_arr(b3_director_t *director)
 
 	director->monitor_arr = NULL;
 
+	array_remove_all(director->dirty_monitor_arr);
+
 	return 0;
 }
 
@@ -146,6 +259,45 @@ b3_director_free_rule_arr(b3_director_t *director)
   return 0;
 }
 
+int
+b3_director_free_exclusion_table(HashTable *table)
+{
+	HashTableIter iter;
+	TableEntry *entry;
+
+	hashtable_iter_init(&iter, table);
+	while (hashtable_iter_next(&iter, &entry) != CC_ITER_END) {
+		free(entry->key);
+	}
+
+	hashtable_destroy(table);
+
+	return 0;
+}
+
+int
+b3_director_add_exclusion(b3_director_t *director, HashTable *table, const char *str)
+{
+	char *copy;
+	int error;
+
+	error = 0;
+
+	WaitForSingleObject(director->global_mutex, INFINITE);
+
+	if (!hashtable_contains_key(table, (void *) str)) {
+		copy = strdup(str);
+		if (copy == NULL || hashtable_add(table, copy, copy) != CC_OK) {
+			free(copy);
+			error = 1;
+		}
+	}
+
+	ReleaseMutex(director->global_mutex);
+
+	return error;
+}
+
 int
 b3_director_refresh(b3_director_t *director)
 {
@@ -157,6 +309,11 @@ b3_director_refresh(b3_director_t *director)
 	b3_director_free_monitor_arr(director);
 	array_new(&(director->monitor_arr));
 
+	/**
+	 * The locations are found again on their next use.
+	 */
+	b3_director_clear_win_location_table(director);
+
 	EnumDisplayMonitors(NULL, NULL, b3_director_enum_monitors, (LPARAM) director);
 
    	b3_director_repaint_all();
@@ -333,7 +490,7 @@ b3_director_switch_to_ws(b3_director_t *director, const char *ws_id)
   b3_monitor_set_focused_ws(director->focused_monitor, ws_id);
   focused_win = b3_ws_get_focused_win(b3_monitor_get_focused_ws(b3_director_get_focused_monitor(director)));
 
-  b3_director_arrange_wins(director);
+  b3_director_arrange_monitor(director, director->focused_monitor);
 
   wbk_logger_log(&logger, INFO, "Switching to workspace %s.\n", ws_id);
   if (focused_win) {
@@ -352,15 +509,70 @@ b3_director_switch_to_ws(b3_director_t *director, const char *ws_id)
 int
 b3_director_add_rule(b3_director_t *director, b3_rule_t *rule)
 {
-	WaitForSingleObject(director->global_mutex, INFINITE);
+	WaitForSingleObject(director->rule_mutex, INFINITE);
 
   array_add(director->rule_arr, rule);
+  director->rule_index_dirty = 1;
 
-  ReleaseMutex(director->global_mutex);
+  ReleaseMutex(director->rule_mutex);
 
   return 0;
 }
 
+int
+b3_director_compile_rules(b3_director_t *director)
+{
+	int error;
+
+	WaitForSingleObject(director->rule_mutex, INFINITE);
+
+	error = b3_rule_index_compile(director->rule_index, director->rule_arr);
+	if (!error) {
+		director->rule_index_dirty = 0;
+	}
+
+	ReleaseMutex(director->rule_mutex);
+
+	return error;
+}
+
+int
+b3_director_exclude_class(b3_director_t *director, const char *classname)
+{
+	return b3_director_add_exclusion(director, director->excluded_class_table, classname);
+}
+
+int
+b3_director_exclude_title(b3_director_t *director, const char *title)
+{
+	return b3_director_add_exclusion(director, director->excluded_title_table, title);
+}
+
+int
+b3_director_is_class_excluded(b3_director_t *director, const char *classname)
+{
+	return hashtable_contains_key(director->excluded_class_table, (void *) classname);
+}
+
+int
+b3_director_is_title_excluded(b3_director_t *director, const char *title)
+{
+	return hashtable_contains_key(director->excluded_title_table, (void *) title);
+}
+
+int
+b3_director_set_new_win_grace_period(b3_director_t *director, DWORD grace_period)
+{
+	director->new_win_grace_period = grace_period;
+	return 0;
+}
+
+DWORD
+b3_director_get_new_win_grace_period(b3_director_t *director)
+{
+	return director->new_win_grace_period;
+}
+
 int
 b3_director_add_win(b3_director_t *director, const char *monitor_name, b3_win_t *win)
 {
@@ -369,8 +581,28 @@ b3_director_add_win(b3_director_t *director, const char *monitor_name, b3_win_t
 	char found;
 	int error;
   b3_rule_t *rule;
+  b3_rule_t *deferred_rule;
+  Array *rule_arr;
+  Array *deferred_rule_arr;
+  int deferred_pos;
+#ifdef DEBUG_ENABLED
+  LARGE_INTEGER start;
+  LARGE_INTEGER end;
+#endif
+
+  array_new(&rule_arr);
+  array_new(&deferred_rule_arr);
+
+  /**
+   * The window is not known to anybody else yet. So the rules are searched and
+   * evaluated on its cached attributes without blocking the director.
+   */
+  b3_director_find_rules(director, win, rule_arr, deferred_rule_arr);
 
 	WaitForSingleObject(director->global_mutex, INFINITE);
+#ifdef DEBUG_ENABLED
+	QueryPerformanceCounter(&start);
+#endif
 
 	found = 0;
 	array_iter_init(&iter, director->monitor_arr);
@@ -383,41 +615,76 @@ b3_director_add_win(b3_director_t *director, const char *monitor_name, b3_win_t
   error = 1;
   if (found) {
     error = b3_monitor_add_win(monitor, win);
+    if (!error) {
+      b3_director_index_win(director, win, monitor, b3_monitor_get_focused_ws(monitor));
+    }
 
-    array_iter_init(&iter, director->rule_arr);
+    /**
+     * Deferred rules depend on the director, e.g. on the focused window, which
+     * is only known after win was added. Like all rules before, they are
+     * checked in the order of the rules, since executing a rule might change
+     * the focus.
+     */
+    deferred_pos = 0;
+    deferred_rule = NULL;
+    array_get_at(deferred_rule_arr, deferred_pos, (void *) &deferred_rule);
+
+    array_iter_init(&iter, rule_arr);
     while (array_iter_next(&iter, (void*) &rule) != CC_ITER_END) {
-      if (b3_rule_applies(rule, director, win)) {
+      if (rule == deferred_rule) {
+        deferred_pos++;
+        deferred_rule = NULL;
+        array_get_at(deferred_rule_arr, deferred_pos, (void *) &deferred_rule);
+
+        WaitForSingleObject(director->rule_mutex, INFINITE);
+        if (!b3_rule_applies(rule, director, win)) {
+          rule = NULL;
+        }
+        ReleaseMutex(director->rule_mutex);
+      }
+
+      if (rule) {
         b3_rule_exec(rule, director, win);
       }
     }
   }
 
   if (!error) {
-		b3_director_arrange_wins(director);
+		b3_director_arrange_monitor(director, monitor);
   }
 
+#ifdef DEBUG_ENABLED
+	QueryPerformanceCounter(&end);
+	director->add_win_lock_ticks += end.QuadPart - start.QuadPart;
+	director->add_win_count++;
+#endif
+
 	ReleaseMutex(director->global_mutex);
 
+  array_destroy(deferred_rule_arr);
+  array_destroy(rule_arr);
+
 	return error;
 }
 
 int
 b3_director_remove_win(b3_director_t *director, b3_win_t *win)
 {
-	ArrayIter iter;
 	b3_monitor_t *monitor;
+	b3_ws_t *ws;
 	int error;
 
 	WaitForSingleObject(director->global_mutex, INFINITE);
 
 	error = 1;
-	array_iter_init(&iter, director->monitor_arr);
-    while (error && array_iter_next(&iter, (void*) &monitor) != CC_ITER_END) {
-    	error = b3_monitor_remove_win(monitor, win);
-    }
+	ws = b3_director_locate_win(director, win, &monitor);
+	if (ws) {
+		error = b3_ws_remove_win(ws, win);
+		b3_director_unindex_win(director, win);
+	}
 
     if (!error) {
-    	b3_director_arrange_wins(director);
+    	b3_director_arrange_monitor(director, monitor);
     }
 
 	ReleaseMutex(director->global_mutex);
@@ -425,6 +692,131 @@ b3_director_remove_win(b3_director_t *director, b3_win_t *win)
     return error;
 }
 
+b3_ws_t *
+b3_director_find_win(b3_director_t *director, const b3_win_t *win, b3_monitor_t **monitor)
+{
+	b3_ws_t *ws;
+
+	WaitForSingleObject(director->global_mutex, INFINITE);
+
+	ws = b3_director_locate_win(director, win, monitor);
+
+	ReleaseMutex(director->global_mutex);
+
+	return ws;
+}
+
+int
+b3_director_index_win(b3_director_t *director, b3_win_t *win, b3_monitor_t *monitor, b3_ws_t *ws)
+{
+	b3_director_win_location_t *location;
+
+	location = NULL;
+	if (hashtable_get(director->win_location_table,
+					  b3_win_get_window_handler(win),
+					  (void *) &location) != CC_OK) {
+		location = malloc(sizeof(b3_director_win_location_t));
+		hashtable_add(director->win_location_table,
+					  b3_win_get_window_handler(win),
+					  location);
+	}
+
+	location->monitor = monitor;
+	location->ws = ws;
+
+	return 0;
+}
+
+int
+b3_director_unindex_win(b3_director_t *director, const b3_win_t *win)
+{
+	b3_director_win_location_t *location;
+
+	location = NULL;
+	hashtable_remove(director->win_location_table,
+					 b3_win_get_window_handler((b3_win_t *) win),
+					 (void *) &location);
+	free(location);
+
+	return 0;
+}
+
+int
+b3_director_reindex_ws(b3_director_t *director, b3_ws_t *ws, b3_monitor_t *monitor)
+{
+	HashTableIter iter;
+	TableEntry *entry;
+	b3_director_win_location_t *location;
+
+	hashtable_iter_init(&iter, director->win_location_table);
+	while (hashtable_iter_next(&iter, &entry) != CC_ITER_END) {
+		location = entry->value;
+		if (location->ws == ws) {
+			location->monitor = monitor;
+		}
+	}
+
+	return 0;
+}
+
+int
+b3_director_clear_win_location_table(b3_director_t *director)
+{
+	HashTableIter iter;
+	TableEntry *entry;
+
+	hashtable_iter_init(&iter, director->win_location_table);
+	while (hashtable_iter_next(&iter, &entry) != CC_ITER_END) {
+		free(entry->value);
+	}
+
+	hashtable_remove_all(director->win_location_table);
+
+	return 0;
+}
+
+b3_ws_t *
+b3_director_locate_win(b3_director_t *director, const b3_win_t *win, b3_monitor_t **monitor)
+{
+	b3_director_win_location_t *location;
+	ArrayIter iter;
+	b3_monitor_t *monitor_iter;
+	b3_ws_t *ws;
+
+	ws = NULL;
+	monitor_iter = NULL;
+
+	location = NULL;
+	hashtable_get(director->win_location_table,
+				  b3_win_get_window_handler((b3_win_t *) win),
+				  (void *) &location);
+	if (location && b3_ws_contains_win(location->ws, win)) {
+		ws = location->ws;
+		monitor_iter = location->monitor;
+	} else {
+		array_iter_init(&iter, director->monitor_arr);
+		while (!ws && array_iter_next(&iter, (void*) &monitor_iter) != CC_ITER_END) {
+			ws = b3_monitor_find_win(monitor_iter, win);
+		}
+
+		if (ws) {
+			wbk_logger_log(&logger, DEBUG, "Window was not indexed - indexing it now\n");
+			b3_director_index_win(director, (b3_win_t *) win, monitor_iter, ws);
+		} else {
+			monitor_iter = NULL;
+			if (location) {
+				b3_director_unindex_win(director, win);
+			}
+		}
+	}
+
+	if (monitor) {
+		*monitor = monitor_iter;
+	}
+
+	return ws;
+}
+
 int
 b3_director_arrange_wins(b3_director_t *director)
 {
@@ -434,23 +826,169 @@ b3_director_arrange_wins(b3_director_t *director)
 
 	WaitForSingleObject(director->global_mutex, INFINITE);
 
-	error = 0;
 	array_iter_init(&iter, director->monitor_arr);
-    while (!error && array_iter_next(&iter, (void*) &monitor) != CC_ITER_END) {
-		error = b3_monitor_arrange_wins(monitor);
+    while (array_iter_next(&iter, (void*) &monitor) != CC_ITER_END) {
+		b3_director_mark_monitor_dirty(director, monitor);
     }
 
+	error = b3_director_request_arrange(director);
+
     ReleaseMutex(director->global_mutex);
 
 	return error;
 }
 
 int
-b3_director_set_active_win(b3_director_t *director, b3_win_t *win)
+b3_director_arrange_monitor(b3_director_t *director, b3_monitor_t *monitor)
+{
+	int error;
+
+	WaitForSingleObject(director->global_mutex, INFINITE);
+
+	b3_director_mark_monitor_dirty(director, monitor);
+
+	error = b3_director_request_arrange(director);
+
+    ReleaseMutex(director->global_mutex);
+
+	return error;
+}
+
+int
+b3_director_mark_monitor_dirty(b3_director_t *director, b3_monitor_t *monitor)
+{
+	if (monitor && !array_contains(director->dirty_monitor_arr, monitor)) {
+		array_add(director->dirty_monitor_arr, monitor);
+	}
+
+	return 0;
+}
+
+int
+b3_director_request_arrange(b3_director_t *director)
+{
+	int error;
+
+	director->arrange_request_count++;
+	director->layout_dirty = 1;
+
+	error = 0;
+	if (director->arranger_running) {
+		SetEvent(director->arrange_event);
+	} else {
+		error = b3_director_flush_arrange(director);
+	}
+
+	return error;
+}
+
+int
+b3_director_flush_arrange(b3_director_t *director)
 {
 	ArrayIter iter;
 	b3_monitor_t *monitor;
-	char found;
+	int error;
+
+	WaitForSingleObject(director->global_mutex, INFINITE);
+
+	error = 0;
+	if (director->layout_dirty) {
+		director->layout_dirty = 0;
+		director->arrange_perform_count++;
+
+		/**
+		 * Iterate the managed monitors instead of the dirty ones to keep their
+		 * order.
+		 */
+		array_iter_init(&iter, director->monitor_arr);
+		while (!error && array_iter_next(&iter, (void*) &monitor) != CC_ITER_END) {
+			if (array_contains(director->dirty_monitor_arr, monitor)) {
+				director->arrange_monitor_count++;
+				error = b3_monitor_arrange_wins(monitor);
+			}
+		}
+
+		array_remove_all(director->dirty_monitor_arr);
+
+#ifdef DEBUG_ENABLED
+		wbk_logger_log(&logger, DEBUG, "Arrangements requested: %d, performed: %d, monitors arranged: %d\n",
+					   director->arrange_request_count,
+					   director->arrange_perform_count,
+					   director->arrange_monitor_count);
+#endif
+	}
+
+    ReleaseMutex(director->global_mutex);
+
+	return error;
+}
+
+int
+b3_director_start_arranger(b3_director_t *director)
+{
+	int error;
+
+	WaitForSingleObject(director->global_mutex, INFINITE);
+
+	error = 1;
+	if (!director->arranger_running) {
+		director->arranger_running = 1;
+		director->arranger_thread = CreateThread(NULL,
+												 0,
+												 b3_director_arranger_run,
+												 (LPVOID) director,
+												 0,
+												 NULL);
+		if (director->arranger_thread) {
+			error = 0;
+		} else {
+			wbk_logger_log(&logger, SEVERE, "Unable to start the arranger\n");
+			director->arranger_running = 0;
+		}
+	}
+
+    ReleaseMutex(director->global_mutex);
+
+	return error;
+}
+
+int
+b3_director_stop_arranger(b3_director_t *director)
+{
+	HANDLE arranger_thread;
+	int error;
+
+	WaitForSingleObject(director->global_mutex, INFINITE);
+
+	arranger_thread = NULL;
+	if (director->arranger_running) {
+		director->arranger_running = 0;
+		arranger_thread = director->arranger_thread;
+		director->arranger_thread = NULL;
+		SetEvent(director->arrange_event);
+	}
+
+    ReleaseMutex(director->global_mutex);
+
+	error = 1;
+	if (arranger_thread) {
+		/**
+		 * The mutex must not be held here, the arranger needs it to finish a
+		 * running arrangement.
+		 */
+		WaitForSingleObject(arranger_thread, INFINITE);
+		CloseHandle(arranger_thread);
+
+		error = b3_director_flush_arrange(director);
+	}
+
+	return error;
+}
+
+int
+b3_director_set_active_win(b3_director_t *director, b3_win_t *win)
+{
+	b3_monitor_t *monitor;
 	b3_ws_t *ws;
 	b3_win_t *found_win;
 	int ret;
@@ -458,17 +996,13 @@ b3_director_set_active_win(b3_director_t *director, b3_win_t *win)
 	if (!director->ignore_set_foucsed_win) {
 	WaitForSingleObject(director->global_mutex, INFINITE);
 
-		found = 0;
-		array_iter_init(&iter, director->monitor_arr);
-		while (!found && array_iter_next(&iter, (void*) &monitor) != CC_ITER_END) {
-			ws = b3_monitor_find_win(monitor, win);
-			if (ws) {
-				found_win = b3_ws_contains_win(ws, win);
-				found = 1;
-			}
+		found_win = NULL;
+		ws = b3_director_locate_win(director, win, &monitor);
+		if (ws) {
+			found_win = b3_ws_contains_win(ws, win);
 		}
 
-		if (found) {
+		if (found_win) {
 			wbk_logger_log(&logger, DEBUG, "Updating active window\n");
 			b3_ws_set_focused_win(ws, found_win);
 
@@ -507,7 +1041,7 @@ b3_director_active_win_toggle_floating(b3_director_t *director)
                                                        active_win);
 		if (!toggle_failed) {
 			wbk_logger_log(&logger, INFO, "Toggled floating on focused window.\n");
-			b3_monitor_arrange_wins(director->focused_monitor);
+			b3_director_arrange_monitor(director, director->focused_monitor);
 		} else {
 			wbk_logger_log(&logger, SEVERE, "Unable to toggle floating on focused window.\n");
         }
@@ -544,7 +1078,8 @@ b3_director_move_active_win_to_ws(b3_director_t *director, const char *ws_id)
 		}
 
 		if (!found) {
-			ws = b3_wsman_add(b3_monitor_get_wsman(director->focused_monitor), ws_id);
+			monitor = director->focused_monitor;
+			ws = b3_wsman_add(b3_monitor_get_wsman(monitor), ws_id);
 		}
 
 		ret = 1;
@@ -554,10 +1089,22 @@ b3_director_move_active_win_to_ws(b3_director_t *director, const char *ws_id)
 
 				b3_win_set_state(active_win, NORMAL);
 				b3_ws_add_win(ws, active_win);
+				b3_director_index_win(director, active_win, monitor, ws);
+				if (ws != b3_monitor_get_focused_ws(monitor)) {
+					/**
+					 * Arranging the monitor only minimizes the windows of a
+					 * workspace when it becomes hidden.
+					 */
+					b3_win_minimize(active_win);
+				}
 
 				active_win = b3_monitor_get_focused_win(b3_director_get_focused_monitor(director));
 
-				b3_director_arrange_wins(director);
+				/**
+				 * The monitor the window was removed from is already marked by
+				 * b3_director_remove_win().
+				 */
+				b3_director_arrange_monitor(director, monitor);
 
 				if (active_win) {
 					/**
@@ -601,7 +1148,7 @@ b3_director_move_active_win(b3_director_t *director, b3_ws_move_direction_t dire
 			error = b3_ws_move_focused_win(b3_monitor_get_focused_ws(director->focused_monitor),
 										   direction);
       if (!error) {
-        b3_director_arrange_wins(director);
+        b3_director_arrange_monitor(director, director->focused_monitor);
       } else {
           /**
            * Try changing to the other monitor then
@@ -640,7 +1187,7 @@ b3_director_set_active_win_by_direction(b3_director_t *director, b3_ws_move_dire
     						  win);
 		director->ignore_set_foucsed_win = 1;
 		b3_director_w32_set_active_window(b3_win_get_window_handler(win), 0);
-		b3_director_arrange_wins(director);
+		b3_director_arrange_monitor(director, director->focused_monitor);
         error = 0;
 	} else {
         /**
@@ -661,7 +1208,7 @@ b3_director_set_active_win_by_direction(b3_director_t *director, b3_ws_move_dire
                                       win);
                 director->ignore_set_foucsed_win = 1;
                 b3_director_w32_set_active_window(b3_win_get_window_handler(win), 0);
-                b3_director_arrange_wins(director);
+                b3_director_arrange_monitor(director, director->focused_monitor);
                 error = 0;
             }
         }
@@ -687,7 +1234,7 @@ b3_director_toggle_active_win_fullscreen(b3_director_t *director)
     	} else {
     		b3_win_set_state(active_win, NORMAL);
     	}
-		b3_director_arrange_wins(director);
+		b3_director_arrange_monitor(director, director->focused_monitor);
     } else {
 		wbk_logger_log(&logger, INFO, "No focused window available to toggle fullscreen.\n");
     }
@@ -780,6 +1327,11 @@ b3_director_move_focused_ws_to_monitor_by_dir(b3_director_t *director, b3_ws_mov
 		focused_ws = b3_wsman_get_focused_ws(old_focused_wsman);
 		b3_wsman_remove(old_focused_wsman, b3_ws_get_name(focused_ws));
 		b3_wsman_add(new_focused_wsman, b3_ws_get_name(focused_ws));
+		b3_director_reindex_ws(director, focused_ws, monitor);
+		/**
+		 * The monitor losing the workspace shows another one now.
+		 */
+		b3_director_arrange_monitor(director, b3_director_get_focused_monitor(director));
 		b3_director_switch_to_ws(director, b3_ws_get_name(focused_ws));
 
 		wbk_logger_log(&logger, INFO, "Moving workspace to the monitor in direction %d\n", direction);
@@ -971,11 +1523,17 @@ b3_director_move_win_to_ws(b3_director_t *director, b3_win_t *win, const char *w
 
   if (!error) {
     b3_ws_add_win(ws, win);
-    b3_director_arrange_wins(director);
+    b3_director_index_win(director, win, monitor, ws);
+    b3_director_arrange_monitor(director, monitor);
   }
 
   b3_director_switch_to_ws(director, b3_ws_get_name(focused_ws));
 
+  if (!error && ws != b3_monitor_get_focused_ws(monitor)) {
+    /** The window was moved to a hidden workspace */
+    b3_win_minimize(win);
+  }
+
 	ReleaseMutex(director->global_mutex);
 
   return error;
@@ -1105,12 +1663,29 @@ b3_director_repaint_all(void)
 int
 b3_director_free_impl(b3_director_t *director)
 {
+	b3_director_stop_arranger(director);
+	CloseHandle(director->arrange_event);
+
 	ReleaseMutex(director->global_mutex);
 	CloseHandle(director->global_mutex);
+	CloseHandle(director->rule_mutex);
 
 	director->focused_monitor = NULL;
 
 	b3_director_free_monitor_arr(director);
+	array_destroy(director->dirty_monitor_arr);
+
+	b3_director_free_exclusion_table(director->excluded_class_table);
+	director->excluded_class_table = NULL;
+	b3_director_free_exclusion_table(director->excluded_title_table);
+	director->excluded_title_table = NULL;
+
+	b3_rule_index_free(director->rule_index);
+	director->rule_index = NULL;
+
+	b3_director_clear_win_location_table(director);
+	hashtable_destroy(director->win_location_table);
+	director->win_location_table = NULL;
 
 	director->monitor_factory = NULL;
 
@@ -1134,3 +1709,69 @@ b3_director_get_win_at_pos_impl(b3_director_t *director, POINT *position)
 
     return win_at_pos;
 }
+
+DWORD WINAPI
+b3_director_arranger_run(LPVOID param)
+{
+	b3_director_t *director;
+
+	director = (b3_director_t *) param;
+
+	while (director->arranger_running) {
+		WaitForSingleObject(director->arrange_event, INFINITE);
+
+		if (director->arranger_running) {
+			/**
+			 * Collect all requests of the current burst of events (e.g. a
+			 * window being created and focused) into one arrangement.
+			 */
+			Sleep(director->arrange_delay);
+
+			b3_director_flush_arrange(director);
+		}
+	}
+
+	return 0;
+}
+
+int
+b3_director_find_rules(b3_director_t *director, b3_win_t *win, Array *rule_arr, Array *deferred_rule_arr)
+{
+	ArrayIter iter;
+	Array *entry_arr;
+	b3_rule_index_entry_t *entry;
+
+	WaitForSingleObject(director->rule_mutex, INFINITE);
+
+	if (director->rule_index_dirty) {
+		b3_director_compile_rules(director);
+	}
+
+	array_new(&entry_arr);
+	b3_rule_index_find_candidate_entries(director->rule_index, director, win, entry_arr);
+
+	/**
+	 * The index already matched the conditions of decided rules. Undecided
+	 * rules whose prefilter is complete only depend on win, e.g. if the
+	 * pattern set refused one of their title patterns.
+	 */
+	array_iter_init(&iter, entry_arr);
+	while (array_iter_next(&iter, (void *) &entry) != CC_ITER_END) {
+		if (entry->decided) {
+			array_add(rule_arr, entry->rule);
+		} else if (!entry->prefilter.incomplete) {
+			if (b3_rule_applies(entry->rule, director, win)) {
+				array_add(rule_arr, entry->rule);
+			}
+		} else {
+			array_add(rule_arr, entry->rule);
+			array_add(deferred_rule_arr, entry->rule);
+		}
+	}
+
+	array_destroy(entry_arr);
+
+	ReleaseMutex(director->rule_mutex);
+
+	return 0;
+}
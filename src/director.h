@@ -32,13 +32,35 @@
 #define B3_DIRECTOR_H
 
 #include <collectc/array.h>
+#include <collectc/hashtable.h>
 #include <windows.h>
 
 #include "monitor_factory.h"
 #include "win.h"
 #include "director_ws_switcher.h"
 
+/**
+ * Time in milliseconds the arranger collects requests before arranging the
+ * windows. It is about one frame.
+ */
+#define B3_DIRECTOR_ARRANGE_DELAY 16
+
 typedef struct b3_director_s  b3_director_t;
+typedef struct b3_rule_index_s b3_rule_index_t;
+
+/**
+ * Location of a window managed by the director.
+ */
+typedef struct b3_director_win_location_s
+{
+	b3_monitor_t *monitor;
+
+	/**
+	 * The workspace containing the window. The container of the window within
+	 * the workspace is found by the indexes of the workspace.
+	 */
+	b3_ws_t *ws;
+} b3_director_win_location_t;
 
 struct b3_director_s
 {
@@ -72,6 +94,108 @@ struct b3_director_s
 	 * Array of b3_rule_t *
 	 */
 	Array *rule_arr;
+
+	/**
+	 * Index of rule_arr. It is compiled by b3_director_compile_rules().
+	 */
+	b3_rule_index_t *rule_index;
+
+	/**
+	 * Non-0 if rules were added since the last compilation of rule_index.
+	 */
+	char rule_index_dirty;
+
+	/**
+	 * Guards rule_arr, rule_index and the evaluation of the rules.
+	 *
+	 * Lock order: rule_mutex may be acquired while global_mutex is held, but
+	 * global_mutex is never acquired while rule_mutex is held.
+	 */
+	HANDLE rule_mutex;
+
+#ifdef DEBUG_ENABLED
+	/**
+	 * Performance counter ticks global_mutex was held by
+	 * b3_director_add_win() and the number of added windows.
+	 */
+	LONGLONG add_win_lock_ticks;
+	int add_win_count;
+#endif
+
+	/**
+	 * HashTable of char * -> char *
+	 *
+	 * Set of the class names of windows that are never managed. Key and value
+	 * are the same copy of the class name, owned by the director.
+	 */
+	HashTable *excluded_class_table;
+
+	/**
+	 * HashTable of char * -> char *
+	 *
+	 * Set of the titles of windows that are never managed. Key and value are
+	 * the same copy of the title, owned by the director.
+	 */
+	HashTable *excluded_title_table;
+
+	/**
+	 * Time in milliseconds a created window is held back by the window
+	 * watcher. See b3_director_set_new_win_grace_period().
+	 */
+	DWORD new_win_grace_period;
+
+	/**
+	 * HashTable of HWND -> b3_director_win_location_t *
+	 *
+	 * Index of all managed windows by their window handler. It is updated by
+	 * every adding, removing and moving of a window or a workspace.
+	 */
+	HashTable *win_location_table;
+
+	/**
+	 * Non-0 if the windows have to be arranged. It is set by
+	 * b3_director_arrange_wins() and cleared by b3_director_flush_arrange().
+	 */
+	char layout_dirty;
+
+	/**
+	 * Array of b3_monitor_t *
+	 *
+	 * The monitors whose windows have to be arranged by the next
+	 * b3_director_flush_arrange(). Each monitor is contained at most once.
+	 */
+	Array *dirty_monitor_arr;
+
+	/**
+	 * Time in milliseconds the arranger waits after an arrangement was
+	 * requested. All requests within that time result in one arrangement.
+	 */
+	DWORD arrange_delay;
+
+	/**
+	 * Auto-reset event signaled if an arrangement was requested or the
+	 * arranger should stop.
+	 */
+	HANDLE arrange_event;
+
+	HANDLE arranger_thread;
+	char arranger_running;
+
+	/**
+	 * Number of calls of b3_director_arrange_wins() and
+	 * b3_director_arrange_monitor().
+	 */
+	int arrange_request_count;
+
+	/**
+	 * Number of arrangements actually performed.
+	 */
+	int arrange_perform_count;
+
+	/**
+	 * Number of monitors arranged by all performed arrangements.
+	 */
+	int arrange_monitor_count;
 };
 
 /**
@@ -128,6 +252,74 @@ extern int
 b3_director_add_rule(b3_director_t *director, b3_rule_t *rule);
 
 /**
+ * Compiles the rules into the index used to find the rules applying to a new
+ * window. Call it after all rules were added. Otherwise the rules are
+ * compiled when the next window is added.
+ *
+ * @return 0 if the compilation succeeded. Non-0 otherwise.
+ */
+extern int
+b3_director_compile_rules(b3_director_t *director);
+
+/**
+ * Windows of the class classname will never be managed. The class name must
+ * match exactly.
+ *
+ * Exclusions must be added before windows are checked by the window watcher,
+ * e.g. while parsing the configuration file. The lookups are not
+ * synchronized.
+ *
+ * @param classname Will be copied.
+ * @return 0 if added. Non-0 otherwise.
+ */
+extern int
+b3_director_exclude_class(b3_director_t *director, const char *classname);
+
+/**
+ * Windows having the title will never be managed. The title must match
+ * exactly.
+ *
+ * Exclusions must be added before windows are checked by the window watcher,
+ * e.g. while parsing the configuration file. The lookups are not
+ * synchronized.
+ *
+ * @param title Will be copied.
+ * @return 0 if added. Non-0 otherwise.
+ */
+extern int
+b3_director_exclude_title(b3_director_t *director, const char *title);
+
+/**
+ * @return Non-0 if windows of the class classname are never managed.
+ */
+extern int
+b3_director_is_class_excluded(b3_director_t *director, const char *classname);
+
+/**
+ * @return Non-0 if windows having the title are never managed.
+ */
+extern int
+b3_director_is_title_excluded(b3_director_t *director, const char *title);
+
+/**
+ * Sets the time in milliseconds a created window is held back by the window
+ * watcher. Windows destroyed within it are never managed. It must be set
+ * before the window watcher is created, e.g. while parsing the configuration
+ * file.
+ *
+ * @param grace_period 0 manages all windows immediately.
+ */
+extern int
+b3_director_set_new_win_grace_period(b3_director_t *director, DWORD grace_period);
+
+extern DWORD
+b3_director_get_new_win_grace_period(b3_director_t *director);
+
+/**
+ * The rules applying to win are found before the director is locked. Only the
+ * rules depending on the director (e.g. on the focused window) are evaluated
+ * after win was added and focused, while the director is locked.
+ *
  * @param win The object will be freed by the director.
  * @return 0 if added. Non-0 otherwise.
  */
@@ -141,9 +333,59 @@ b3_director_add_win(b3_director_t *director, const char *monitor_name, b3_win_t
 extern int
 b3_director_remove_win(b3_director_t *director, b3_win_t *win);
 
+/**
+ * Searches for the workspace containing a window.
+ *
+ * @param monitor If not NULL, it is set to the monitor of the workspace.
+ * @return The workspace containing the window or NULL if the window is not
+ * managed by the director. Do not free it!
+ */
+extern b3_ws_t *
+b3_director_find_win(b3_director_t *director, const b3_win_t *win, b3_monitor_t **monitor);
+
+/**
+ * Requests the windows of all monitors to be arranged. If the arranger is
+ * running, then the windows are arranged once after arrange_delay, no matter
+ * how often this was called in the meantime. Otherwise they are arranged
+ * immediately.
+ */
 extern int
 b3_director_arrange_wins(b3_director_t *director);
 
+/**
+ * Requests the windows of a single monitor to be arranged. Use it instead of
+ * b3_director_arrange_wins() if an operation only changed that monitor.
+ *
+ * @param monitor A monitor managed by the director.
+ */
+extern int
+b3_director_arrange_monitor(b3_director_t *director, b3_monitor_t *monitor);
+
+/**
+ * Arranges the windows of all monitors requested since the last arrangement.
+ *
+ * @return 0 if the windows were arranged or nothing was requested. Non-0
+ * otherwise.
+ */
+extern int
+b3_director_flush_arrange(b3_director_t *director);
+
+/**
+ * Starts the thread coalescing the requests of b3_director_arrange_wins().
+ *
+ * @return 0 if the arranger was started. Non-0 otherwise.
+ */
+extern int
+b3_director_start_arranger(b3_director_t *director);
+
+/**
+ * Stops the arranger and performs a pending arrangement.
+ *
+ * @return 0 if the arranger was stopped. Non-0 otherwise.
+ */
+extern int
+b3_director_stop_arranger(b3_director_t *director);
+
 /**
  * Sets the active window of the director. Internally this will update the
  * currently focused window of the currently focused workspace through the
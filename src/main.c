@@ -43,6 +43,7 @@
 #include "parser.h"
 #include "director.h"
 #include "win_watcher.h"
+#include "win_positioner.h"
 
 #define B3_GETOPT_OPTIONS "dvV"
 
@@ -156,10 +157,16 @@ parameterized_main(void)
 	b3_action_factory_t *action_factory;
 	b3_parser_t *parser;
 	b3_win_watcher_t *win_watcher;
+	b3_win_positioner_t *win_positioner;
 	wbk_kbman_t *g_kbman;
 	int i;
 
 	error = 0;
+	win_watcher = NULL;
+
+	win_positioner = b3_win_positioner_new(b3_win_batch_apply, NULL);
+	b3_win_set_positioner(win_positioner);
+	b3_win_positioner_start(win_positioner);
 
 	win_factory = b3_win_factory_new();
 	ws_factory = b3_ws_factory_new();
@@ -226,6 +233,10 @@ parameterized_main(void)
 	 */
 	if (!error) {
 		win_watcher = b3_win_watcher_new(win_factory, g_director);
+		if (win_watcher == NULL) {
+			wbk_logger_log(&logger, SEVERE, "Could not create the window watcher\n");
+			error = 1;
+		}
 	}
 
 	/**
@@ -238,13 +249,13 @@ parameterized_main(void)
 		b3_director_switch_to_ws(g_director,
 								 b3_ws_get_name(b3_monitor_get_focused_ws(b3_director_get_focused_monitor(g_director))));
 
+		b3_director_start_arranger(g_director);
 	}
 
 	/**
 	 * Start win watcher
 	 */
 	if (!error) {
-		b3_win_watcher_set_threaded(win_watcher, 1);
 		b3_win_watcher_start(win_watcher);
 	}
 
@@ -267,8 +278,6 @@ parameterized_main(void)
 	 * Start main loops
 	 */
 	if (!error) {
-		b3_win_watcher_set_threaded(win_watcher, 0);
-
 		main_loop();
 
 		b3_win_watcher_stop(win_watcher);
@@ -310,6 +319,9 @@ parameterized_main(void)
 	b3_ws_factory_free(ws_factory);
 	b3_win_factory_free(win_factory);
 
+	b3_win_set_positioner(NULL);
+	b3_win_positioner_free(win_positioner);
+
 	return error;
 }
 
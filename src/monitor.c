@@ -38,6 +38,7 @@ static wbk_logger_t logger = { "monitor" };
 typedef struct b3_monitor_arrange_wins_comm_s
 {
   b3_monitor_t *monitor;
+  b3_ws_t *focused_ws;
 } b3_monitor_arrange_wins_comm_t;
 
 /**
@@ -52,8 +53,15 @@ b3_monitor_arrange_wins_ws_visitor(b3_ws_t *ws);
 void
 b3_monitor_arrange_wins_ws_visitor(b3_ws_t *ws)
 {
-  if (strcmp(b3_ws_get_name(ws),
-             b3_ws_get_name(b3_monitor_get_focused_ws(g_arrange_comm.monitor)))) {
+  b3_ws_t *visible_ws;
+
+  /**
+   * Only minimize the windows of a workspace that just became hidden. On the
+   * first arrangement every workspace but the focused one is hidden.
+   */
+  visible_ws = g_arrange_comm.monitor->visible_ws;
+  if (ws != g_arrange_comm.focused_ws
+      && (visible_ws == NULL || ws == visible_ws)) {
     b3_ws_minimize_wins(ws);
   }
 }
@@ -90,6 +98,8 @@ b3_monitor_new(const char *monitor_name,
 		monitor->wsman = b3_wsman_factory_create(wsman_factory);
 
 		monitor->bar = b3_bar_new(monitor->monitor_name, monitor->monitor_area, monitor->wsman, ws_switcher);
+
+		monitor->visible_ws = NULL;
 	}
 
 	return monitor;
@@ -128,7 +138,25 @@ b3_monitor_contains_ws(b3_monitor_t *monitor, const char *ws_id)
 int
 b3_monitor_set_focused_ws(b3_monitor_t *monitor, const char *ws_id)
 {
-	return b3_wsman_set_focused_ws(monitor->wsman, ws_id);
+	b3_ws_t *left_ws;
+	int ret;
+
+	left_ws = b3_wsman_get_focused_ws(monitor->wsman);
+
+	ret = b3_wsman_set_focused_ws(monitor->wsman, ws_id);
+
+	if (monitor->visible_ws
+		&& left_ws != monitor->visible_ws
+		&& left_ws != b3_wsman_get_focused_ws(monitor->wsman)) {
+		/**
+		 * The workspace was focused without being arranged in between. It
+		 * never becomes hidden for b3_monitor_arrange_wins(), so minimize the
+		 * windows opened on it meanwhile now.
+		 */
+		b3_ws_minimize_wins(left_ws);
+	}
+
+	return ret;
 }
 
 b3_ws_t *
@@ -206,9 +234,13 @@ b3_monitor_arrange_wins(b3_monitor_t *monitor)
 	}
 
   g_arrange_comm.monitor = monitor;
-  b3_wsman_iterate_ws_arr(monitor->wsman, b3_monitor_arrange_wins_ws_visitor);
+  g_arrange_comm.focused_ws = b3_monitor_get_focused_ws(monitor);
+  if (monitor->visible_ws != g_arrange_comm.focused_ws) {
+    b3_wsman_iterate_ws_arr(monitor->wsman, b3_monitor_arrange_wins_ws_visitor);
+    monitor->visible_ws = g_arrange_comm.focused_ws;
+  }
 
-	b3_ws_arrange_wins(b3_monitor_get_focused_ws(monitor), monitor_area);
+	b3_ws_arrange_wins(g_arrange_comm.focused_ws, monitor_area);
 
 	return 0;
 }
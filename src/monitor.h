@@ -55,6 +55,13 @@ struct b3_monitor_s
 	b3_wsman_t *wsman;
 
 	b3_bar_t *bar;
+
+	/**
+	 * The workspace whose windows were shown by the last
+	 * b3_monitor_arrange_wins(). NULL if the monitor was never arranged. It may
+	 * no longer be managed by wsman, so only compare it.
+	 */
+	b3_ws_t *visible_ws;
 };
 
 /**
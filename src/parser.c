@@ -125,6 +125,8 @@ b3_parser_parse(b3_parser_t *parser, b3_director_t *director, yyscan_t scanner)
               scanner)) {
 		wbk_kbman_free(kbman);
 		kbman = NULL;
+	} else {
+		b3_director_compile_rules(director);
 	}
 
 	return kbman;
@@ -35,6 +35,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
 #include <w32bindkeys/logger.h>
 #include <w32bindkeys/be.h>
 #include <w32bindkeys/b.h>
@@ -53,6 +54,7 @@
 #include "condition_and.h"
 #include "action_list.h"
 #include "rule.h"
+#include "win_event_queue.h"
 
 #define B3_WORD_BUFFER_LEN 256
 
@@ -278,6 +280,8 @@ typedef void* yyscan_t;
 %token               TOKEN_TO
 %token               TOKEN_OUTPUT
 %token               TOKEN_FOR_WINDOW
+%token               TOKEN_NO_MANAGE
+%token               TOKEN_NEW_WINDOW_GRACE_PERIOD
 %token               TOKEN_TITLE
 %token               TOKEN_CLASS
 %token               TOKEN_COMMENT
@@ -316,6 +320,8 @@ comment: TOKEN_COMMENT ;
 statement:
 bindsym
 | for_window 
+| no_manage
+| new_window_grace_period
 ;
 
 bindsym: TOKEN_BINDSYM TOKEN_SPACE binding TOKEN_SPACE bindsym-cmd
@@ -497,6 +503,42 @@ action-command:
   action-cmd-move
 ;
 
+no_manage:
+  TOKEN_NO_MANAGE TOKEN_SPACE TOKEN_BRACKET_OPEN no_manage-condition TOKEN_BRACKET_CLOSE
+;
+
+no_manage-condition:
+  TOKEN_TITLE TOKEN_EQUAL TOKEN_DOUBLE_QUOTES text TOKEN_DOUBLE_QUOTES
+  { b3_director_exclude_title(*director, g_text); free(g_text); g_text = NULL; }
+| TOKEN_CLASS TOKEN_EQUAL TOKEN_DOUBLE_QUOTES text TOKEN_DOUBLE_QUOTES
+  { b3_director_exclude_class(*director, g_text); free(g_text); g_text = NULL; }
+;
+
+new_window_grace_period:
+  TOKEN_NEW_WINDOW_GRACE_PERIOD TOKEN_SPACE text
+{
+  char msg[256];
+  char *end;
+  long grace_period;
+
+  errno = 0;
+  grace_period = strtol(g_text, &end, 10);
+  if (errno || end == g_text || *end != '\0'
+      || grace_period < 0 || grace_period > B3_WIN_EVENT_QUEUE_MAX_GRACE_PERIOD) {
+    snprintf(msg, sizeof(msg), "Invalid new_window_grace_period (0 - %d): %s",
+             B3_WIN_EVENT_QUEUE_MAX_GRACE_PERIOD, g_text);
+    free(g_text);
+    g_text = NULL;
+    yyerror(*kc_director_factory, *condition_factory, *action_factory, *director, *kbman, scanner, msg);
+    YYERROR;
+  }
+
+  b3_director_set_new_win_grace_period(*director, (DWORD) grace_period);
+  free(g_text);
+  g_text = NULL;
+}
+;
+
 action-cmd-move:
 //  TOKEN_MOVE TOKEN_SPACE bindsym-cmd-move-direction
   TOKEN_MOVE TOKEN_SPACE action-cmd-move-container
@@ -598,6 +640,10 @@ word-in-text: TOKEN_MODIFIER
               { strcpy(g_word, "output"); }
             | TOKEN_FOR_WINDOW
               { strcpy(g_word, "for_window"); }
+            | TOKEN_NO_MANAGE
+              { strcpy(g_word, "no_manage"); }
+            | TOKEN_NEW_WINDOW_GRACE_PERIOD
+              { strcpy(g_word, "new_window_grace_period"); }
             | TOKEN_TITLE
               { strcpy(g_word, "title"); }
             | TOKEN_CLASS
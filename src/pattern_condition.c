@@ -59,6 +59,34 @@ b3_pattern_condition_get_re_extra_impl(b3_pattern_condition_t *pattern_condition
 static char
 b3_pattern_condition_get_use_focused_as_pattern_impl(b3_pattern_condition_t *pattern_condition);
 
+static const char *
+b3_pattern_condition_get_pattern_impl(b3_pattern_condition_t *pattern_condition);
+
+static b3_pattern_kind_t
+b3_pattern_condition_get_kind_impl(b3_pattern_condition_t *pattern_condition);
+
+static int
+b3_pattern_condition_matches_impl(b3_pattern_condition_t *pattern_condition, const char *subject);
+
+static const char *
+b3_pattern_condition_get_anchor_impl(b3_pattern_condition_t *pattern_condition);
+
+static char
+b3_pattern_condition_is_anchor_exact_impl(b3_pattern_condition_t *pattern_condition);
+
+static int
+b3_pattern_condition_compile_focused_impl(b3_pattern_condition_t *pattern_condition,
+                                          b3_win_t *focused_win,
+                                          const char *subject,
+                                          pcre **re_compiled,
+                                          pcre_extra **re_extra);
+
+/**
+ * Frees the pattern compiled from the focused window.
+ */
+static int
+b3_pattern_condition_release_focused(b3_pattern_condition_t *pattern_condition);
+
 b3_pattern_condition_t *
 b3_pattern_condition_new(const char *pattern)
 {
@@ -66,6 +94,10 @@ b3_pattern_condition_new(const char *pattern)
   pcre *re_compiled;
   pcre_extra *re_extra;
   char use_focused_as_pattern;
+  char *anchor;
+  char anchor_exact;
+  b3_pattern_kind_t kind;
+  char *literal;
   b3_pattern_condition_t *pattern_condition;
   b3_condition_t *condition;
 
@@ -74,9 +106,19 @@ b3_pattern_condition_new(const char *pattern)
   re_compiled = NULL;
   re_extra = NULL;
   use_focused_as_pattern = 0;
+  anchor = NULL;
+  anchor_exact = 0;
+  kind = PATTERN_REGEX;
+  literal = NULL;
 
   if (strcmp(pattern, B3_PATTERN_CONDITION_PATTERN_FOCUSED)) {
-    error = b3_compile_pattern(pattern, &re_compiled, &re_extra);
+    kind = b3_classify_pattern(pattern, &literal);
+    if (kind == PATTERN_REGEX) {
+      error = b3_compile_pattern(pattern, &re_compiled, &re_extra);
+    }
+    if (!error) {
+      anchor = b3_find_pattern_anchor(pattern, &anchor_exact);
+    }
   } else {
     use_focused_as_pattern = 1;
   }
@@ -107,10 +149,31 @@ b3_pattern_condition_new(const char *pattern)
     pattern_condition->pattern_condition_get_re_compiled = b3_pattern_condition_get_re_compiled_impl;
     pattern_condition->pattern_condition_get_re_extra = b3_pattern_condition_get_re_extra_impl;
     pattern_condition->pattern_condition_get_use_focused_as_pattern = b3_pattern_condition_get_use_focused_as_pattern_impl;
+    pattern_condition->pattern_condition_get_pattern = b3_pattern_condition_get_pattern_impl;
+    pattern_condition->pattern_condition_get_kind = b3_pattern_condition_get_kind_impl;
+    pattern_condition->pattern_condition_matches = b3_pattern_condition_matches_impl;
+    pattern_condition->pattern_condition_get_anchor = b3_pattern_condition_get_anchor_impl;
+    pattern_condition->pattern_condition_is_anchor_exact = b3_pattern_condition_is_anchor_exact_impl;
+    pattern_condition->pattern_condition_compile_focused = b3_pattern_condition_compile_focused_impl;
 
     pattern_condition->re_compiled = re_compiled;
     pattern_condition->re_extra = re_extra;
     pattern_condition->use_focused_as_pattern = use_focused_as_pattern;
+    pattern_condition->pattern = malloc(sizeof(char) * (strlen(pattern) + 1));
+    strcpy(pattern_condition->pattern, pattern);
+    pattern_condition->kind = kind;
+    pattern_condition->literal = literal;
+    pattern_condition->literal_length = literal ? strlen(literal) : 0;
+    pattern_condition->anchor = anchor;
+    pattern_condition->anchor_exact = anchor_exact;
+    pattern_condition->focused_handle = B3_WIN_HANDLE_NULL;
+    pattern_condition->focused_title_version = 0;
+    pattern_condition->focused_re_compiled = NULL;
+    pattern_condition->focused_re_extra = NULL;
+    pattern_condition->focused_compile_count = 0;
+  } else {
+    free(anchor);
+    free(literal);
   }
 
   return pattern_condition;
@@ -134,6 +197,50 @@ b3_pattern_condition_get_use_focused_as_pattern(b3_pattern_condition_t *pattern_
   return pattern_condition->pattern_condition_get_use_focused_as_pattern(pattern_condition);
 }
 
+const char *
+b3_pattern_condition_get_pattern(b3_pattern_condition_t *pattern_condition)
+{
+  return pattern_condition->pattern_condition_get_pattern(pattern_condition);
+}
+
+b3_pattern_kind_t
+b3_pattern_condition_get_kind(b3_pattern_condition_t *pattern_condition)
+{
+  return pattern_condition->pattern_condition_get_kind(pattern_condition);
+}
+
+int
+b3_pattern_condition_matches(b3_pattern_condition_t *pattern_condition, const char *subject)
+{
+  return pattern_condition->pattern_condition_matches(pattern_condition, subject);
+}
+
+const char *
+b3_pattern_condition_get_anchor(b3_pattern_condition_t *pattern_condition)
+{
+  return pattern_condition->pattern_condition_get_anchor(pattern_condition);
+}
+
+char
+b3_pattern_condition_is_anchor_exact(b3_pattern_condition_t *pattern_condition)
+{
+  return pattern_condition->pattern_condition_is_anchor_exact(pattern_condition);
+}
+
+int
+b3_pattern_condition_compile_focused(b3_pattern_condition_t *pattern_condition,
+                                     b3_win_t *focused_win,
+                                     const char *subject,
+                                     pcre **re_compiled,
+                                     pcre_extra **re_extra)
+{
+  return pattern_condition->pattern_condition_compile_focused(pattern_condition,
+                                                              focused_win,
+                                                              subject,
+                                                              re_compiled,
+                                                              re_extra);
+}
+
 int
 b3_pattern_condition_free_impl(b3_condition_t *condition)
 {
@@ -141,6 +248,17 @@ b3_pattern_condition_free_impl(b3_condition_t *condition)
 
   pattern_condition = (b3_pattern_condition_t *) condition;
 
+  free(pattern_condition->pattern);
+  pattern_condition->pattern = NULL;
+
+  free(pattern_condition->literal);
+  pattern_condition->literal = NULL;
+
+  b3_pattern_condition_release_focused(pattern_condition);
+
+  free(pattern_condition->anchor);
+  pattern_condition->anchor = NULL;
+
   pcre_free(pattern_condition->re_compiled);
 #ifdef PCRE_CONFIG_JIT
   pcre_free_study(pattern_condition->re_extra);
@@ -176,3 +294,123 @@ b3_pattern_condition_get_use_focused_as_pattern_impl(b3_pattern_condition_t *pat
 {
   return pattern_condition->use_focused_as_pattern;
 }
+
+const char *
+b3_pattern_condition_get_pattern_impl(b3_pattern_condition_t *pattern_condition)
+{
+  return pattern_condition->pattern;
+}
+
+b3_pattern_kind_t
+b3_pattern_condition_get_kind_impl(b3_pattern_condition_t *pattern_condition)
+{
+  return pattern_condition->kind;
+}
+
+int
+b3_pattern_condition_matches_impl(b3_pattern_condition_t *pattern_condition, const char *subject)
+{
+  int matches;
+
+  if (pattern_condition->kind == PATTERN_REGEX) {
+    matches = pcre_exec(pattern_condition->re_compiled,
+                        pattern_condition->re_extra,
+                        subject,
+                        strlen(subject),
+                        0,
+                        0,
+                        NULL,
+                        0) >= 0;
+  } else {
+    matches = b3_match_literal(pattern_condition->kind,
+                               pattern_condition->literal,
+                               pattern_condition->literal_length,
+                               subject,
+                               strlen(subject));
+  }
+
+  return matches;
+}
+
+const char *
+b3_pattern_condition_get_anchor_impl(b3_pattern_condition_t *pattern_condition)
+{
+  return pattern_condition->anchor;
+}
+
+char
+b3_pattern_condition_is_anchor_exact_impl(b3_pattern_condition_t *pattern_condition)
+{
+  return pattern_condition->anchor_exact;
+}
+
+int
+b3_pattern_condition_compile_focused_impl(b3_pattern_condition_t *pattern_condition,
+                                          b3_win_t *focused_win,
+                                          const char *subject,
+                                          pcre **re_compiled,
+                                          pcre_extra **re_extra)
+{
+  int error;
+  char *escaped;
+
+  error = 0;
+
+  if (focused_win == NULL) {
+    error = 1;
+  }
+
+  /**
+   * Windows without a handle cannot be told apart. Their patterns are
+   * compiled every time.
+   */
+  if (!error
+      && (pattern_condition->focused_re_compiled == NULL
+          || b3_win_get_handle(focused_win) == B3_WIN_HANDLE_NULL
+          || b3_win_get_handle(focused_win) != pattern_condition->focused_handle
+          || b3_win_get_title_version(focused_win) != pattern_condition->focused_title_version)) {
+    b3_pattern_condition_release_focused(pattern_condition);
+
+    escaped = b3_escape_pattern(subject);
+    error = b3_compile_pattern(escaped,
+                               &(pattern_condition->focused_re_compiled),
+                               &(pattern_condition->focused_re_extra));
+    free(escaped);
+
+    pattern_condition->focused_compile_count++;
+
+    if (!error) {
+      pattern_condition->focused_handle = b3_win_get_handle(focused_win);
+      pattern_condition->focused_title_version = b3_win_get_title_version(focused_win);
+    }
+  }
+
+  if (!error) {
+    *re_compiled = pattern_condition->focused_re_compiled;
+    *re_extra = pattern_condition->focused_re_extra;
+  }
+
+  return error;
+}
+
+int
+b3_pattern_condition_release_focused(b3_pattern_condition_t *pattern_condition)
+{
+  if (pattern_condition->focused_re_compiled) {
+    pcre_free(pattern_condition->focused_re_compiled);
+    pattern_condition->focused_re_compiled = NULL;
+  }
+
+  if (pattern_condition->focused_re_extra) {
+#ifdef PCRE_CONFIG_JIT
+    pcre_free_study(pattern_condition->focused_re_extra);
+#else
+    pcre_free(pattern_condition->focused_re_extra);
+#endif
+    pattern_condition->focused_re_extra = NULL;
+  }
+
+  pattern_condition->focused_handle = B3_WIN_HANDLE_NULL;
+
+  return 0;
+}
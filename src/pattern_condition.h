@@ -38,6 +38,7 @@
 #include <pcre.h>
 
 #include "director.h"
+#include "utils.h"
 #include "win.h"
 
 /**
@@ -57,11 +58,56 @@ struct b3_pattern_condition_s
   pcre *(*pattern_condition_get_re_compiled)(b3_pattern_condition_t *pattern_condition);
   pcre_extra *(*pattern_condition_get_re_extra)(b3_pattern_condition_t *pattern_condition);
   char (*pattern_condition_get_use_focused_as_pattern)(b3_pattern_condition_t *pattern_condition);
+  const char *(*pattern_condition_get_pattern)(b3_pattern_condition_t *pattern_condition);
+  b3_pattern_kind_t (*pattern_condition_get_kind)(b3_pattern_condition_t *pattern_condition);
+  int (*pattern_condition_matches)(b3_pattern_condition_t *pattern_condition, const char *subject);
+  const char *(*pattern_condition_get_anchor)(b3_pattern_condition_t *pattern_condition);
+  char (*pattern_condition_is_anchor_exact)(b3_pattern_condition_t *pattern_condition);
+  int (*pattern_condition_compile_focused)(b3_pattern_condition_t *pattern_condition,
+                                           b3_win_t *focused_win,
+                                           const char *subject,
+                                           pcre **re_compiled,
+                                           pcre_extra **re_extra);
 
   pcre *re_compiled;
   pcre_extra *re_extra;
 
   char use_focused_as_pattern;
+
+  char *pattern;
+
+  /**
+   * Only patterns of the kind PATTERN_REGEX are compiled. The others are
+   * matched by their literal.
+   */
+  b3_pattern_kind_t kind;
+  char *literal;
+  int literal_length;
+
+  /**
+   * Literal every string matching the pattern contains. NULL if the pattern
+   * has none or the focused window is used as pattern.
+   */
+  char *anchor;
+
+  /**
+   * Non-0 if only the anchor itself matches the pattern.
+   */
+  char anchor_exact;
+
+  /**
+   * The pattern compiled from the focused window. It is valid as long as the
+   * handle and the title version of the focused window do not change.
+   */
+  b3_win_handle_t focused_handle;
+  unsigned int focused_title_version;
+  pcre *focused_re_compiled;
+  pcre_extra *focused_re_extra;
+
+  /**
+   * Number of patterns compiled from focused windows.
+   */
+  int focused_compile_count;
 };
 
 extern b3_pattern_condition_t *
@@ -76,4 +122,56 @@ b3_pattern_condition_get_re_extra(b3_pattern_condition_t *pattern_condition);
 extern char
 b3_pattern_condition_get_use_focused_as_pattern(b3_pattern_condition_t *pattern_condition);
 
+/**
+ * @return The pattern the condition was created with. Do not free it!
+ */
+extern const char *
+b3_pattern_condition_get_pattern(b3_pattern_condition_t *pattern_condition);
+
+/**
+ * @return The kind of the pattern. Patterns using the focused window are
+ * PATTERN_REGEX.
+ */
+extern b3_pattern_kind_t
+b3_pattern_condition_get_kind(b3_pattern_condition_t *pattern_condition);
+
+/**
+ * Matches the pattern against subject. The pattern must not use the focused
+ * window.
+ *
+ * @return Non-0 if the pattern matches subject.
+ */
+extern int
+b3_pattern_condition_matches(b3_pattern_condition_t *pattern_condition, const char *subject);
+
+/**
+ * @return The literal every string matching the pattern contains or NULL if
+ * it is unknown. Do not free it!
+ */
+extern const char *
+b3_pattern_condition_get_anchor(b3_pattern_condition_t *pattern_condition);
+
+/**
+ * @return Non-0 if only the anchor itself matches the pattern.
+ */
+extern char
+b3_pattern_condition_is_anchor_exact(b3_pattern_condition_t *pattern_condition);
+
+/**
+ * Compiles a pattern matching subject literally. The pattern is cached until
+ * another window is focused or the title of the focused window changes.
+ *
+ * @param focused_win The focused window. Can be NULL.
+ * @param subject The string of focused_win to match (e.g. its title).
+ * @param re_compiled Will receive the compiled regex. Do not free it!
+ * @param re_extra Will receive the compiled extra. Do not free it!
+ * @return 0 if the compilation succeeded. Non-0 otherwise.
+ */
+extern int
+b3_pattern_condition_compile_focused(b3_pattern_condition_t *pattern_condition,
+                                     b3_win_t *focused_win,
+                                     const char *subject,
+                                     pcre **re_compiled,
+                                     pcre_extra **re_extra);
+
 #endif // B3_PATTERN_CONDITION_H
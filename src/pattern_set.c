@@ -0,0 +1,315 @@
+/******************************************************************************
+  This file is part of b3.
+
+  Copyright 2020-2021 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck <richard.baeck@mailbox.org>
+ * @date 2021-04-17
+ * @brief File contains the pattern set class implementation and private methods
+ */
+
+#include "pattern_set.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+#include <w32bindkeys/logger.h>
+
+#include "utils.h"
+
+static wbk_logger_t logger = { "pattern_set" };
+
+static int
+b3_pattern_set_free_impl(b3_pattern_set_t *pattern_set);
+
+static int
+b3_pattern_set_add_impl(b3_pattern_set_t *pattern_set, const char *pattern);
+
+static int
+b3_pattern_set_compile_impl(b3_pattern_set_t *pattern_set);
+
+static int
+b3_pattern_set_match_impl(b3_pattern_set_t *pattern_set, const char *subject, char *match_arr);
+
+/**
+ * @return The bucket of a literal starting with the characters a and b.
+ */
+static int
+b3_pattern_set_get_bucket(char a, char b);
+
+b3_pattern_set_t *
+b3_pattern_set_new(void)
+{
+	b3_pattern_set_t *pattern_set;
+
+	pattern_set = NULL;
+	pattern_set = malloc(sizeof(b3_pattern_set_t));
+	if (pattern_set) {
+		pattern_set->b3_pattern_set_free = b3_pattern_set_free_impl;
+		pattern_set->b3_pattern_set_add = b3_pattern_set_add_impl;
+		pattern_set->b3_pattern_set_compile = b3_pattern_set_compile_impl;
+		pattern_set->b3_pattern_set_match = b3_pattern_set_match_impl;
+
+		array_new(&(pattern_set->entry_arr));
+		hashtable_new(&(pattern_set->id_table));
+		array_new(&(pattern_set->unfiltered_entry_arr));
+
+		pattern_set->bucket_arr = NULL;
+	}
+
+	return pattern_set;
+}
+
+int
+b3_pattern_set_free(b3_pattern_set_t *pattern_set)
+{
+	return pattern_set->b3_pattern_set_free(pattern_set);
+}
+
+int
+b3_pattern_set_add(b3_pattern_set_t *pattern_set, const char *pattern)
+{
+	return pattern_set->b3_pattern_set_add(pattern_set, pattern);
+}
+
+int
+b3_pattern_set_compile(b3_pattern_set_t *pattern_set)
+{
+	return pattern_set->b3_pattern_set_compile(pattern_set);
+}
+
+int
+b3_pattern_set_get_size(b3_pattern_set_t *pattern_set)
+{
+	return array_size(pattern_set->entry_arr);
+}
+
+int
+b3_pattern_set_match(b3_pattern_set_t *pattern_set, const char *subject, char *match_arr)
+{
+	return pattern_set->b3_pattern_set_match(pattern_set, subject, match_arr);
+}
+
+int
+b3_pattern_set_free_impl(b3_pattern_set_t *pattern_set)
+{
+	ArrayIter iter;
+	b3_pattern_set_entry_t *entry;
+
+	array_iter_init(&iter, pattern_set->entry_arr);
+	while (array_iter_next(&iter, (void *) &entry) != CC_ITER_END) {
+		if (entry->re_compiled) {
+			pcre_free(entry->re_compiled);
+		}
+		if (entry->re_extra) {
+#ifdef PCRE_CONFIG_JIT
+			pcre_free_study(entry->re_extra);
+#else
+			pcre_free(entry->re_extra);
+#endif
+		}
+
+		free(entry->pattern);
+		free(entry->literal);
+		free(entry);
+	}
+	array_destroy(pattern_set->entry_arr);
+
+	hashtable_destroy(pattern_set->id_table);
+	array_destroy(pattern_set->unfiltered_entry_arr);
+	free(pattern_set->bucket_arr);
+
+	free(pattern_set);
+
+	return 0;
+}
+
+int
+b3_pattern_set_add_impl(b3_pattern_set_t *pattern_set, const char *pattern)
+{
+	int id;
+	void *value;
+	b3_pattern_set_entry_t *entry;
+	b3_pattern_kind_t kind;
+	char *literal;
+	pcre *re_compiled;
+	pcre_extra *re_extra;
+	char exact;
+
+	kind = b3_classify_pattern(pattern, &literal);
+	re_compiled = NULL;
+	re_extra = NULL;
+
+	id = -1;
+	if (hashtable_get(pattern_set->id_table, (void *) pattern, &value) == CC_OK) {
+		id = (int) (INT_PTR) value;
+		free(literal);
+	} else if (kind != PATTERN_REGEX || !b3_compile_pattern(pattern, &re_compiled, &re_extra)) {
+		free(pattern_set->bucket_arr);
+		pattern_set->bucket_arr = NULL;
+
+		id = array_size(pattern_set->entry_arr);
+
+		entry = malloc(sizeof(b3_pattern_set_entry_t));
+		entry->id = id;
+		entry->pattern = malloc(sizeof(char) * (strlen(pattern) + 1));
+		strcpy(entry->pattern, pattern);
+		entry->kind = kind;
+		entry->re_compiled = re_compiled;
+		entry->re_extra = re_extra;
+		entry->literal = kind == PATTERN_REGEX ? b3_find_pattern_anchor(pattern, &exact) : literal;
+		entry->literal_length = entry->literal ? strlen(entry->literal) : 0;
+		entry->next_id = -1;
+
+		array_add(pattern_set->entry_arr, entry);
+		hashtable_add(pattern_set->id_table, entry->pattern, (void *) (INT_PTR) id);
+	}
+
+	return id;
+}
+
+int
+b3_pattern_set_compile_impl(b3_pattern_set_t *pattern_set)
+{
+	ArrayIter iter;
+	b3_pattern_set_entry_t *entry;
+	int bucket;
+	int i;
+
+	free(pattern_set->bucket_arr);
+	pattern_set->bucket_arr = malloc(sizeof(int) * B3_PATTERN_SET_BUCKET_COUNT);
+	for (i = 0; i < B3_PATTERN_SET_BUCKET_COUNT; i++) {
+		pattern_set->bucket_arr[i] = -1;
+	}
+
+	array_remove_all(pattern_set->unfiltered_entry_arr);
+
+	/**
+	 * The entries are added in reverse, so each bucket is ordered by id.
+	 */
+	for (i = array_size(pattern_set->entry_arr) - 1; i >= 0; i--) {
+		array_get_at(pattern_set->entry_arr, i, (void *) &entry);
+
+		/**
+		 * Literals of a single character do not filter much. Their patterns
+		 * are executed anyway.
+		 */
+		if (entry->literal_length >= 2) {
+			bucket = b3_pattern_set_get_bucket(entry->literal[0], entry->literal[1]);
+			entry->next_id = pattern_set->bucket_arr[bucket];
+			pattern_set->bucket_arr[bucket] = entry->id;
+		} else {
+			entry->next_id = -1;
+		}
+	}
+
+	array_iter_init(&iter, pattern_set->entry_arr);
+	while (array_iter_next(&iter, (void *) &entry) != CC_ITER_END) {
+		if (entry->literal_length < 2) {
+			array_add(pattern_set->unfiltered_entry_arr, entry);
+		}
+	}
+
+	wbk_logger_log(&logger, INFO, "Compiled %d patterns - %d without literal\n",
+				   array_size(pattern_set->entry_arr),
+				   array_size(pattern_set->unfiltered_entry_arr));
+
+	return 0;
+}
+
+int
+b3_pattern_set_match_impl(b3_pattern_set_t *pattern_set, const char *subject, char *match_arr)
+{
+	ArrayIter iter;
+	b3_pattern_set_entry_t *entry;
+	int subject_length;
+	int size;
+	int id;
+	int match_count;
+	int i;
+
+	match_count = -1;
+	if (pattern_set->bucket_arr) {
+		size = array_size(pattern_set->entry_arr);
+		subject_length = strlen(subject);
+
+		/**
+		 * First match_arr marks the patterns whose literal is in subject.
+		 */
+		memset(match_arr, 0, sizeof(char) * size);
+
+		array_iter_init(&iter, pattern_set->unfiltered_entry_arr);
+		while (array_iter_next(&iter, (void *) &entry) != CC_ITER_END) {
+			match_arr[entry->id] = 1;
+		}
+
+		for (i = 0; i + 1 < subject_length; i++) {
+			id = pattern_set->bucket_arr[b3_pattern_set_get_bucket(subject[i], subject[i + 1])];
+			while (id >= 0) {
+				array_get_at(pattern_set->entry_arr, id, (void *) &entry);
+				if (!match_arr[id]
+					&& entry->literal_length <= subject_length - i
+					&& memcmp(subject + i, entry->literal, entry->literal_length) == 0) {
+					match_arr[id] = 1;
+				}
+				id = entry->next_id;
+			}
+		}
+
+		/**
+		 * Then the marked patterns are executed.
+		 */
+		match_count = 0;
+		for (id = 0; id < size; id++) {
+			if (match_arr[id]) {
+				array_get_at(pattern_set->entry_arr, id, (void *) &entry);
+				if (entry->kind == PATTERN_REGEX) {
+					match_arr[id] = pcre_exec(entry->re_compiled,
+											  entry->re_extra,
+											  subject,
+											  subject_length,
+											  0,
+											  0,
+											  NULL,
+											  0) >= 0;
+				} else {
+					match_arr[id] = b3_match_literal(entry->kind,
+													 entry->literal,
+													 entry->literal_length,
+													 subject,
+													 subject_length);
+				}
+				match_count += match_arr[id];
+			}
+		}
+	}
+
+	return match_count;
+}
+
+int
+b3_pattern_set_get_bucket(char a, char b)
+{
+	return (((unsigned char) a) * 31 + ((unsigned char) b)) & (B3_PATTERN_SET_BUCKET_COUNT - 1);
+}
@@ -0,0 +1,165 @@
+/******************************************************************************
+  This file is part of b3.
+
+  Copyright 2020-2021 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck <richard.baeck@mailbox.org>
+ * @date 2021-04-17
+ * @brief File contains the pattern set class definition
+ *
+ * A pattern set matches many patterns against a string at once. Most patterns
+ * contain a literal every matching string contains too. A single pass over
+ * the string finds the literals it contains. Only the patterns of these
+ * literals and the patterns without a literal are executed.
+ */
+
+#ifndef B3_PATTERN_SET_H
+#define B3_PATTERN_SET_H
+
+#include <collectc/array.h>
+#include <collectc/hashtable.h>
+#include <pcre.h>
+
+#include "utils.h"
+
+/**
+ * Number of buckets the literals are hashed into by their first two
+ * characters. Must be a power of 2.
+ */
+#define B3_PATTERN_SET_BUCKET_COUNT 1024
+
+typedef struct b3_pattern_set_entry_s
+{
+	int id;
+
+	char *pattern;
+
+	/**
+	 * Only patterns of the kind PATTERN_REGEX are compiled.
+	 */
+	b3_pattern_kind_t kind;
+
+	pcre *re_compiled;
+	pcre_extra *re_extra;
+
+	/**
+	 * Literal every string matching the pattern contains. It is the literal
+	 * of the kind for the literal kinds. NULL if the pattern is unfiltered.
+	 */
+	char *literal;
+	int literal_length;
+
+	/**
+	 * Id of the next entry within the same bucket or -1.
+	 */
+	int next_id;
+} b3_pattern_set_entry_t;
+
+typedef struct b3_pattern_set_s b3_pattern_set_t;
+
+struct b3_pattern_set_s
+{
+	int (*b3_pattern_set_free)(b3_pattern_set_t *pattern_set);
+	int (*b3_pattern_set_add)(b3_pattern_set_t *pattern_set, const char *pattern);
+	int (*b3_pattern_set_compile)(b3_pattern_set_t *pattern_set);
+	int (*b3_pattern_set_match)(b3_pattern_set_t *pattern_set, const char *subject, char *match_arr);
+
+	/**
+	 * Array of b3_pattern_set_entry_t *
+	 *
+	 * The patterns of the set. The position of a pattern is its id.
+	 */
+	Array *entry_arr;
+
+	/**
+	 * HashTable of char * -> int
+	 *
+	 * The ids of the patterns. The keys are owned by the entries.
+	 */
+	HashTable *id_table;
+
+	/**
+	 * Array of b3_pattern_set_entry_t *
+	 *
+	 * The entries without a literal. They are always executed.
+	 */
+	Array *unfiltered_entry_arr;
+
+	/**
+	 * The id of the first entry of each bucket or -1. NULL if the set is not
+	 * compiled.
+	 */
+	int *bucket_arr;
+};
+
+/**
+ * @brief Creates a new empty pattern set
+ * @return A new pattern set or NULL if allocation failed
+ */
+extern b3_pattern_set_t *
+b3_pattern_set_new(void);
+
+/**
+ * @brief Frees a pattern set
+ * @return Non-0 if the freeing failed
+ */
+extern int
+b3_pattern_set_free(b3_pattern_set_t *pattern_set);
+
+/**
+ * Adds a pattern to the set. Adding the same pattern twice returns the same id.
+ * The set has to be compiled again afterwards.
+ *
+ * @param pattern The pattern. It is copied.
+ * @return The id of the pattern or -1 if it cannot be compiled.
+ */
+extern int
+b3_pattern_set_add(b3_pattern_set_t *pattern_set, const char *pattern);
+
+/**
+ * Indexes the literals of all added patterns.
+ *
+ * @return 0 if the compilation succeeded. Non-0 otherwise.
+ */
+extern int
+b3_pattern_set_compile(b3_pattern_set_t *pattern_set);
+
+/**
+ * @return The number of patterns in the set.
+ */
+extern int
+b3_pattern_set_get_size(b3_pattern_set_t *pattern_set);
+
+/**
+ * Matches all patterns against subject.
+ *
+ * @param match_arr Must hold b3_pattern_set_get_size() elements. Element i is
+ * set to 1 if the pattern with the id i matches subject, 0 otherwise.
+ * @return The number of matching patterns or a negative value if matching
+ * failed (e.g. the set is not compiled). match_arr is undefined then.
+ */
+extern int
+b3_pattern_set_match(b3_pattern_set_t *pattern_set, const char *subject, char *match_arr);
+
+#endif // B3_PATTERN_SET_H
@@ -0,0 +1,435 @@
+/******************************************************************************
+  This file is part of b3.
+
+  Copyright 2020-2021 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck <richard.baeck@mailbox.org>
+ * @date 2021-04-17
+ * @brief File contains the rule index class implementation and private methods
+ */
+
+#include "rule_index.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <w32bindkeys/logger.h>
+
+static wbk_logger_t logger = { "rule_index" };
+
+static int
+b3_rule_index_free_impl(b3_rule_index_t *rule_index);
+
+static int
+b3_rule_index_compile_impl(b3_rule_index_t *rule_index, Array *rule_arr);
+
+static int
+b3_rule_index_find_candidates_impl(b3_rule_index_t *rule_index,
+								   b3_director_t *director,
+								   b3_win_t *win,
+								   Array *candidate_arr);
+
+static int
+b3_rule_index_find_candidate_entries_impl(b3_rule_index_t *rule_index,
+										  b3_director_t *director,
+										  b3_win_t *win,
+										  Array *entry_arr);
+
+/**
+ * Frees all entries and forgets all rules.
+ */
+static int
+b3_rule_index_clear(b3_rule_index_t *rule_index);
+
+/**
+ * Frees the arrays of a table of char * -> Array *.
+ *
+ * @param free_key If non-0, then the keys are freed too.
+ */
+static int
+b3_rule_index_clear_table(HashTable *table, char free_key);
+
+/**
+ * @return The entries of class_entry_arr whose class conditions apply to the
+ * class of win. Do not free it!
+ */
+static Array *
+b3_rule_index_get_class_entry_arr(b3_rule_index_t *rule_index,
+								  b3_director_t *director,
+								  b3_win_t *win);
+
+/**
+ * @param title_match_arr The result of matching title_pattern_set.
+ * @return Non-0 if the title matches all title patterns of entry.
+ */
+static int
+b3_rule_index_title_matches(b3_rule_index_entry_t *entry, const char *title_match_arr);
+
+b3_rule_index_t *
+b3_rule_index_new(void)
+{
+	b3_rule_index_t *rule_index;
+
+	rule_index = NULL;
+	rule_index = malloc(sizeof(b3_rule_index_t));
+	if (rule_index) {
+		rule_index->b3_rule_index_free = b3_rule_index_free_impl;
+		rule_index->b3_rule_index_compile = b3_rule_index_compile_impl;
+		rule_index->b3_rule_index_find_candidates = b3_rule_index_find_candidates_impl;
+		rule_index->b3_rule_index_find_candidate_entries = b3_rule_index_find_candidate_entries_impl;
+
+		array_new(&(rule_index->entry_arr));
+		hashtable_new(&(rule_index->exact_class_table));
+		array_new(&(rule_index->class_entry_arr));
+		array_new(&(rule_index->fallback_entry_arr));
+		hashtable_new(&(rule_index->class_candidate_table));
+		rule_index->title_pattern_set = b3_pattern_set_new();
+
+		rule_index->candidate_count = 0;
+	}
+
+	return rule_index;
+}
+
+int
+b3_rule_index_free(b3_rule_index_t *rule_index)
+{
+	return rule_index->b3_rule_index_free(rule_index);
+}
+
+int
+b3_rule_index_compile(b3_rule_index_t *rule_index, Array *rule_arr)
+{
+	return rule_index->b3_rule_index_compile(rule_index, rule_arr);
+}
+
+int
+b3_rule_index_find_candidates(b3_rule_index_t *rule_index,
+							  b3_director_t *director,
+							  b3_win_t *win,
+							  Array *candidate_arr)
+{
+	return rule_index->b3_rule_index_find_candidates(rule_index, director, win, candidate_arr);
+}
+
+int
+b3_rule_index_find_candidate_entries(b3_rule_index_t *rule_index,
+									 b3_director_t *director,
+									 b3_win_t *win,
+									 Array *entry_arr)
+{
+	return rule_index->b3_rule_index_find_candidate_entries(rule_index, director, win, entry_arr);
+}
+
+int
+b3_rule_index_free_impl(b3_rule_index_t *rule_index)
+{
+	b3_rule_index_clear(rule_index);
+
+	array_destroy(rule_index->entry_arr);
+	hashtable_destroy(rule_index->exact_class_table);
+	array_destroy(rule_index->class_entry_arr);
+	array_destroy(rule_index->fallback_entry_arr);
+	hashtable_destroy(rule_index->class_candidate_table);
+	b3_pattern_set_free(rule_index->title_pattern_set);
+
+	free(rule_index);
+
+	return 0;
+}
+
+int
+b3_rule_index_compile_impl(b3_rule_index_t *rule_index, Array *rule_arr)
+{
+	ArrayIter iter;
+	b3_rule_t *rule;
+	b3_rule_index_entry_t *entry;
+	Array *exact_class_entry_arr;
+	const char *pattern;
+	int i;
+
+	b3_rule_index_clear(rule_index);
+
+	b3_pattern_set_free(rule_index->title_pattern_set);
+	rule_index->title_pattern_set = b3_pattern_set_new();
+
+	array_iter_init(&iter, rule_arr);
+	while (array_iter_next(&iter, (void *) &rule) != CC_ITER_END) {
+		entry = malloc(sizeof(b3_rule_index_entry_t));
+		entry->rule = rule;
+		entry->position = array_size(rule_index->entry_arr);
+		entry->prefilter.exact_class = NULL;
+		array_new(&(entry->prefilter.class_condition_arr));
+		array_new(&(entry->prefilter.title_pattern_arr));
+		entry->prefilter.incomplete = 0;
+
+		b3_condition_prefilter(rule->condition, &(entry->prefilter));
+
+		entry->decided = !entry->prefilter.incomplete;
+		entry->title_id_arr = malloc(sizeof(int) * (array_size(entry->prefilter.title_pattern_arr) + 1));
+		for (i = 0; i < array_size(entry->prefilter.title_pattern_arr); i++) {
+			array_get_at(entry->prefilter.title_pattern_arr, i, (void *) &pattern);
+			entry->title_id_arr[i] = b3_pattern_set_add(rule_index->title_pattern_set, pattern);
+			if (entry->title_id_arr[i] < 0) {
+				entry->decided = 0;
+			}
+		}
+
+		array_add(rule_index->entry_arr, entry);
+
+		if (entry->prefilter.exact_class) {
+			if (hashtable_get(rule_index->exact_class_table,
+							  (void *) entry->prefilter.exact_class,
+							  (void *) &exact_class_entry_arr) != CC_OK) {
+				array_new(&exact_class_entry_arr);
+				hashtable_add(rule_index->exact_class_table,
+							  (void *) entry->prefilter.exact_class,
+							  exact_class_entry_arr);
+			}
+			array_add(exact_class_entry_arr, entry);
+		} else if (array_size(entry->prefilter.class_condition_arr)) {
+			array_add(rule_index->class_entry_arr, entry);
+		} else {
+			array_add(rule_index->fallback_entry_arr, entry);
+		}
+	}
+
+	b3_pattern_set_compile(rule_index->title_pattern_set);
+
+	wbk_logger_log(&logger, INFO, "Compiled %d rules - %d by exact class, %d by class pattern, %d by title only\n",
+				   array_size(rule_index->entry_arr),
+				   array_size(rule_index->entry_arr)
+				   - array_size(rule_index->class_entry_arr)
+				   - array_size(rule_index->fallback_entry_arr),
+				   array_size(rule_index->class_entry_arr),
+				   array_size(rule_index->fallback_entry_arr));
+
+	return 0;
+}
+
+int
+b3_rule_index_find_candidate_entries_impl(b3_rule_index_t *rule_index,
+										  b3_director_t *director,
+										  b3_win_t *win,
+										  Array *entry_arr)
+{
+	Array *source_arr[3];
+	int source_pos[3];
+	int source;
+	int next_source;
+	b3_rule_index_entry_t *entry;
+	b3_rule_index_entry_t *next_entry;
+	char *title_match_arr;
+	int error;
+	char title_matched;
+
+	source_arr[0] = NULL;
+	hashtable_get(rule_index->exact_class_table,
+				  (void *) b3_win_get_classname(win),
+				  (void *) &(source_arr[0]));
+	source_arr[1] = b3_rule_index_get_class_entry_arr(rule_index, director, win);
+	source_arr[2] = rule_index->fallback_entry_arr;
+
+	source_pos[0] = 0;
+	source_pos[1] = 0;
+	source_pos[2] = 0;
+
+	error = 0;
+	title_match_arr = NULL;
+	title_matched = 0;
+
+	/**
+	 * Each source is ordered by the position of the rules. Merging them keeps
+	 * the order the rules were defined in.
+	 */
+	do {
+		next_source = -1;
+		next_entry = NULL;
+		for (source = 0; source < 3; source++) {
+			if (source_arr[source]
+				&& array_get_at(source_arr[source], source_pos[source], (void *) &entry) == CC_OK
+				&& (next_entry == NULL || entry->position < next_entry->position)) {
+				next_source = source;
+				next_entry = entry;
+			}
+		}
+
+		if (next_entry) {
+			source_pos[next_source]++;
+
+			/**
+			 * The title is matched once against all patterns, when the first
+			 * entry needs it.
+			 */
+			if (!title_matched && array_size(next_entry->prefilter.title_pattern_arr)) {
+				title_match_arr = malloc(sizeof(char) * (b3_pattern_set_get_size(rule_index->title_pattern_set) + 1));
+				if (title_match_arr == NULL
+					|| b3_pattern_set_match(rule_index->title_pattern_set, b3_win_get_title(win), title_match_arr) < 0) {
+					wbk_logger_log(&logger, SEVERE, "Unable to match the title patterns\n");
+					error = 1;
+				}
+				title_matched = 1;
+			}
+
+			if (!error && b3_rule_index_title_matches(next_entry, title_match_arr)) {
+				array_add(entry_arr, next_entry);
+				rule_index->candidate_count++;
+			}
+		}
+	} while (!error && next_entry);
+
+	free(title_match_arr);
+
+	return error;
+}
+
+int
+b3_rule_index_find_candidates_impl(b3_rule_index_t *rule_index,
+								   b3_director_t *director,
+								   b3_win_t *win,
+								   Array *candidate_arr)
+{
+	Array *entry_arr;
+	ArrayIter iter;
+	b3_rule_index_entry_t *entry;
+	int error;
+
+	array_new(&entry_arr);
+
+	error = b3_rule_index_find_candidate_entries(rule_index, director, win, entry_arr);
+	if (!error) {
+		array_iter_init(&iter, entry_arr);
+		while (array_iter_next(&iter, (void *) &entry) != CC_ITER_END) {
+			array_add(candidate_arr, entry->rule);
+		}
+	}
+
+	array_destroy(entry_arr);
+
+	return error;
+}
+
+int
+b3_rule_index_clear(b3_rule_index_t *rule_index)
+{
+	ArrayIter iter;
+	b3_rule_index_entry_t *entry;
+
+	b3_rule_index_clear_table(rule_index->class_candidate_table, 1);
+	b3_rule_index_clear_table(rule_index->exact_class_table, 0);
+	array_remove_all(rule_index->class_entry_arr);
+	array_remove_all(rule_index->fallback_entry_arr);
+
+	array_iter_init(&iter, rule_index->entry_arr);
+	while (array_iter_next(&iter, (void *) &entry) != CC_ITER_END) {
+		array_destroy(entry->prefilter.class_condition_arr);
+		array_destroy(entry->prefilter.title_pattern_arr);
+		free(entry->title_id_arr);
+		free(entry);
+	}
+	array_remove_all(rule_index->entry_arr);
+
+	return 0;
+}
+
+int
+b3_rule_index_clear_table(HashTable *table, char free_key)
+{
+	HashTableIter iter;
+	TableEntry *table_entry;
+
+	hashtable_iter_init(&iter, table);
+	while (hashtable_iter_next(&iter, &table_entry) != CC_ITER_END) {
+		array_destroy(table_entry->value);
+		if (free_key) {
+			free(table_entry->key);
+		}
+	}
+
+	hashtable_remove_all(table);
+
+	return 0;
+}
+
+Array *
+b3_rule_index_get_class_entry_arr(b3_rule_index_t *rule_index,
+								  b3_director_t *director,
+								  b3_win_t *win)
+{
+	Array *class_entry_arr;
+	ArrayIter entry_iter;
+	ArrayIter condition_iter;
+	b3_rule_index_entry_t *entry;
+	b3_condition_t *condition;
+	const char *classname;
+	char *key;
+	int applies;
+
+	classname = b3_win_get_classname(win);
+
+	class_entry_arr = NULL;
+	if (hashtable_get(rule_index->class_candidate_table,
+					  (void *) classname,
+					  (void *) &class_entry_arr) != CC_OK) {
+		if (hashtable_size(rule_index->class_candidate_table) >= B3_RULE_INDEX_CLASS_TABLE_SIZE) {
+			b3_rule_index_clear_table(rule_index->class_candidate_table, 1);
+		}
+
+		array_new(&class_entry_arr);
+
+		array_iter_init(&entry_iter, rule_index->class_entry_arr);
+		while (array_iter_next(&entry_iter, (void *) &entry) != CC_ITER_END) {
+			applies = 1;
+			array_iter_init(&condition_iter, entry->prefilter.class_condition_arr);
+			while (applies && array_iter_next(&condition_iter, (void *) &condition) != CC_ITER_END) {
+				applies = b3_condition_applies(condition, director, win);
+			}
+
+			if (applies) {
+				array_add(class_entry_arr, entry);
+			}
+		}
+
+		key = malloc(sizeof(char) * (strlen(classname) + 1));
+		strcpy(key, classname);
+		hashtable_add(rule_index->class_candidate_table, key, class_entry_arr);
+	}
+
+	return class_entry_arr;
+}
+
+int
+b3_rule_index_title_matches(b3_rule_index_entry_t *entry, const char *title_match_arr)
+{
+	int matches;
+	int i;
+
+	matches = 1;
+	for (i = 0; matches && i < array_size(entry->prefilter.title_pattern_arr); i++) {
+		if (entry->title_id_arr[i] >= 0) {
+			matches = title_match_arr[entry->title_id_arr[i]];
+		}
+	}
+
+	return matches;
+}
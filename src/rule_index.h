@@ -0,0 +1,198 @@
+/******************************************************************************
+  This file is part of b3.
+
+  Copyright 2020-2021 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck <richard.baeck@mailbox.org>
+ * @date 2021-04-17
+ * @brief File contains the rule index class definition
+ *
+ * The rule index is compiled from the rules of the director. It finds the
+ * rules that might apply to a window without evaluating all of them.
+ */
+
+#ifndef B3_RULE_INDEX_H
+#define B3_RULE_INDEX_H
+
+#include <collectc/array.h>
+#include <collectc/hashtable.h>
+
+#include "director.h"
+#include "pattern_set.h"
+#include "rule.h"
+#include "condition.h"
+#include "win.h"
+
+/**
+ * Maximum number of window classes whose candidates are remembered. If it is
+ * reached, then all of them are forgotten.
+ */
+#define B3_RULE_INDEX_CLASS_TABLE_SIZE 1024
+
+typedef struct b3_rule_index_entry_s
+{
+	b3_rule_t *rule;
+
+	/**
+	 * Position of the rule within the compiled rules.
+	 */
+	int position;
+
+	b3_condition_prefilter_t prefilter;
+
+	/**
+	 * Ids of the title patterns of the prefilter within title_pattern_set. -1
+	 * if a pattern is not in the set.
+	 */
+	int *title_id_arr;
+
+	/**
+	 * Non-0 if the rule applies to all windows it is a candidate for, because
+	 * the prefilter covers all of its conditions. Then b3_rule_applies() does
+	 * not have to be called.
+	 */
+	char decided;
+} b3_rule_index_entry_t;
+
+typedef struct b3_rule_index_s b3_rule_index_t;
+
+struct b3_rule_index_s
+{
+	int (*b3_rule_index_free)(b3_rule_index_t *rule_index);
+	int (*b3_rule_index_compile)(b3_rule_index_t *rule_index, Array *rule_arr);
+	int (*b3_rule_index_find_candidates)(b3_rule_index_t *rule_index,
+										 b3_director_t *director,
+										 b3_win_t *win,
+										 Array *candidate_arr);
+	int (*b3_rule_index_find_candidate_entries)(b3_rule_index_t *rule_index,
+												b3_director_t *director,
+												b3_win_t *win,
+												Array *entry_arr);
+
+	/**
+	 * Array of b3_rule_index_entry_t *
+	 *
+	 * The entries of all compiled rules in the order of the rules.
+	 */
+	Array *entry_arr;
+
+	/**
+	 * HashTable of char * -> Array * of b3_rule_index_entry_t *
+	 *
+	 * The entries of the rules requiring an exact class by that class.
+	 */
+	HashTable *exact_class_table;
+
+	/**
+	 * Array of b3_rule_index_entry_t *
+	 *
+	 * The entries of the rules with class conditions, but no exact class.
+	 */
+	Array *class_entry_arr;
+
+	/**
+	 * Array of b3_rule_index_entry_t *
+	 *
+	 * The entries of the rules without any condition on the class.
+	 */
+	Array *fallback_entry_arr;
+
+	/**
+	 * HashTable of char * -> Array * of b3_rule_index_entry_t *
+	 *
+	 * The entries of class_entry_arr whose class conditions apply to a class.
+	 * It is filled when a class is seen the first time. The keys are owned by
+	 * the rule index.
+	 *
+	 * Unlike titles, there are only few window classes, so the class patterns
+	 * are executed once per class instead of being matched by a pattern set.
+	 */
+	HashTable *class_candidate_table;
+
+	/**
+	 * The title patterns of all rules. The title of a window is matched against
+	 * all of them at once.
+	 */
+	b3_pattern_set_t *title_pattern_set;
+
+	/**
+	 * Number of rules returned by all b3_rule_index_find_candidates().
+	 */
+	int candidate_count;
+};
+
+/**
+ * @brief Creates a new rule index without any rules
+ * @return A new rule index or NULL if allocation failed
+ */
+extern b3_rule_index_t *
+b3_rule_index_new(void);
+
+/**
+ * @brief Frees a rule index. The indexed rules are not freed.
+ * @return Non-0 if the freeing failed
+ */
+extern int
+b3_rule_index_free(b3_rule_index_t *rule_index);
+
+/**
+ * Replaces the indexed rules by the rules of rule_arr.
+ *
+ * @param rule_arr Array of b3_rule_t *. The rules will not be freed by the rule
+ * index and must outlive it or the next compilation.
+ * @return 0 if the compilation succeeded. Non-0 otherwise.
+ */
+extern int
+b3_rule_index_compile(b3_rule_index_t *rule_index, Array *rule_arr);
+
+/**
+ * Adds the rules that might apply to win to candidate_arr. They are added in
+ * the order they were compiled in. Rules not added never apply to win. The
+ * added ones still have to be checked by b3_rule_applies(), unless their entry
+ * is decided (see b3_rule_index_find_candidate_entries()).
+ *
+ * @param candidate_arr Array of b3_rule_t *
+ * @return 0 if the search succeeded. Non-0 otherwise.
+ */
+extern int
+b3_rule_index_find_candidates(b3_rule_index_t *rule_index,
+							  b3_director_t *director,
+							  b3_win_t *win,
+							  Array *candidate_arr);
+
+/**
+ * Like b3_rule_index_find_candidates(), but adds the entries of the rules.
+ * Candidates of decided entries apply without calling b3_rule_applies().
+ *
+ * @param entry_arr Array of b3_rule_index_entry_t *. The entries are owned by
+ * the rule index and valid until it is compiled again.
+ * @return 0 if the search succeeded. Non-0 otherwise.
+ */
+extern int
+b3_rule_index_find_candidate_entries(b3_rule_index_t *rule_index,
+									 b3_director_t *director,
+									 b3_win_t *win,
+									 Array *entry_arr);
+
+#endif // B3_RULE_INDEX_H
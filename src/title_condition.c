@@ -36,8 +36,6 @@
 
 static wbk_logger_t logger = { "title_condition" };
 
-#define B3_TITLE_CONDITION_TITLE_BUFFER_LENGTH 255
-
 /**
  * Implementation of b3_condition_free().
  */
@@ -50,6 +48,12 @@ b3_title_condition_free_impl(b3_condition_t *condition);
 static int
 b3_title_condition_applies_impl(b3_condition_t *condition, b3_director_t *director, b3_win_t *win);
 
+/**
+ * Implementation of b3_condition_prefilter().
+ */
+static int
+b3_title_condition_prefilter_impl(b3_condition_t *condition, b3_condition_prefilter_t *prefilter);
+
 b3_title_condition_t *
 b3_title_condition_new(const char *pattern)
 {
@@ -79,6 +83,7 @@ b3_title_condition_new(const char *pattern)
 
     title_condition->pattern_condition.condition.condition_free = b3_title_condition_free_impl;
     title_condition->pattern_condition.condition.condition_applies = b3_title_condition_applies_impl;
+    title_condition->pattern_condition.condition.condition_prefilter = b3_title_condition_prefilter_impl;
   }
 
   return title_condition;
@@ -101,53 +106,65 @@ b3_title_condition_applies_impl(b3_condition_t *condition, b3_director_t *direct
 {
   b3_title_condition_t *title_condition;
   int applies;
-	char title[B3_TITLE_CONDITION_TITLE_BUFFER_LENGTH];
+  const char *title;
   int pcre_rc;
   pcre *re_compiled;
   pcre_extra *re_extra;
+  b3_win_t *focused_win;
   int error;
 
   title_condition = (b3_title_condition_t *) condition;
   applies = 0;
   error = 0;
 
-  if (!error) {
-    if (b3_pattern_condition_get_use_focused_as_pattern((b3_pattern_condition_t *) title_condition)) {
-      GetWindowText(b3_win_get_window_handler(b3_monitor_get_focused_win(b3_director_get_focused_monitor(director))),
-                    title,
-                    B3_TITLE_CONDITION_TITLE_BUFFER_LENGTH);
-      error = b3_compile_pattern(title, &re_compiled, &re_extra);
-    } else {
-      re_compiled = b3_pattern_condition_get_re_compiled((b3_pattern_condition_t *) title_condition);
-      re_extra = b3_pattern_condition_get_re_extra((b3_pattern_condition_t *) title_condition);
+  title = b3_win_get_title(win);
+
+  if (b3_pattern_condition_get_use_focused_as_pattern((b3_pattern_condition_t *) title_condition)) {
+    /**
+     * Rules depending on the focused window are not decided by the rule
+     * index. b3_director_add_win() evaluates them while the director is
+     * locked, so the focused window does not change meanwhile.
+     */
+    focused_win = b3_monitor_get_focused_win(b3_director_get_focused_monitor(director));
+    error = b3_pattern_condition_compile_focused((b3_pattern_condition_t *) title_condition,
+                                                 focused_win,
+                                                 focused_win ? b3_win_get_title(focused_win) : NULL,
+                                                 &re_compiled,
+                                                 &re_extra);
+
+    if (!error) {
+      pcre_rc = pcre_exec(re_compiled,
+                          re_extra,
+                          title,
+                          strlen(title),
+                          0,
+                          0,
+                          NULL,
+                          0);
+      if (pcre_rc >= 0) {
+        applies = 1;
+      }
     }
+  } else {
+    applies = b3_pattern_condition_matches((b3_pattern_condition_t *) title_condition, title);
   }
 
-  if (!error) {
-    GetWindowText(b3_win_get_window_handler(win), title, B3_TITLE_CONDITION_TITLE_BUFFER_LENGTH);
-    pcre_rc = pcre_exec(re_compiled,
-                        re_extra,
-                        title,
-                        strlen(title),
-                        0,
-                        0,
-                        NULL,
-                        0);
-    if (pcre_rc >= 0) {
-      applies = 1;
-    }
-  }
+  return applies;
+}
 
-  if (!error) {
-    if (b3_pattern_condition_get_use_focused_as_pattern((b3_pattern_condition_t *) title_condition)) {
-      pcre_free(re_compiled);
-#ifdef PCRE_CONFIG_JIT
-      pcre_free_study(re_extra);
-#else
-      pcre_free(re_extra);
-#endif
-    }
+int
+b3_title_condition_prefilter_impl(b3_condition_t *condition, b3_condition_prefilter_t *prefilter)
+{
+  b3_pattern_condition_t *pattern_condition;
+
+  pattern_condition = (b3_pattern_condition_t *) condition;
+
+  if (!b3_pattern_condition_get_use_focused_as_pattern(pattern_condition)) {
+    array_add(prefilter->title_pattern_arr,
+              (void *) b3_pattern_condition_get_pattern(pattern_condition));
+  } else {
+    prefilter->incomplete = 1;
   }
 
-  return applies;
+  return 0;
 }
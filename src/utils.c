@@ -30,12 +30,18 @@
 
 #include "utils.h"
 
+#include <ctype.h>
 #include <stdlib.h>
 #include <string.h>
 #include <w32bindkeys/logger.h>
 
 static wbk_logger_t logger = { "utils" };
 
+/**
+ * Characters having a special meaning within a pattern.
+ */
+#define B3_UTILS_PATTERN_META "\\^$.|?*+()[]{}"
+
 char *
 b3_add_c_to_s(char *modified_str, char new_c)
 {
@@ -106,7 +112,11 @@ b3_compile_pattern(const char *pattern, pcre **re_compiled, pcre_extra **re_extr
   }
 
   if (!error) {
+#ifdef PCRE_STUDY_JIT_COMPILE
+    *re_extra = pcre_study(*re_compiled, PCRE_STUDY_JIT_COMPILE, &pcre_err_str);
+#else
     *re_extra = pcre_study(*re_compiled, 0, &pcre_err_str);
+#endif
 
     if (pcre_err_str) {
       wbk_logger_log(&logger, SEVERE, "Could not study '%s': %s\n", pattern, pcre_err_str);
@@ -132,3 +142,251 @@ b3_compile_pattern(const char *pattern, pcre **re_compiled, pcre_extra **re_extr
 
   return error;
 }
+
+b3_pattern_kind_t
+b3_classify_pattern(const char *pattern, char **literal)
+{
+  b3_pattern_kind_t kind;
+  int length;
+  int literal_length;
+  int i;
+  char anchored_start;
+  char anchored_end;
+  char is_literal;
+
+  length = strlen(pattern);
+  *literal = malloc(sizeof(char) * (length + 1));
+  literal_length = 0;
+
+  i = 0;
+  anchored_start = 0;
+  if (pattern[i] == '^') {
+    anchored_start = 1;
+    i++;
+  }
+
+  /**
+   * A leading .* may match nothing, so it only removes the anchor.
+   */
+  if (strncmp(pattern + i, ".*", 2) == 0) {
+    anchored_start = 0;
+    i += 2;
+  }
+
+  while (i < length
+         && (!strchr(B3_UTILS_PATTERN_META, pattern[i])
+             || (pattern[i] == '\\' && i + 1 < length && strchr(B3_UTILS_PATTERN_META, pattern[i + 1])))) {
+    if (pattern[i] == '\\') {
+      i++;
+    }
+    (*literal)[literal_length] = pattern[i];
+    literal_length++;
+    i++;
+  }
+  (*literal)[literal_length] = '\0';
+
+  anchored_end = 0;
+  is_literal = 1;
+  if (strcmp(pattern + i, "$") == 0) {
+    anchored_end = 1;
+  } else if (strcmp(pattern + i, ".*") != 0 && pattern[i] != '\0') {
+    is_literal = 0;
+  }
+
+  if (!is_literal) {
+    kind = PATTERN_REGEX;
+    free(*literal);
+    *literal = NULL;
+  } else if (anchored_start && anchored_end) {
+    kind = PATTERN_EXACT;
+  } else if (anchored_start) {
+    kind = PATTERN_PREFIX;
+  } else if (anchored_end) {
+    kind = PATTERN_SUFFIX;
+  } else {
+    kind = PATTERN_SUBSTRING;
+  }
+
+  return kind;
+}
+
+int
+b3_match_literal(b3_pattern_kind_t kind, const char *literal, int literal_length,
+                 const char *subject, int subject_length)
+{
+  int matches;
+
+  /**
+   * Like in pcre, $ also matches before a newline ending the subject.
+   */
+  if ((kind == PATTERN_EXACT || kind == PATTERN_SUFFIX)
+      && subject_length > 0
+      && subject[subject_length - 1] == '\n'
+      && b3_match_literal(kind, literal, literal_length, subject, subject_length - 1)) {
+    matches = 1;
+  } else {
+    switch (kind) {
+    case PATTERN_EXACT:
+      matches = subject_length == literal_length
+        && memcmp(subject, literal, literal_length) == 0;
+      break;
+
+    case PATTERN_PREFIX:
+      matches = subject_length >= literal_length
+        && memcmp(subject, literal, literal_length) == 0;
+      break;
+
+    case PATTERN_SUFFIX:
+      matches = subject_length >= literal_length
+        && memcmp(subject + subject_length - literal_length, literal, literal_length) == 0;
+      break;
+
+    case PATTERN_SUBSTRING:
+      matches = strstr(subject, literal) != NULL;
+      break;
+
+    default:
+      matches = 0;
+      break;
+    }
+  }
+
+  return matches;
+}
+
+char *
+b3_escape_pattern(const char *str)
+{
+  char *escaped;
+  int length;
+  int i;
+
+  escaped = malloc(sizeof(char) * (strlen(str) * 2 + 1));
+
+  length = 0;
+  for (i = 0; str[i] != '\0'; i++) {
+    if (strchr(B3_UTILS_PATTERN_META, str[i])) {
+      escaped[length] = '\\';
+      length++;
+    }
+    escaped[length] = str[i];
+    length++;
+  }
+  escaped[length] = '\0';
+
+  return escaped;
+}
+
+char *
+b3_find_pattern_anchor(const char *pattern, char *exact)
+{
+  char *anchor;
+  char *run;
+  int anchor_length;
+  int run_length;
+  int length;
+  int i;
+  char c;
+  char end_run;
+  char anchored_start;
+  char anchored_end;
+  char interrupted;
+  char give_up;
+
+  length = strlen(pattern);
+  anchor = malloc(sizeof(char) * (length + 1));
+  run = malloc(sizeof(char) * (length + 1));
+  anchor_length = 0;
+  run_length = 0;
+
+  anchored_start = length > 0 && pattern[0] == '^';
+  anchored_end = 0;
+  interrupted = 0;
+  give_up = 0;
+
+  i = anchored_start ? 1 : 0;
+  while (!give_up && i < length) {
+    c = pattern[i];
+    end_run = 1;
+
+    if (c == '*' || c == '?' || c == '{') {
+      /**
+       * The previous character is optional or repeated.
+       */
+      if (run_length > 0) {
+        run_length--;
+      }
+
+      if (c == '{') {
+        while (i < length && pattern[i] != '}') {
+          i++;
+        }
+        give_up = i == length;
+      }
+    } else if (c == '$') {
+      anchored_end = i == length - 1;
+    } else if (c == '[') {
+      i++;
+      if (i < length && pattern[i] == '^') {
+        i++;
+      }
+      if (i < length && pattern[i] == ']') {
+        i++;
+      }
+      while (i < length && pattern[i] != ']') {
+        if (pattern[i] == '\\') {
+          i++;
+        }
+        i++;
+      }
+      give_up = i >= length;
+    } else if (c == '(' || c == ')' || c == '|') {
+      give_up = 1;
+    } else if (c == '\\' && i + 1 < length && !isalnum((unsigned char) pattern[i + 1])) {
+      i++;
+      run[run_length] = pattern[i];
+      run_length++;
+      end_run = 0;
+    } else if (c == '\\') {
+      /**
+       * Only escapes of a single character class are skipped. Others (e.g. \Q
+       * or \x) span an unknown number of characters.
+       */
+      give_up = i + 1 == length || strchr("dDwWsSbB", pattern[i + 1]) == NULL;
+      i++;
+    } else if (c != '.' && c != '^' && c != '+') {
+      run[run_length] = c;
+      run_length++;
+      end_run = 0;
+    }
+
+    if (end_run) {
+      interrupted = interrupted || !anchored_end;
+
+      if (run_length > anchor_length) {
+        memcpy(anchor, run, run_length);
+        anchor_length = run_length;
+      }
+      run_length = 0;
+    }
+
+    i++;
+  }
+
+  if (run_length > anchor_length) {
+    memcpy(anchor, run, run_length);
+    anchor_length = run_length;
+  }
+  free(run);
+
+  *exact = 0;
+  if (give_up || anchor_length == 0) {
+    free(anchor);
+    anchor = NULL;
+  } else {
+    anchor[anchor_length] = '\0';
+    *exact = anchored_start && anchored_end && !interrupted;
+  }
+
+  return anchor;
+}
@@ -33,6 +33,19 @@
 
 #include <pcre.h>
 
+/**
+ * Kinds of patterns. Only PATTERN_REGEX needs pcre, the others are matched
+ * as literals.
+ */
+typedef enum b3_pattern_kind_e
+{
+  PATTERN_EXACT = 0,
+  PATTERN_PREFIX,
+  PATTERN_SUFFIX,
+  PATTERN_SUBSTRING,
+  PATTERN_REGEX
+} b3_pattern_kind_t;
+
 /**
  * Adds a character to a dynamically allocated string. If the modified_str is
  * NULL, then it will be newly allocated.
@@ -65,4 +78,47 @@ b3_add_s_to_s(char *modified_str, const char *new_s);
 extern int
 b3_compile_pattern(const char *pattern, pcre **re_compiled, pcre_extra **re_extra);
 
+/**
+ * Classifies a pattern. A pattern only consisting of (escaped) literal
+ * characters, optionally surrounded by ^, $ or .*, is one of the literal kinds
+ * (e.g. "^Firefox$" is PATTERN_EXACT and ".*Teams.*" is PATTERN_SUBSTRING).
+ *
+ * @param literal Will receive the literal of a literal kind or NULL. Free it
+ * by yourself!
+ * @return The kind of the pattern.
+ */
+extern b3_pattern_kind_t
+b3_classify_pattern(const char *pattern, char **literal);
+
+/**
+ * Matches a literal kind of pattern like pcre_exec() would match the pattern.
+ *
+ * @param kind The kind of the pattern. Must not be PATTERN_REGEX.
+ * @param literal The literal of the pattern as returned by b3_classify_pattern().
+ * @return Non-0 if subject matches.
+ */
+extern int
+b3_match_literal(b3_pattern_kind_t kind, const char *literal, int literal_length,
+                 const char *subject, int subject_length);
+
+/**
+ * Escapes the meta characters of a string, so it can be used as a pattern
+ * matching the string literally.
+ *
+ * @return The escaped string. Free it by yourself!
+ */
+extern char *
+b3_escape_pattern(const char *str);
+
+/**
+ * Finds the longest literal every string matching the pattern must contain.
+ * Patterns containing groups or alternations are not analyzed.
+ *
+ * @param exact Is set to non-0 if the pattern only matches the literal
+ * itself (e.g. "^Notepad$").
+ * @return The literal or NULL if none was found. Free it by yourself!
+ */
+extern char *
+b3_find_pattern_anchor(const char *pattern, char *exact);
+
 #endif // B3_UTILS_H
@@ -1,46 +1,102 @@
-/******************************************************************************
-  This file is part of b3.
-
-  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
-
-  Permission is hereby granted, free of charge, to any person obtaining a copy
-  of this software and associated documentation files (the "Software"), to deal
-  in the Software without restriction, including without limitation the rights
-  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-  copies of the Software, and to permit persons to whom the Software is
-  furnished to do so, subject to the following conditions:
-
-  The above copyright notice and this permission notice shall be included in all
-  copies or substantial portions of the Software.
-
-  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
-  SOFTWARE.
-*******************************************************************************/
-
-#include "win.h"
-
+/******************************************************************************
+  This file is part of b3.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+#include "win.h"
+
 /**
  * @author Richard Bck
  * @date 26 January 2020
  * @brief File contains the window class implementation and private methods
  */
 
-#include <stdlib.h>
+#include <stdlib.h>
 #include <string.h>
 #include <w32bindkeys/logger.h>
 
+#include "win_positioner.h"
+
+/**
+ * Number of positions a batch allocates at least.
+ */
+#define B3_WIN_BATCH_MIN_SIZE 16
+
+/**
+ * Number of slots the handle table allocates at least.
+ */
+#define B3_WIN_SLOT_MIN_SIZE 64
+
 static wbk_logger_t logger = { "win" };
 
-typedef struct b3_win_show_comm_s
+/**
+ * Positions all windows shown by b3_win_show(). Set it by using
+ * b3_win_set_positioner().
+ */
+static b3_win_positioner_t *g_positioner = NULL;
+
+/**
+ * Reads the attributes of all windows. Set it by using
+ * b3_win_set_attr_reader().
+ */
+static int (*g_attr_reader)(HWND window_handler, b3_win_attr_t *attr) = NULL;
+
+/**
+ * Reads the real rect and the iconic state of all windows. Set it by using
+ * b3_win_set_placement_reader().
+ */
+static int (*g_placement_reader)(HWND window_handler, RECT *rect, char *iconic) = NULL;
+
+/**
+ * Slot of the handle table.
+ */
+typedef struct b3_win_slot_s
 {
-  b3_win_t *win;
-  char topmost;
-} b3_win_show_comm_t;
+	/**
+	 * NULL if the slot is free.
+	 */
+	b3_win_t *win;
+
+	/**
+	 * Never 0, so no handle equals B3_WIN_HANDLE_NULL.
+	 */
+	WORD generation;
+
+	/**
+	 * Index of the next free slot if the slot is free. -1 if it is the last
+	 * free slot.
+	 */
+	int next_free;
+} b3_win_slot_t;
+
+/**
+ * Handle table of all windows. It only grows. Slots of freed windows are
+ * reused.
+ */
+static b3_win_slot_t *g_slot_arr = NULL;
+static int g_slot_arr_size = 0;
+static int g_slot_count = 0;
+static int g_free_slot = -1;
+static CRITICAL_SECTION *g_slot_lock = NULL;
 
 static int
 b3_win_free_impl(b3_win_t *win);
@@ -49,19 +105,80 @@ static int
 b3_win_is_point_in_rect_impl(b3_win_t *win, POINT *point);
 
 /**
- * This function actually performs everything necessary to show a window.
+ * Reads the attributes of a window from the Win32 API. It is the default
+ * reader of b3_win_set_attr_reader().
+ */
+static int
+b3_win_read_attr(HWND window_handler, b3_win_attr_t *attr);
+
+/**
+ * Reads the real rect and the iconic state of the window from the Win32 API.
+ * It is the default reader of b3_win_set_placement_reader().
+ */
+static int
+b3_win_read_placement(HWND window_handler, RECT *rect, char *iconic);
+
+/**
+ * Locks the handle table. The critical section is created by the first call.
+ * Unlike a mutex, it does not enter the kernel if the table is not locked by
+ * another thread.
+ */
+static void
+b3_win_lock_slots(void);
+
+static void
+b3_win_unlock_slots(void);
+
+/**
+ * Assigns a slot of the handle table to the window.
  *
- * @param param Actually from type b3_win_show_comm_t *
+ * @return The handle of the window. B3_WIN_HANDLE_NULL if the table is full.
  */
-static DWORD WINAPI
-b3_win_show_exec(LPVOID param);
+static b3_win_handle_t
+b3_win_handle_alloc(b3_win_t *win);
 
-
-b3_win_t *
+/**
+ * Frees the slot of the handle and moves the slot to the next generation.
+ */
+static void
+b3_win_handle_release(b3_win_handle_t handle);
+
+/**
+ * Remembers that the window is shown at its rect with topmost and stores the
+ * position to apply in pos.
+ */
+static void
+b3_win_mark_shown(b3_win_t *win, char topmost, b3_win_pos_t *pos);
+
+/**
+ * Computes where a window is placed in the z-order and on the screen.
+ */
+static void
+b3_win_pos_get_target(const b3_win_pos_t *pos, HWND *insert_after, RECT *rect);
+
+/**
+ * Sends the message without parameters to the window. Does not wait for hung
+ * windows and gives up after B3_WIN_MESSAGE_TIMEOUT.
+ */
+static void
+b3_win_send_message(HWND window_handler, UINT message);
+
+/**
+ * Positions all windows at once using flags. If that fails, the windows are
+ * positioned one by one.
+ *
+ * @return Non-0 if not all windows could be positioned.
+ */
+static int
+b3_win_batch_defer(const b3_win_pos_t *pos_arr, int length, UINT flags);
+
+
+
+b3_win_t *
 b3_win_new(HWND window_handler, char floating)
-{
+{
 	b3_win_t *win;
-
+
 	win = NULL;
 	win = malloc(sizeof(b3_win_t));
   if (win) {
@@ -75,11 +192,21 @@ b3_win_new(HWND window_handler, char floating)
     win->floating = floating;
 
     GetWindowRect(window_handler, &(win->rect));
+
+    win->handle = b3_win_handle_alloc(win);
+
+    memset(&(win->attr), 0, sizeof(b3_win_attr_t));
+    win->title_version = 0;
+    b3_win_refresh_attr(win);
+
+    win->shown = 0;
+    win->shown_topmost = 0;
+    memset(&(win->shown_rect), 0, sizeof(RECT));
   }
 
 	return win;
-}
-
+}
+
 b3_win_t *
 b3_win_copy(const b3_win_t *win)
 {
@@ -108,9 +235,11 @@ b3_win_set_state(b3_win_t *win, b3_win_state_t state)
 	win->state = state;
 
 	if (win->state == MAXIMIZED) {
-		SendMessage(b3_win_get_window_handler(win), WM_ENTERSIZEMOVE, (WPARAM) NULL, (LPARAM) NULL);
+		win->shown = 0;
+
+		b3_win_send_message(b3_win_get_window_handler(win), WM_ENTERSIZEMOVE);
 		ShowWindow(b3_win_get_window_handler(win), SW_MAXIMIZE);
-		SendMessage(b3_win_get_window_handler(win), WM_EXITSIZEMOVE, (WPARAM) NULL, (LPARAM) NULL);
+		b3_win_send_message(b3_win_get_window_handler(win), WM_EXITSIZEMOVE);
 	}
 	return 0;
 }
@@ -118,54 +247,191 @@ b3_win_set_state(b3_win_t *win, b3_win_state_t state)
 const char *
 b3_win_get_title(b3_win_t *win)
 {
-	// TODO
-	return NULL;
-}
-
-char
-b3_win_get_floating(b3_win_t *win)
-{
-	return win->floating;
-}
-
-int
-b3_win_set_floating(b3_win_t *win, char floating)
-{
-	win->floating = floating;
-	return 0;
-}
-
+	return win->attr.title;
+}
+
+const char *
+b3_win_get_classname(b3_win_t *win)
+{
+	return win->attr.classname;
+}
+
+LONG
+b3_win_get_style(b3_win_t *win)
+{
+	return win->attr.style;
+}
+
+LONG
+b3_win_get_exstyle(b3_win_t *win)
+{
+	return win->attr.exstyle;
+}
+
+HWND
+b3_win_get_owner(b3_win_t *win)
+{
+	return win->attr.owner;
+}
+
+DWORD
+b3_win_get_process_id(b3_win_t *win)
+{
+	return win->attr.process_id;
+}
+
+int
+b3_win_refresh_attr(b3_win_t *win)
+{
+	int error;
+	b3_win_attr_t attr;
+
+	if (g_attr_reader) {
+		error = g_attr_reader(win->window_handler, &attr);
+	} else {
+		error = b3_win_read_attr(win->window_handler, &attr);
+	}
+
+	if (!error) {
+		if (strcmp(attr.title, win->attr.title)) {
+			win->title_version++;
+		}
+
+		memcpy(&(win->attr), &attr, sizeof(b3_win_attr_t));
+	}
+
+	return error;
+}
+
+unsigned int
+b3_win_get_title_version(b3_win_t *win)
+{
+	return win->title_version;
+}
+
+int
+b3_win_set_attr_reader(int reader(HWND window_handler, b3_win_attr_t *attr))
+{
+	g_attr_reader = reader;
+	return 0;
+}
+
+int
+b3_win_set_placement_reader(int reader(HWND window_handler, RECT *rect, char *iconic))
+{
+	g_placement_reader = reader;
+	return 0;
+}
+
+char
+b3_win_get_floating(b3_win_t *win)
+{
+	return win->floating;
+}
+
+int
+b3_win_set_floating(b3_win_t *win, char floating)
+{
+	win->floating = floating;
+	win->shown = 0;
+	return 0;
+}
+
 HWND
 b3_win_get_window_handler(b3_win_t *win)
 {
 	return win->window_handler;
 }
 
+b3_win_handle_t
+b3_win_get_handle(b3_win_t *win)
+{
+	return win->handle;
+}
+
+b3_win_t *
+b3_win_from_handle(b3_win_handle_t handle)
+{
+	b3_win_t *win;
+	int index;
+
+	win = NULL;
+	if (handle != B3_WIN_HANDLE_NULL) {
+		index = handle & 0xFFFF;
+
+		b3_win_lock_slots();
+
+		if (index < g_slot_count
+			&& g_slot_arr[index].generation == (WORD) (handle >> 16)) {
+			win = g_slot_arr[index].win;
+		}
+
+		b3_win_unlock_slots();
+	}
+
+	return win;
+}
+
 int
 b3_win_show(b3_win_t *win, char topmost)
 {
-  b3_win_show_comm_t *comm_data;
+  b3_win_pos_t pos;
 
-  comm_data = malloc(sizeof(b3_win_show_comm_t));
-  comm_data->win = win;
-  comm_data->topmost = topmost;
+  if (!b3_win_is_shown(win, topmost)) {
+    b3_win_mark_shown(win, topmost, &pos);
+    b3_win_batch_queue(&pos, 1, NULL);
+  }
 
-  CreateThread(NULL,
-               0,
-               b3_win_show_exec,
-               (LPVOID) comm_data,
-               0,
-               NULL);
   return 0;
 }
 
+int
+b3_win_is_shown(b3_win_t *win, char topmost)
+{
+  RECT real_rect;
+  char iconic;
+  int error;
+
+  if (!win->shown
+      || win->shown_topmost != topmost
+      || win->state == MAXIMIZED
+      || win->floating
+      || !EqualRect(&(win->shown_rect), &(win->rect))) {
+    return 0;
+  }
+
+  /**
+   * The user might have minimized, moved or snapped the window since it was
+   * shown.
+   */
+  if (g_placement_reader) {
+    error = g_placement_reader(win->window_handler, &real_rect, &iconic);
+  } else {
+    error = b3_win_read_placement(win->window_handler, &real_rect, &iconic);
+  }
+
+  return !error
+    && !iconic
+    && EqualRect(&(win->shown_rect), &real_rect);
+}
+
 int
 b3_win_minimize(b3_win_t *win)
 {
-	SendMessage(b3_win_get_window_handler(win), WM_ENTERSIZEMOVE, (WPARAM) NULL, (LPARAM) NULL);
-   	ShowWindow(win->window_handler, SW_SHOWMINNOACTIVE);
-	SendMessage(b3_win_get_window_handler(win), WM_EXITSIZEMOVE, (WPARAM) NULL, (LPARAM) NULL);
-	return 0;
+	b3_win_pos_t pos;
+
+	win->shown = 0;
+
+	/**
+	 * Minimizing is queued like showing. Otherwise a pending show of the
+	 * window would be applied afterwards.
+	 */
+	memset(&pos, 0, sizeof(b3_win_pos_t));
+	pos.window_handler = win->window_handler;
+	pos.rect = win->rect;
+	pos.minimized = 1;
+
+	return b3_win_batch_queue(&pos, 1, NULL);
 }
 
 RECT
@@ -193,129 +459,282 @@ b3_win_compare(const b3_win_t *win, const b3_win_t *other)
 	}
 }
 
-DWORD WINAPI
-b3_win_show_exec(LPVOID param)
+int
+b3_win_set_positioner(b3_win_positioner_t *positioner)
+{
+  g_positioner = positioner;
+  return 0;
+}
+
+b3_win_batch_t *
+b3_win_batch_new(int commit(const b3_win_pos_t *pos_arr, int length, void *data),
+				 void *commit_data)
 {
-  /** Actual input parameters */
-  b3_win_t *win;
-  char topmost;
+  b3_win_batch_t *batch;
+
+  batch = NULL;
+  batch = malloc(sizeof(b3_win_batch_t));
+  if (batch) {
+    batch->commit = commit;
+    batch->commit_data = commit_data;
+    batch->pos_arr = NULL;
+    batch->pos_arr_size = 0;
+    batch->length = 0;
+  }
+
+  return batch;
+}
+
+int
+b3_win_batch_free(b3_win_batch_t *batch)
+{
+  free(batch->pos_arr);
+  batch->pos_arr = NULL;
+
+  free(batch);
+  return 0;
+}
 
-  b3_win_show_comm_t *comm_data;
+int
+b3_win_batch_begin(b3_win_batch_t *batch)
+{
+  batch->length = 0;
+  return 0;
+}
+
+int
+b3_win_batch_add_pos(b3_win_batch_t *batch, const b3_win_pos_t *pos)
+{
   int error;
-	HWND insert_after;
-	RECT cur_rect;
+  int size;
+  b3_win_pos_t *pos_arr;
 
   error = 0;
 
-  if (!error) {
-    comm_data = (b3_win_show_comm_t *) param;
-    if (comm_data == NULL) {
-      wbk_logger_log(&logger, SEVERE, "Communication data is empty.\n");
+  if (batch->length >= batch->pos_arr_size) {
+    size = batch->pos_arr_size * 2;
+    if (size < B3_WIN_BATCH_MIN_SIZE) {
+      size = B3_WIN_BATCH_MIN_SIZE;
+    }
+
+    pos_arr = realloc(batch->pos_arr, sizeof(b3_win_pos_t) * size);
+    if (pos_arr) {
+      batch->pos_arr = pos_arr;
+      batch->pos_arr_size = size;
+    } else {
+      wbk_logger_log(&logger, SEVERE, "Unable to grow the batch\n");
       error = 1;
     }
   }
 
   if (!error) {
-    win = comm_data->win;
-    topmost = comm_data->topmost;
+    batch->pos_arr[batch->length] = *pos;
+    batch->length++;
+  }
+
+  return error;
+}
+
+int
+b3_win_batch_add(b3_win_batch_t *batch, b3_win_t *win, char topmost)
+{
+  int error;
+  b3_win_pos_t pos;
 
-    free(comm_data);
-    comm_data = NULL;
+  error = 0;
+  if (!b3_win_is_shown(win, topmost)) {
+    b3_win_mark_shown(win, topmost, &pos);
+    error = b3_win_batch_add_pos(batch, &pos);
   }
 
-  if (!error) {
-    if (win == NULL) {
-      wbk_logger_log(&logger, SEVERE, "Window is empty.\n");
-      error = 2;
-    }
+  return error;
+}
+
+int
+b3_win_batch_commit(b3_win_batch_t *batch)
+{
+  int error;
+
+  error = 0;
+  if (batch->length > 0) {
+    error = batch->commit(batch->pos_arr, batch->length, batch->commit_data);
   }
+  batch->length = 0;
 
-  if (!error) {
-    if (b3_win_get_window_handler(win) == NULL) {
-      wbk_logger_log(&logger, SEVERE, "Window handler is empty.\n");
-      error = 3;
+  return error;
+}
+
+int
+b3_win_batch_queue(const b3_win_pos_t *pos_arr, int length, void *data)
+{
+  int error;
+
+  if (g_positioner) {
+    error = b3_win_positioner_push(g_positioner, pos_arr, length);
+  } else {
+    error = b3_win_batch_apply(pos_arr, length, NULL);
+  }
+
+  return error;
+}
+
+int
+b3_win_batch_apply(const b3_win_pos_t *pos_arr, int length, void *data)
+{
+  int error;
+  b3_win_pos_t *valid_pos_arr;
+  int valid_length;
+  int round;
+  int i;
+
+  error = 0;
+
+  /**
+   * Windows might have been destroyed since they were queued. A single one of
+   * them lets positioning all windows at once fail, so skip them.
+   */
+  valid_pos_arr = malloc(sizeof(b3_win_pos_t) * (length > 0 ? length : 1));
+  if (valid_pos_arr == NULL) {
+    wbk_logger_log(&logger, SEVERE, "Unable to position %d windows\n", length);
+    return 1;
+  }
+
+  valid_length = 0;
+  for (i = 0; i < length; i++) {
+    if (!IsWindow(pos_arr[i].window_handler)) {
+      continue;
     }
 
-    insert_after = HWND_BOTTOM;
-    if (topmost) {
-      insert_after = HWND_TOPMOST;
+    if (pos_arr[i].minimized) {
+      b3_win_send_message(pos_arr[i].window_handler, WM_ENTERSIZEMOVE);
+      ShowWindow(pos_arr[i].window_handler, SW_SHOWMINNOACTIVE);
+      b3_win_send_message(pos_arr[i].window_handler, WM_EXITSIZEMOVE);
+    } else {
+      valid_pos_arr[valid_length] = pos_arr[i];
+      valid_length++;
     }
   }
 
-  if (!error) {
-    Sleep(100);
-
-		SendMessage(b3_win_get_window_handler(win), WM_ENTERSIZEMOVE, (WPARAM) NULL, (LPARAM) NULL);
-
-		ShowWindow(b3_win_get_window_handler(win), SW_SHOWNOACTIVATE);
-
-    GetWindowRect(b3_win_get_window_handler(win), &cur_rect);
-    if (b3_win_get_state(win) != MAXIMIZED
-       && EqualRect(&cur_rect, &(win->rect)) == 0
-          && !b3_win_get_floating(win)) {
-        SetWindowPos(b3_win_get_window_handler(win),
-                     insert_after,
-                     win->rect.left,
-                     win->rect.top,
-                     win->rect.right - win->rect.left,
-                     win->rect.bottom - win->rect.top,
-                     SWP_NOMOVE | SWP_NOSIZE | SWP_NOZORDER | SWP_FRAMECHANGED);
-        SetWindowPos(b3_win_get_window_handler(win),
-                     insert_after,
-                     win->rect.left,
-                     win->rect.top,
-                     win->rect.right - win->rect.left,
-                     win->rect.bottom - win->rect.top,
-                     SWP_NOMOVE | SWP_NOSIZE | SWP_NOZORDER | SWP_FRAMECHANGED);
-        SetWindowPos(b3_win_get_window_handler(win),
-                     insert_after,
-                     win->rect.left,
-                     win->rect.top,
-                     win->rect.right - win->rect.left,
-                     win->rect.bottom - win->rect.top,
-                     SWP_NOACTIVATE | SWP_FRAMECHANGED);
-        SetWindowPos(b3_win_get_window_handler(win),
-                     insert_after,
-                     win->rect.left,
-                     win->rect.top,
-                     win->rect.right - win->rect.left,
-                     win->rect.bottom - win->rect.top,
-                     SWP_NOACTIVATE | SWP_FRAMECHANGED);
-    } else {
-      SetWindowPos(b3_win_get_window_handler(win),
-                   insert_after,
-                   win->rect.left,
-                   win->rect.top,
-                   win->rect.right - win->rect.left,
-                   win->rect.bottom - win->rect.top,
-                   SWP_NOMOVE | SWP_NOSIZE | SWP_NOZORDER | SWP_FRAMECHANGED);
-      SetWindowPos(b3_win_get_window_handler(win),
-                   insert_after,
-                   win->rect.left,
-                   win->rect.top,
-                   win->rect.right - win->rect.left,
-                   win->rect.bottom - win->rect.top,
-                   SWP_NOMOVE | SWP_NOSIZE | SWP_NOZORDER | SWP_FRAMECHANGED);
-      SetWindowPos(b3_win_get_window_handler(win),
-                   insert_after,
-                   cur_rect.left,
-                   cur_rect.top,
-                   cur_rect.right - cur_rect.left,
-                   cur_rect.bottom - cur_rect.top,
-                   SWP_NOACTIVATE | SWP_FRAMECHANGED);
-      SetWindowPos(b3_win_get_window_handler(win),
-                   insert_after,
-                   cur_rect.left,
-                   cur_rect.top,
-                   cur_rect.right - cur_rect.left,
-                   cur_rect.bottom - cur_rect.top,
-                   SWP_NOACTIVATE | SWP_FRAMECHANGED);
+  for (i = 0; i < valid_length; i++) {
+    b3_win_send_message(valid_pos_arr[i].window_handler, WM_ENTERSIZEMOVE);
+    ShowWindow(valid_pos_arr[i].window_handler, SW_SHOWNOACTIVATE);
+  }
+
+  /**
+   * Like positioning single windows, everything is done twice. Windows moved
+   * to a monitor with another scaling only get the right size on the second
+   * round.
+   */
+  for (round = 0; valid_length > 0 && round < 2; round++) {
+    /**
+     * First let the windows recalculate their frames, then move all of them
+     * at once.
+     */
+    b3_win_batch_defer(valid_pos_arr, valid_length,
+                       SWP_NOMOVE | SWP_NOSIZE | SWP_NOZORDER | SWP_FRAMECHANGED);
+
+    if (b3_win_batch_defer(valid_pos_arr, valid_length,
+                           SWP_NOACTIVATE | SWP_FRAMECHANGED)) {
+      error = 1;
+    }
+  }
+
+  for (i = 0; i < valid_length; i++) {
+    b3_win_send_message(valid_pos_arr[i].window_handler, WM_EXITSIZEMOVE);
+  }
+
+  free(valid_pos_arr);
+
+  return error;
+}
+
+void
+b3_win_send_message(HWND window_handler, UINT message)
+{
+  SendMessageTimeout(window_handler, message, (WPARAM) NULL, (LPARAM) NULL,
+                     SMTO_ABORTIFHUNG, B3_WIN_MESSAGE_TIMEOUT, NULL);
+}
+
+int
+b3_win_batch_defer(const b3_win_pos_t *pos_arr, int length, UINT flags)
+{
+  int error;
+  HDWP defer_handler;
+  HWND insert_after;
+  RECT rect;
+  int i;
+
+  error = 0;
+
+  defer_handler = BeginDeferWindowPos(length);
+  for (i = 0; defer_handler && i < length; i++) {
+    b3_win_pos_get_target(&(pos_arr[i]), &insert_after, &rect);
+    defer_handler = DeferWindowPos(defer_handler,
+                                   pos_arr[i].window_handler,
+                                   insert_after,
+                                   rect.left,
+                                   rect.top,
+                                   rect.right - rect.left,
+                                   rect.bottom - rect.top,
+                                   flags);
+  }
+
+  if (defer_handler) {
+    EndDeferWindowPos(defer_handler);
+  } else {
+    wbk_logger_log(&logger, WARNING, "Unable to position %d windows at once, positioning them one by one\n", length);
+
+    for (i = 0; i < length; i++) {
+      b3_win_pos_get_target(&(pos_arr[i]), &insert_after, &rect);
+      if (!SetWindowPos(pos_arr[i].window_handler,
+                        insert_after,
+                        rect.left,
+                        rect.top,
+                        rect.right - rect.left,
+                        rect.bottom - rect.top,
+                        flags)) {
+        error = 1;
+      }
     }
 
-		SendMessage(b3_win_get_window_handler(win), WM_EXITSIZEMOVE, (WPARAM) NULL, (LPARAM) NULL);
-	}
+    if (error) {
+      wbk_logger_log(&logger, SEVERE, "Unable to position all of %d windows\n", length);
+    }
+  }
 
-	return 0;
+  return error;
+}
+
+void
+b3_win_mark_shown(b3_win_t *win, char topmost, b3_win_pos_t *pos)
+{
+  win->shown = 1;
+  win->shown_topmost = topmost;
+  win->shown_rect = win->rect;
+
+  pos->window_handler = win->window_handler;
+  pos->rect = win->rect;
+  pos->topmost = topmost;
+  pos->floating = win->floating;
+  pos->maximized = win->state == MAXIMIZED;
+  pos->minimized = 0;
+}
+
+void
+b3_win_pos_get_target(const b3_win_pos_t *pos, HWND *insert_after, RECT *rect)
+{
+  *insert_after = HWND_BOTTOM;
+  if (pos->topmost) {
+    *insert_after = HWND_TOPMOST;
+  }
+
+  /**
+   * Maximized and floating windows keep their current rect.
+   */
+  *rect = pos->rect;
+  if (pos->maximized || pos->floating) {
+    GetWindowRect(pos->window_handler, rect);
+  }
 }
 
 int
@@ -327,6 +746,9 @@ b3_win_is_point_in_rect(b3_win_t *win, POINT *point)
 int
 b3_win_free_impl(b3_win_t *win)
 {
+  b3_win_handle_release(win->handle);
+  win->handle = B3_WIN_HANDLE_NULL;
+
   win->window_handler = NULL;
 
 	free(win);
@@ -349,3 +771,125 @@ b3_win_is_point_in_rect_impl(b3_win_t *win, POINT *point)
 
   return point_is_in_rect;
 }
+
+int
+b3_win_read_attr(HWND window_handler, b3_win_attr_t *attr)
+{
+	attr->title[0] = '\0';
+	attr->classname[0] = '\0';
+
+	GetWindowText(window_handler, attr->title, B3_WIN_ATTR_LENGTH);
+	GetClassName(window_handler, attr->classname, B3_WIN_ATTR_LENGTH);
+	attr->style = GetWindowLong(window_handler, GWL_STYLE);
+	attr->exstyle = GetWindowLong(window_handler, GWL_EXSTYLE);
+	attr->owner = GetWindow(window_handler, GW_OWNER);
+	attr->process_id = 0;
+	GetWindowThreadProcessId(window_handler, &(attr->process_id));
+
+	return 0;
+}
+
+int
+b3_win_read_placement(HWND window_handler, RECT *rect, char *iconic)
+{
+	*iconic = IsIconic(window_handler) ? 1 : 0;
+
+	if (!GetWindowRect(window_handler, rect)) {
+		return 1;
+	}
+
+	return 0;
+}
+
+void
+b3_win_lock_slots(void)
+{
+	CRITICAL_SECTION *lock;
+
+	if (g_slot_lock == NULL) {
+		lock = malloc(sizeof(CRITICAL_SECTION));
+		InitializeCriticalSection(lock);
+		if (InterlockedCompareExchangePointer((PVOID *) &g_slot_lock, lock, NULL) != NULL) {
+			DeleteCriticalSection(lock);
+			free(lock);
+		}
+	}
+
+	EnterCriticalSection(g_slot_lock);
+}
+
+void
+b3_win_unlock_slots(void)
+{
+	LeaveCriticalSection(g_slot_lock);
+}
+
+b3_win_handle_t
+b3_win_handle_alloc(b3_win_t *win)
+{
+	b3_win_handle_t handle;
+	b3_win_slot_t *slot_arr;
+	int index;
+	int size;
+
+	handle = B3_WIN_HANDLE_NULL;
+
+	b3_win_lock_slots();
+
+	index = g_free_slot;
+	if (index >= 0) {
+		g_free_slot = g_slot_arr[index].next_free;
+	} else if (g_slot_count < B3_WIN_HANDLE_TABLE_SIZE) {
+		if (g_slot_count == g_slot_arr_size) {
+			size = g_slot_arr_size ? g_slot_arr_size * 2 : B3_WIN_SLOT_MIN_SIZE;
+			slot_arr = realloc(g_slot_arr, sizeof(b3_win_slot_t) * size);
+			if (slot_arr) {
+				g_slot_arr = slot_arr;
+				g_slot_arr_size = size;
+			}
+		}
+
+		if (g_slot_count < g_slot_arr_size) {
+			index = g_slot_count;
+			g_slot_arr[index].generation = 1;
+			g_slot_count++;
+		}
+	}
+
+	if (index >= 0) {
+		g_slot_arr[index].win = win;
+		g_slot_arr[index].next_free = -1;
+		handle = ((b3_win_handle_t) g_slot_arr[index].generation << 16) | index;
+	} else {
+		wbk_logger_log(&logger, WARNING, "Handle table is full\n");
+	}
+
+	b3_win_unlock_slots();
+
+	return handle;
+}
+
+void
+b3_win_handle_release(b3_win_handle_t handle)
+{
+	int index;
+
+	if (handle != B3_WIN_HANDLE_NULL) {
+		index = handle & 0xFFFF;
+
+		b3_win_lock_slots();
+
+		if (index < g_slot_count
+			&& g_slot_arr[index].generation == (WORD) (handle >> 16)) {
+			g_slot_arr[index].win = NULL;
+			g_slot_arr[index].generation++;
+			if (g_slot_arr[index].generation == 0) {
+				g_slot_arr[index].generation = 1;
+			}
+			g_slot_arr[index].next_free = g_free_slot;
+			g_free_slot = index;
+		}
+
+		b3_win_unlock_slots();
+	}
+}
@@ -41,6 +41,84 @@ typedef enum b3_win_state_e
 
 typedef struct b3_win_s b3_win_t;
 
+#define B3_WIN_ATTR_LENGTH 256
+
+/**
+ * Attributes of a window as read from the window system.
+ */
+typedef struct b3_win_attr_s
+{
+	char title[B3_WIN_ATTR_LENGTH];
+	char classname[B3_WIN_ATTR_LENGTH];
+	LONG style;
+	LONG exstyle;
+	HWND owner;
+	DWORD process_id;
+} b3_win_attr_t;
+
+/**
+ * Compact reference to a window. The lower 16 bits are the index of the slot
+ * of the window in the handle table, the upper 16 bits are the generation of
+ * the slot. A slot gets a new generation if its window is freed, so handles
+ * of freed windows resolve to NULL.
+ */
+typedef UINT32 b3_win_handle_t;
+
+#define B3_WIN_HANDLE_NULL 0
+
+/**
+ * Maximum number of windows having a handle at the same time.
+ */
+#define B3_WIN_HANDLE_TABLE_SIZE 65536
+
+/**
+ * Milliseconds to wait for a window to handle a message. Hung windows do not
+ * block b3 any longer than that.
+ */
+#define B3_WIN_MESSAGE_TIMEOUT 200
+
+typedef struct b3_win_positioner_s b3_win_positioner_t;
+
+/**
+ * Snapshot of everything needed to position a window.
+ */
+typedef struct b3_win_pos_s
+{
+	HWND window_handler;
+	RECT rect;
+	char topmost;
+	char floating;
+	char maximized;
+
+	/**
+	 * Non-0 if the window is minimized instead of positioned.
+	 */
+	char minimized;
+} b3_win_pos_t;
+
+typedef struct b3_win_batch_s b3_win_batch_t;
+
+/**
+ * Collects the positions of several windows, which are then committed at once.
+ */
+struct b3_win_batch_s
+{
+	/**
+	 * Backend receiving all positions of the batch on commit. Use
+	 * b3_win_batch_queue() to position the windows on the screen.
+	 */
+	int (*commit)(const b3_win_pos_t *pos_arr, int length, void *data);
+	void *commit_data;
+
+	/**
+	 * The positions added since the last begin. The buffer is reused by every
+	 * batch and only grows if needed.
+	 */
+	b3_win_pos_t *pos_arr;
+	int pos_arr_size;
+	int length;
+};
+
 struct b3_win_s
 {
 	int (*b3_win_free)(b3_win_t *win);
@@ -50,6 +128,31 @@ struct b3_win_s
 	HWND window_handler;
 	char floating;
 	RECT rect;
+
+	/**
+	 * B3_WIN_HANDLE_NULL if the handle table was full when the window was
+	 * created.
+	 */
+	b3_win_handle_t handle;
+
+	/**
+	 * Read by b3_win_new() and refreshed by b3_win_refresh_attr().
+	 */
+	b3_win_attr_t attr;
+
+	/**
+	 * Incremented whenever b3_win_refresh_attr() reads another title.
+	 */
+	unsigned int title_version;
+
+	/**
+	 * The rect and the z-state last applied by b3_win_show(). shown is 0 if
+	 * the window was not shown yet or if it was changed otherwise since then
+	 * (e.g. minimized or maximized).
+	 */
+	char shown;
+	char shown_topmost;
+	RECT shown_rect;
 };
 
 /**
@@ -71,9 +174,75 @@ b3_win_copy(const b3_win_t *win);
 extern int
 b3_win_free(b3_win_t *win);
 
+/**
+ * @return The cached title of the window. Do not free it!
+ */
 extern const char *
 b3_win_get_title(b3_win_t *win);
 
+/**
+ * @return The cached class name of the window. Do not free it!
+ */
+extern const char *
+b3_win_get_classname(b3_win_t *win);
+
+/**
+ * @return The cached style (GWL_STYLE) of the window.
+ */
+extern LONG
+b3_win_get_style(b3_win_t *win);
+
+/**
+ * @return The cached extended style (GWL_EXSTYLE) of the window.
+ */
+extern LONG
+b3_win_get_exstyle(b3_win_t *win);
+
+/**
+ * @return The cached owner of the window. NULL if it has no owner.
+ */
+extern HWND
+b3_win_get_owner(b3_win_t *win);
+
+/**
+ * @return The cached id of the process that created the window.
+ */
+extern DWORD
+b3_win_get_process_id(b3_win_t *win);
+
+/**
+ * Reads the attributes of the window again, e.g. after its title changed.
+ */
+extern int
+b3_win_refresh_attr(b3_win_t *win);
+
+/**
+ * @return A number changing whenever the cached title changes. Together with
+ * the handle of the window it identifies a title.
+ */
+extern unsigned int
+b3_win_get_title_version(b3_win_t *win);
+
+/**
+ * Sets the function used by b3_win_new() and b3_win_refresh_attr() to read
+ * the attributes of all windows. It allows faking the window system in tests.
+ *
+ * @param reader Fills attr with the attributes of the window. Returns non-0
+ * on failure. Pass NULL to read the attributes from the Win32 API.
+ */
+extern int
+b3_win_set_attr_reader(int reader(HWND window_handler, b3_win_attr_t *attr));
+
+/**
+ * Sets the function used by b3_win_is_shown() to read the real rect and the
+ * iconic state of all windows. It allows faking the window system in tests.
+ *
+ * @param reader Fills rect and iconic with the state of the window on the
+ * screen. Returns non-0 on failure. Pass NULL to read them from the Win32 API.
+ */
+extern int
+b3_win_set_placement_reader(int reader(HWND window_handler, RECT *rect, char *iconic));
+
 extern b3_win_state_t
 b3_win_get_state(b3_win_t *win);
 
@@ -98,14 +267,132 @@ extern HWND
 b3_win_get_window_handler(b3_win_t *win);
 
 /**
+ * @return The handle of the window. Keep it instead of the window if the
+ * window might be freed meanwhile.
+ */
+extern b3_win_handle_t
+b3_win_get_handle(b3_win_t *win);
+
+/**
+ * The returned window is only valid until it is freed, so do not store it.
+ * Resolving the handle does not keep the window from being freed. Callers
+ * must make sure it is not freed while they use it. For windows managed by
+ * the director, hold the lock of the director (i.e. call it from within the
+ * director) from resolving until the last use.
+ *
+ * @return The window of the handle. NULL if the window was freed already or if
+ * handle is B3_WIN_HANDLE_NULL. Do not free it!
+ */
+extern b3_win_t *
+b3_win_from_handle(b3_win_handle_t handle);
+
+/**
+ * Shows the window at its rect. Nothing is done if the window is already
+ * shown at its rect with the same z-state (see b3_win_is_shown()).
+ *
+ * It is the same as committing a batch only containing the window to
+ * b3_win_batch_queue().
+ *
  * @param topmost Either 1 or 0.
  */
 extern int
 b3_win_show(b3_win_t *win, char topmost);
 
+/**
+ * @param topmost Either 1 or 0.
+ * @return Non-0 if the last b3_win_show() or b3_win_batch_add() already
+ * applied the current rect and topmost to the window and the window is still
+ * there, i.e. it was neither minimized nor moved otherwise since then.
+ * Floating windows are never considered as shown, since they have to be raised
+ * above the tiled ones again.
+ */
+extern int
+b3_win_is_shown(b3_win_t *win, char topmost);
+
+/**
+ * Minimizes the window. It is queued like b3_win_show(), hence it replaces a
+ * pending position of the window.
+ */
 extern int
 b3_win_minimize(b3_win_t *win);
 
+/**
+ * Sets the positioner used by b3_win_batch_queue() for all windows.
+ *
+ * @param positioner Will not be freed. Pass NULL to position windows
+ * immediately.
+ */
+extern int
+b3_win_set_positioner(b3_win_positioner_t *positioner);
+
+/**
+ * @brief Creates a new positioning batch
+ * @param commit Backend receiving all positions on commit.
+ * @param commit_data Passed to every call of commit. Will not be freed.
+ * @return A new batch or NULL if allocation failed
+ */
+extern b3_win_batch_t *
+b3_win_batch_new(int commit(const b3_win_pos_t *pos_arr, int length, void *data),
+				 void *commit_data);
+
+extern int
+b3_win_batch_free(b3_win_batch_t *batch);
+
+/**
+ * Starts a new batch. Positions added but not committed are dropped.
+ */
+extern int
+b3_win_batch_begin(b3_win_batch_t *batch);
+
+/**
+ * Adds a position to the batch.
+ *
+ * @param pos Is copied.
+ * @return 0 if added. Non-0 otherwise.
+ */
+extern int
+b3_win_batch_add_pos(b3_win_batch_t *batch, const b3_win_pos_t *pos);
+
+/**
+ * Adds the window at its rect to the batch, unless it is already shown like
+ * that (see b3_win_is_shown()).
+ *
+ * @param topmost Either 1 or 0.
+ * @return 0 if added or skipped. Non-0 otherwise.
+ */
+extern int
+b3_win_batch_add(b3_win_batch_t *batch, b3_win_t *win, char topmost);
+
+/**
+ * Hands all positions added since the last begin to the backend at once. The
+ * backend is not called for an empty batch.
+ *
+ * @return 0 if committed. Non-0 otherwise.
+ */
+extern int
+b3_win_batch_commit(b3_win_batch_t *batch);
+
+/**
+ * Backend of a batch queuing the positions in the positioner set by
+ * b3_win_set_positioner(). If there is none, then the positions are applied
+ * immediately by b3_win_batch_apply().
+ *
+ * @param data Is not used.
+ */
+extern int
+b3_win_batch_queue(const b3_win_pos_t *pos_arr, int length, void *data);
+
+/**
+ * Positions the windows on the screen in one go by using
+ * BeginDeferWindowPos(), DeferWindowPos() and EndDeferWindowPos(). It is the
+ * sink of the positioner used in production.
+ *
+ * @param data Is not used.
+ * @return 0 if the windows were positioned. Non-0 otherwise.
+ */
+extern int
+b3_win_batch_apply(const b3_win_pos_t *pos_arr, int length, void *data);
+
 extern RECT
 b3_win_get_rect(b3_win_t *win);
 
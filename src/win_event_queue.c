@@ -0,0 +1,425 @@
+/******************************************************************************
+  This file is part of b3.
+
+  Copyright 2021 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * @author Richard Bäck <richard.baeck@mailbox.org>
+ * @date 2021-04-17
+ * @brief File contains the window event queue class implementation and private methods
+ */
+
+#include "win_event_queue.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <w32bindkeys/logger.h>
+
+static wbk_logger_t logger = { "win_event_queue" };
+
+static int
+b3_win_event_queue_free_impl(b3_win_event_queue_t *queue);
+
+static int
+b3_win_event_queue_push_impl(b3_win_event_queue_t *queue, b3_win_event_type_t type, HWND window_handler);
+
+static int
+b3_win_event_queue_process_impl(b3_win_event_queue_t *queue);
+
+static int
+b3_win_event_queue_start_impl(b3_win_event_queue_t *queue);
+
+static int
+b3_win_event_queue_stop_impl(b3_win_event_queue_t *queue);
+
+/**
+ * Removes the oldest event from the ring buffer, unless it is a creation that
+ * is still held back.
+ *
+ * @return 0 if an event was removed. Non-0 otherwise.
+ */
+static int
+b3_win_event_queue_pop(b3_win_event_queue_t *queue, b3_win_event_t *event);
+
+/**
+ * Removes all pending events of a window, if its creation is still held back.
+ * The mutex must be held.
+ *
+ * @return The number of removed events.
+ */
+static int
+b3_win_event_queue_cancel(b3_win_event_queue_t *queue, HWND window_handler, DWORD now);
+
+/**
+ * @return The time in milliseconds the consumer may sleep until it has to
+ * handle the next event. INFINITE if the queue is empty.
+ */
+static DWORD
+b3_win_event_queue_get_timeout(b3_win_event_queue_t *queue);
+
+/**
+ * Main loop of the consumer thread.
+ *
+ * @param param Actually from type b3_win_event_queue_t *
+ */
+static DWORD WINAPI
+b3_win_event_queue_run(LPVOID param);
+
+b3_win_event_queue_t *
+b3_win_event_queue_new(int length,
+					   int handler(const b3_win_event_t *event, void *data),
+					   void *handler_data)
+{
+	b3_win_event_queue_t *queue;
+
+	queue = NULL;
+	queue = malloc(sizeof(b3_win_event_queue_t));
+	if (queue) {
+		queue->b3_win_event_queue_free = b3_win_event_queue_free_impl;
+		queue->b3_win_event_queue_push = b3_win_event_queue_push_impl;
+		queue->b3_win_event_queue_process = b3_win_event_queue_process_impl;
+		queue->b3_win_event_queue_start = b3_win_event_queue_start_impl;
+		queue->b3_win_event_queue_stop = b3_win_event_queue_stop_impl;
+
+		queue->handler = handler;
+		queue->handler_data = handler_data;
+		queue->grace_period = B3_WIN_EVENT_QUEUE_GRACE_PERIOD;
+
+		queue->mutex = CreateMutex(NULL, FALSE, NULL);
+		queue->wake_event = CreateEvent(NULL, FALSE, FALSE, NULL);
+		queue->thread = NULL;
+		queue->running = 0;
+
+		queue->event_arr = malloc(sizeof(b3_win_event_t) * length);
+		queue->event_arr_length = length;
+		queue->event_arr_head = 0;
+		queue->event_count = 0;
+
+		queue->push_count = 0;
+		queue->refuse_count = 0;
+		queue->merge_count = 0;
+		queue->drop_count = 0;
+		queue->handle_count = 0;
+
+		if (queue->event_arr == NULL) {
+			b3_win_event_queue_free(queue);
+			queue = NULL;
+		}
+	}
+
+	return queue;
+}
+
+int
+b3_win_event_queue_free(b3_win_event_queue_t *queue)
+{
+	return queue->b3_win_event_queue_free(queue);
+}
+
+int
+b3_win_event_queue_push(b3_win_event_queue_t *queue, b3_win_event_type_t type, HWND window_handler)
+{
+	return queue->b3_win_event_queue_push(queue, type, window_handler);
+}
+
+int
+b3_win_event_queue_process(b3_win_event_queue_t *queue)
+{
+	return queue->b3_win_event_queue_process(queue);
+}
+
+int
+b3_win_event_queue_start(b3_win_event_queue_t *queue)
+{
+	return queue->b3_win_event_queue_start(queue);
+}
+
+int
+b3_win_event_queue_stop(b3_win_event_queue_t *queue)
+{
+	return queue->b3_win_event_queue_stop(queue);
+}
+
+int
+b3_win_event_queue_free_impl(b3_win_event_queue_t *queue)
+{
+	if (queue->running) {
+		b3_win_event_queue_stop(queue);
+	}
+
+	free(queue->event_arr);
+	queue->event_arr = NULL;
+
+	CloseHandle(queue->wake_event);
+	CloseHandle(queue->mutex);
+
+	free(queue);
+
+	return 0;
+}
+
+int
+b3_win_event_queue_push_impl(b3_win_event_queue_t *queue, b3_win_event_type_t type, HWND window_handler)
+{
+	b3_win_event_t *event;
+	DWORD now;
+	int cancel_count;
+	int error;
+
+	now = GetTickCount();
+
+	WaitForSingleObject(queue->mutex, INFINITE);
+
+	event = NULL;
+	if (queue->event_count > 0) {
+		event = &(queue->event_arr[(queue->event_arr_head + queue->event_count - 1)
+								   % queue->event_arr_length]);
+	}
+
+	error = 0;
+	cancel_count = 0;
+	if (type == WIN_ACTIVATED && event && event->type == WIN_ACTIVATED) {
+		event->window_handler = window_handler;
+		event->time = now;
+		queue->merge_count++;
+	} else if (type == WIN_REDRAWN && event && event->type == WIN_REDRAWN
+			   && event->window_handler == window_handler) {
+		event->time = now;
+		queue->merge_count++;
+	} else if (type == WIN_DESTROYED
+			   && (cancel_count = b3_win_event_queue_cancel(queue, window_handler, now)) > 0) {
+		queue->drop_count += cancel_count + 1;
+	} else if (queue->event_count < queue->event_arr_length) {
+		event = &(queue->event_arr[(queue->event_arr_head + queue->event_count)
+								   % queue->event_arr_length]);
+		event->type = type;
+		event->window_handler = window_handler;
+		event->time = now;
+		queue->event_count++;
+	} else {
+		queue->refuse_count++;
+		error = 1;
+	}
+
+	if (!error) {
+		queue->push_count++;
+	}
+
+	ReleaseMutex(queue->mutex);
+
+	if (!error) {
+		SetEvent(queue->wake_event);
+	} else {
+		wbk_logger_log(&logger, WARNING, "Queue is full - dropping event %d of window %p\n",
+					   type, window_handler);
+	}
+
+	return error;
+}
+
+int
+b3_win_event_queue_process_impl(b3_win_event_queue_t *queue)
+{
+	b3_win_event_t event;
+	int handle_count;
+
+	handle_count = 0;
+	while (b3_win_event_queue_pop(queue, &event) == 0) {
+		/**
+		 * The handler runs without the mutex, so pushing is never blocked by
+		 * the director.
+		 */
+		queue->handler(&event, queue->handler_data);
+		handle_count++;
+	}
+
+	WaitForSingleObject(queue->mutex, INFINITE);
+	queue->handle_count += handle_count;
+	ReleaseMutex(queue->mutex);
+
+	return handle_count;
+}
+
+int
+b3_win_event_queue_pop(b3_win_event_queue_t *queue, b3_win_event_t *event)
+{
+	int error;
+
+	WaitForSingleObject(queue->mutex, INFINITE);
+
+	error = 1;
+	if (queue->event_count > 0 && b3_win_event_queue_get_timeout(queue) == 0) {
+		*event = queue->event_arr[queue->event_arr_head];
+		queue->event_arr_head = (queue->event_arr_head + 1) % queue->event_arr_length;
+		queue->event_count--;
+		error = 0;
+	}
+
+	ReleaseMutex(queue->mutex);
+
+	return error;
+}
+
+int
+b3_win_event_queue_cancel(b3_win_event_queue_t *queue, HWND window_handler, DWORD now)
+{
+	b3_win_event_t *event;
+	int created;
+	int kept_count;
+	int i;
+
+	created = 0;
+	kept_count = 0;
+	if (queue->grace_period > 0) {
+		for (i = 0; i < queue->event_count; i++) {
+			event = &(queue->event_arr[(queue->event_arr_head + i) % queue->event_arr_length]);
+
+			if (!created
+				&& event->type == WIN_CREATED
+				&& event->window_handler == window_handler
+				&& now - event->time <= queue->grace_period) {
+				created = 1;
+			}
+
+			/**
+			 * Move every event not belonging to the cancelled window to the
+			 * front, so the order of the remaining ones is kept.
+			 */
+			if (!created || event->window_handler != window_handler) {
+				queue->event_arr[(queue->event_arr_head + kept_count) % queue->event_arr_length] = *event;
+				kept_count++;
+			}
+		}
+	}
+
+	i = 0;
+	if (created) {
+		i = queue->event_count - kept_count;
+		queue->event_count = kept_count;
+	}
+
+	return i;
+}
+
+DWORD
+b3_win_event_queue_get_timeout(b3_win_event_queue_t *queue)
+{
+	b3_win_event_t *event;
+	DWORD age;
+	DWORD timeout;
+
+	WaitForSingleObject(queue->mutex, INFINITE);
+
+	timeout = INFINITE;
+	if (queue->event_count > 0) {
+		timeout = 0;
+
+		event = &(queue->event_arr[queue->event_arr_head]);
+		if (event->type == WIN_CREATED) {
+			age = GetTickCount() - event->time;
+			if (age < queue->grace_period) {
+				timeout = queue->grace_period - age;
+			}
+		}
+	}
+
+	ReleaseMutex(queue->mutex);
+
+	return timeout;
+}
+
+int
+b3_win_event_queue_start_impl(b3_win_event_queue_t *queue)
+{
+	int error;
+
+	error = 1;
+	if (!queue->running) {
+		queue->running = 1;
+		queue->thread = CreateThread(NULL,
+									 0,
+									 b3_win_event_queue_run,
+									 (LPVOID) queue,
+									 0,
+									 NULL);
+		if (queue->thread) {
+			error = 0;
+		} else {
+			wbk_logger_log(&logger, SEVERE, "Unable to start the consumer\n");
+			queue->running = 0;
+		}
+	}
+
+	return error;
+}
+
+int
+b3_win_event_queue_stop_impl(b3_win_event_queue_t *queue)
+{
+	int error;
+
+	error = 1;
+	if (queue->running) {
+		queue->running = 0;
+		SetEvent(queue->wake_event);
+
+		WaitForSingleObject(queue->thread, INFINITE);
+		CloseHandle(queue->thread);
+		queue->thread = NULL;
+
+		wbk_logger_log(&logger, INFO,
+					   "Events pushed: %d, handled: %d, merged: %d, dropped: %d, refused: %d\n",
+					   queue->push_count,
+					   queue->handle_count,
+					   queue->merge_count,
+					   queue->drop_count,
+					   queue->refuse_count);
+
+		error = 0;
+	}
+
+	return error;
+}
+
+DWORD WINAPI
+b3_win_event_queue_run(LPVOID param)
+{
+	b3_win_event_queue_t *queue;
+	DWORD timeout;
+
+	queue = (b3_win_event_queue_t *) param;
+
+	timeout = INFINITE;
+	while (queue->running) {
+		/**
+		 * Wake up on new events or when the creation at the head is due.
+		 */
+		WaitForSingleObject(queue->wake_event, timeout);
+
+		if (queue->running) {
+			b3_win_event_queue_process(queue);
+			timeout = b3_win_event_queue_get_timeout(queue);
+		}
+	}
+
+	return 0;
+}
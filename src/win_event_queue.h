@@ -0,0 +1,210 @@
+/******************************************************************************
+  This file is part of b3.
+
+  Copyright 2021 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * @author Richard Bäck <richard.baeck@mailbox.org>
+ * @date 2021-04-17
+ * @brief File contains the window event queue class definition
+ */
+
+#include <windows.h>
+
+#ifndef B3_WIN_EVENT_QUEUE_H
+#define B3_WIN_EVENT_QUEUE_H
+
+/**
+ * Default number of events the queue holds before it refuses new ones.
+ */
+#define B3_WIN_EVENT_QUEUE_LENGTH 1024
+
+/**
+ * Default time in milliseconds a created window is held back. If it is
+ * destroyed in the meantime, neither event reaches the handler.
+ */
+#define B3_WIN_EVENT_QUEUE_GRACE_PERIOD 100
+
+/**
+ * Maximum grace period in milliseconds. The events behind a held back creation
+ * wait as well, so a longer one would stall the window management.
+ */
+#define B3_WIN_EVENT_QUEUE_MAX_GRACE_PERIOD 10000
+
+typedef enum b3_win_event_type_e
+{
+	WIN_CREATED = 0,
+	WIN_DESTROYED,
+	WIN_ACTIVATED,
+
+	/**
+	 * The title of the window changed.
+	 */
+	WIN_REDRAWN
+} b3_win_event_type_t;
+
+typedef struct b3_win_event_s
+{
+	b3_win_event_type_t type;
+	HWND window_handler;
+
+	/**
+	 * Result of GetTickCount() when the event was pushed.
+	 */
+	DWORD time;
+} b3_win_event_t;
+
+typedef struct b3_win_event_queue_s b3_win_event_queue_t;
+
+struct b3_win_event_queue_s
+{
+	int (* b3_win_event_queue_free)(b3_win_event_queue_t *queue);
+	int (* b3_win_event_queue_push)(b3_win_event_queue_t *queue, b3_win_event_type_t type, HWND window_handler);
+	int (* b3_win_event_queue_process)(b3_win_event_queue_t *queue);
+	int (* b3_win_event_queue_start)(b3_win_event_queue_t *queue);
+	int (* b3_win_event_queue_stop)(b3_win_event_queue_t *queue);
+
+	/**
+	 * Applies a single event. It is only called by one thread at a time and
+	 * in the order the events were pushed.
+	 */
+	int (* handler)(const b3_win_event_t *event, void *data);
+	void *handler_data;
+
+	/**
+	 * Time in milliseconds a WIN_CREATED event is held back before it is
+	 * handled. The events behind it wait as well to keep the order. 0 disables
+	 * the cancelling of short-lived windows.
+	 */
+	DWORD grace_period;
+
+	/**
+	 * Guards the ring buffer and the counters.
+	 */
+	HANDLE mutex;
+
+	/**
+	 * Auto-reset event signaled if events are pending or the consumer should
+	 * stop.
+	 */
+	HANDLE wake_event;
+
+	HANDLE thread;
+	char running;
+
+	/**
+	 * Ring buffer of the pending events. The oldest one is at event_arr_head.
+	 */
+	b3_win_event_t *event_arr;
+	int event_arr_length;
+	int event_arr_head;
+	int event_count;
+
+	/**
+	 * Number of events accepted by b3_win_event_queue_push().
+	 */
+	int push_count;
+
+	/**
+	 * Number of events refused because the queue was full.
+	 */
+	int refuse_count;
+
+	/**
+	 * Number of activations and redraws replaced by a directly following one.
+	 */
+	int merge_count;
+
+	/**
+	 * Number of events cancelled, because their window was destroyed within
+	 * the grace period after its creation. It includes the destruction.
+	 */
+	int drop_count;
+
+	/**
+	 * Number of events passed to the handler.
+	 */
+	int handle_count;
+};
+
+/**
+ * @brief Creates a new window event queue. The consumer is not started yet.
+ * @param length Maximum number of pending events.
+ * @param handler Applies an event. It is called by the consumer thread or by
+ * b3_win_event_queue_process().
+ * @param handler_data Passed to every call of handler. Will not be freed.
+ * @return A new window event queue or NULL if allocation failed
+ */
+extern b3_win_event_queue_t *
+b3_win_event_queue_new(int length,
+					   int handler(const b3_win_event_t *event, void *data),
+					   void *handler_data);
+
+/**
+ * @brief Deletes a window event queue. The consumer is stopped if it is
+ * running. Pending events are dropped.
+ * @return Non-0 if the deletion failed
+ */
+extern int
+b3_win_event_queue_free(b3_win_event_queue_t *queue);
+
+/**
+ * Appends an event to the queue and wakes up the consumer. It never blocks on
+ * the consumer, so it is safe to call it from a window procedure.
+ *
+ * The pending events are coalesced:
+ * - An activation directly following another one replaces it.
+ * - A redraw directly following another one of the same window replaces it.
+ * - The destruction of a window whose creation is still held back cancels all
+ *   pending events of the window.
+ *
+ * @return 0 if the event was queued. Non-0 if the queue is full.
+ */
+extern int
+b3_win_event_queue_push(b3_win_event_queue_t *queue, b3_win_event_type_t type, HWND window_handler);
+
+/**
+ * Passes the pending events to the handler in the order they were pushed,
+ * until the queue is empty or a creation younger than grace_period is
+ * reached.
+ *
+ * @return The number of handled events.
+ */
+extern int
+b3_win_event_queue_process(b3_win_event_queue_t *queue);
+
+/**
+ * @brief Starts the consumer thread.
+ * @return 0 if the consumer was started. Non-0 otherwise.
+ */
+extern int
+b3_win_event_queue_start(b3_win_event_queue_t *queue);
+
+/**
+ * @brief Stops the consumer thread once the events it is processing are
+ * handled.
+ * @return 0 if the consumer was stopped. Non-0 otherwise.
+ */
+extern int
+b3_win_event_queue_stop(b3_win_event_queue_t *queue);
+
+#endif // B3_WIN_EVENT_QUEUE_H
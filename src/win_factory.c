@@ -42,10 +42,14 @@ b3_win_factory_win_create_impl(b3_win_factory_t *win_factory, HWND window_handle
 static int
 b3_win_factory_win_free_impl(b3_win_factory_t *win_factory, b3_win_t *win);
 
+static b3_win_t *
+b3_win_factory_win_get_impl(b3_win_factory_t *win_factory, HWND window_handler);
+
 b3_win_factory_t *
 b3_win_factory_new(void)
 {
 	b3_win_factory_t *win_factory;
+	HashTableConf conf;
 
 	win_factory = malloc(sizeof(b3_win_factory_t));
 	if (win_factory) {
@@ -54,9 +58,16 @@ b3_win_factory_new(void)
 		win_factory->b3_win_factory_free = b3_win_factory_free_impl;
 		win_factory->b3_win_factory_win_create = b3_win_factory_win_create_impl;
 		win_factory->b3_win_factory_win_free = b3_win_factory_win_free_impl;
+		win_factory->b3_win_factory_win_get = b3_win_factory_win_get_impl;
 
         win_factory->global_mutex = CreateMutex(NULL, FALSE, NULL);
-		array_new(&(win_factory->win_arr));
+
+		hashtable_conf_init(&conf);
+		conf.hash = POINTER_HASH;
+		conf.key_compare = cc_common_cmp_ptr;
+		conf.key_length = KEY_LENGTH_POINTER;
+		win_factory->win_table = NULL;
+		hashtable_new_conf(&conf, &(win_factory->win_table));
 	}
 
 	return win_factory;
@@ -80,23 +91,28 @@ b3_win_factory_win_free(b3_win_factory_t *win_factory, b3_win_t *win)
 	return win_factory->b3_win_factory_win_free(win_factory, win);
 }
 
+b3_win_t *
+b3_win_factory_win_get(b3_win_factory_t *win_factory, HWND window_handler)
+{
+	return win_factory->b3_win_factory_win_get(win_factory, window_handler);
+}
+
 int
 b3_win_factory_free_impl(b3_win_factory_t *win_factory)
 {
-	ArrayIter iter;
-	b3_win_t *win_iter;
+	HashTableIter iter;
+	TableEntry *entry;
 
 	ReleaseMutex(win_factory->global_mutex);
 	CloseHandle(win_factory->global_mutex);
 	win_factory->global_mutex = NULL;
 
-	array_iter_init(&iter, win_factory->win_arr);
-	while (array_iter_next(&iter, (void *) &win_iter) != CC_ITER_END) {
-		array_iter_remove(&iter, NULL);
-		b3_win_free(win_iter);
+	hashtable_iter_init(&iter, win_factory->win_table);
+	while (hashtable_iter_next(&iter, &entry) != CC_ITER_END) {
+		b3_win_free(entry->value);
 	}
-	array_destroy(win_factory->win_arr);
-	win_factory->win_arr = NULL;
+	hashtable_destroy(win_factory->win_table);
+	win_factory->win_table = NULL;
 
 	free(win_factory);
 
@@ -106,29 +122,18 @@ b3_win_factory_free_impl(b3_win_factory_t *win_factory)
 b3_win_t *
 b3_win_factory_win_create_impl(b3_win_factory_t *win_factory, HWND window_handler)
 {
-	ArrayIter iter;
-	b3_win_t *win_iter;
-	b3_win_t *win_new;
 	b3_win_t *win;
 
 	WaitForSingleObject(win_factory->global_mutex, INFINITE);
 
-	win_new = b3_win_new(window_handler, 0);
 	win = NULL;
-	array_iter_init(&iter, win_factory->win_arr);
-	while (win == NULL && array_iter_next(&iter, (void *) &win_iter) != CC_ITER_END) {
-		if (b3_win_compare(win_new, win_iter) == 0) {
-			win = win_iter;
+	if (hashtable_get(win_factory->win_table, window_handler, (void *) &win) != CC_OK) {
+		win = b3_win_new(window_handler, 0);
+		if (win) {
+			hashtable_add(win_factory->win_table, window_handler, win);
 		}
 	}
 
-	if (win) {
-		b3_win_free(win_new);
-	} else {
-		win = win_new;
-		array_add(win_factory->win_arr, win);
-	}
-
 	ReleaseMutex(win_factory->global_mutex);
 
 	return win;
@@ -138,26 +143,18 @@ int
 b3_win_factory_win_free_impl(b3_win_factory_t *win_factory, b3_win_t *win)
 {
 	int error;
-	ArrayIter iter;
-	b3_win_t *win_iter;
-	char found;
+	b3_win_t *win_found;
 
 	error = 1;
 
 	WaitForSingleObject(win_factory->global_mutex, INFINITE);
 
-	found = 0;
-	array_iter_init(&iter, win_factory->win_arr);
-	while (!found && array_iter_next(&iter, (void *) &win_iter) != CC_ITER_END) {
-		if (b3_win_compare(win, win_iter) == 0) {
-			array_iter_remove(&iter, NULL);
-			found = 1;
-		}
-	}
-
-	if (found) {
-		if (win_iter != win) {
-			b3_win_free(win_iter);
+	win_found = NULL;
+	if (hashtable_remove(win_factory->win_table,
+						 b3_win_get_window_handler(win),
+						 (void *) &win_found) == CC_OK) {
+		if (win_found != win) {
+			b3_win_free(win_found);
 		}
 		error = b3_win_free(win);
 	}
@@ -166,3 +163,18 @@ b3_win_factory_win_free_impl(b3_win_factory_t *win_factory, b3_win_t *win)
 
 	return error;
 }
+
+b3_win_t *
+b3_win_factory_win_get_impl(b3_win_factory_t *win_factory, HWND window_handler)
+{
+	b3_win_t *win;
+
+	WaitForSingleObject(win_factory->global_mutex, INFINITE);
+
+	win = NULL;
+	hashtable_get(win_factory->win_table, window_handler, (void *) &win);
+
+	ReleaseMutex(win_factory->global_mutex);
+
+	return win;
+}
@@ -28,7 +28,7 @@
  * @brief File contains the window factory class definition
  */
 
-#include <collectc/array.h>
+#include <collectc/hashtable.h>
 #include <windows.h>
 
 #include "win.h"
@@ -43,13 +43,16 @@ struct b3_win_factory_s
 	int (* b3_win_factory_free)(b3_win_factory_t *win_factory);
 	b3_win_t *(* b3_win_factory_win_create)(b3_win_factory_t *win_factory, HWND window_handler);
 	int (* b3_win_factory_win_free)(b3_win_factory_t *win_factory, b3_win_t *win);
+	b3_win_t *(* b3_win_factory_win_get)(b3_win_factory_t *win_factory, HWND window_handler);
 
 	HANDLE global_mutex;
 
 	/**
-	 *  Array of b3_win_t *
+	 * HashTable of HWND -> b3_win_t *
+	 *
+	 * Owns all created windows.
 	 */
-	Array *win_arr;
+	HashTable *win_table;
 };
 
 /**
@@ -67,7 +70,11 @@ extern int
 b3_win_factory_free(b3_win_factory_t *win_factory);
 
 /**
- * @return A new window. Free it by yourself by using b3_win_factory_free()!
+ * Only allocates a new window if the factory does not already own a window
+ * of window_handler.
+ *
+ * @return The window of window_handler. Free it by yourself by using
+ * b3_win_factory_win_free()!
  */
 extern b3_win_t *
 b3_win_factory_win_create(b3_win_factory_t *win_factory, HWND window_handler);
@@ -78,4 +85,11 @@ b3_win_factory_win_create(b3_win_factory_t *win_factory, HWND window_handler);
 extern int
 b3_win_factory_win_free(b3_win_factory_t *win_factory, b3_win_t *win);
 
+/**
+ * @return The window of window_handler if it was already created by the
+ * factory. NULL otherwise. Do not free it!
+ */
+extern b3_win_t *
+b3_win_factory_win_get(b3_win_factory_t *win_factory, HWND window_handler);
+
 #endif // B3_WIN_FACTORY_H
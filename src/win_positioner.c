@@ -0,0 +1,329 @@
+/******************************************************************************
+  This file is part of b3.
+
+  Copyright 2021 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * @author Richard Bäck <richard.baeck@mailbox.org>
+ * @date 2021-04-17
+ * @brief File contains the window positioner class implementation and private methods
+ */
+
+#include "win_positioner.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <w32bindkeys/logger.h>
+
+static wbk_logger_t logger = { "win_positioner" };
+
+static int
+b3_win_positioner_free_impl(b3_win_positioner_t *positioner);
+
+static int
+b3_win_positioner_push_impl(b3_win_positioner_t *positioner, const b3_win_pos_t *pos_arr, int length);
+
+static int
+b3_win_positioner_process_impl(b3_win_positioner_t *positioner);
+
+static int
+b3_win_positioner_start_impl(b3_win_positioner_t *positioner);
+
+static int
+b3_win_positioner_stop_impl(b3_win_positioner_t *positioner);
+
+/**
+ * Main loop of the worker thread.
+ *
+ * @param param Actually from type b3_win_positioner_t *
+ */
+static DWORD WINAPI
+b3_win_positioner_run(LPVOID param);
+
+b3_win_positioner_t *
+b3_win_positioner_new(int sink(const b3_win_pos_t *pos_arr, int length, void *data),
+					  void *sink_data)
+{
+	b3_win_positioner_t *positioner;
+	HashTableConf conf;
+
+	positioner = NULL;
+	positioner = malloc(sizeof(b3_win_positioner_t));
+	if (positioner) {
+		positioner->b3_win_positioner_free = b3_win_positioner_free_impl;
+		positioner->b3_win_positioner_push = b3_win_positioner_push_impl;
+		positioner->b3_win_positioner_process = b3_win_positioner_process_impl;
+		positioner->b3_win_positioner_start = b3_win_positioner_start_impl;
+		positioner->b3_win_positioner_stop = b3_win_positioner_stop_impl;
+
+		positioner->batch = b3_win_batch_new(sink, sink_data);
+		positioner->settle_delay = B3_WIN_POSITIONER_SETTLE_DELAY;
+
+		positioner->mutex = CreateMutex(NULL, FALSE, NULL);
+		positioner->wake_event = CreateEvent(NULL, FALSE, FALSE, NULL);
+		positioner->thread = NULL;
+		positioner->running = 0;
+
+		array_new(&(positioner->pending_pos_arr));
+		array_new(&(positioner->processing_pos_arr));
+		array_new(&(positioner->free_pos_arr));
+
+		hashtable_conf_init(&conf);
+		conf.hash = POINTER_HASH;
+		conf.key_compare = cc_common_cmp_ptr;
+		conf.key_length = KEY_LENGTH_POINTER;
+		positioner->pending_pos_table = NULL;
+		hashtable_new_conf(&conf, &(positioner->pending_pos_table));
+
+		positioner->push_count = 0;
+		positioner->merge_count = 0;
+		positioner->apply_count = 0;
+	}
+
+	return positioner;
+}
+
+int
+b3_win_positioner_free(b3_win_positioner_t *positioner)
+{
+	return positioner->b3_win_positioner_free(positioner);
+}
+
+int
+b3_win_positioner_push(b3_win_positioner_t *positioner, const b3_win_pos_t *pos_arr, int length)
+{
+	return positioner->b3_win_positioner_push(positioner, pos_arr, length);
+}
+
+int
+b3_win_positioner_process(b3_win_positioner_t *positioner)
+{
+	return positioner->b3_win_positioner_process(positioner);
+}
+
+int
+b3_win_positioner_start(b3_win_positioner_t *positioner)
+{
+	return positioner->b3_win_positioner_start(positioner);
+}
+
+int
+b3_win_positioner_stop(b3_win_positioner_t *positioner)
+{
+	return positioner->b3_win_positioner_stop(positioner);
+}
+
+int
+b3_win_positioner_free_impl(b3_win_positioner_t *positioner)
+{
+	if (positioner->running) {
+		b3_win_positioner_stop(positioner);
+	}
+
+	array_destroy_cb(positioner->pending_pos_arr, free);
+	positioner->pending_pos_arr = NULL;
+
+	array_destroy_cb(positioner->processing_pos_arr, free);
+	positioner->processing_pos_arr = NULL;
+
+	array_destroy_cb(positioner->free_pos_arr, free);
+	positioner->free_pos_arr = NULL;
+
+	hashtable_destroy(positioner->pending_pos_table);
+	positioner->pending_pos_table = NULL;
+
+	b3_win_batch_free(positioner->batch);
+	positioner->batch = NULL;
+
+	CloseHandle(positioner->wake_event);
+	positioner->wake_event = NULL;
+
+	CloseHandle(positioner->mutex);
+	positioner->mutex = NULL;
+
+	free(positioner);
+	return 0;
+}
+
+int
+b3_win_positioner_push_impl(b3_win_positioner_t *positioner, const b3_win_pos_t *pos_arr, int length)
+{
+	int error;
+	b3_win_pos_t *pending;
+	int i;
+
+	error = 0;
+
+	WaitForSingleObject(positioner->mutex, INFINITE);
+
+	for (i = 0; i < length; i++) {
+		positioner->push_count++;
+
+		pending = NULL;
+		hashtable_get(positioner->pending_pos_table,
+					  pos_arr[i].window_handler,
+					  (void *) &pending);
+		if (pending) {
+			/**
+			 * Only the latest position of the window counts. It keeps the
+			 * place of the pending one.
+			 */
+			positioner->merge_count++;
+		} else {
+			if (array_size(positioner->free_pos_arr) > 0) {
+				array_remove_last(positioner->free_pos_arr, (void *) &pending);
+			} else {
+				pending = malloc(sizeof(b3_win_pos_t));
+			}
+
+			if (pending) {
+				array_add(positioner->pending_pos_arr, pending);
+				hashtable_add(positioner->pending_pos_table,
+							  pos_arr[i].window_handler,
+							  pending);
+			} else {
+				wbk_logger_log(&logger, SEVERE, "Unable to queue the position of a window\n");
+				error = 1;
+			}
+		}
+
+		if (pending) {
+			*pending = pos_arr[i];
+		}
+	}
+
+	ReleaseMutex(positioner->mutex);
+
+	if (!error) {
+		SetEvent(positioner->wake_event);
+	}
+
+	return error;
+}
+
+int
+b3_win_positioner_process_impl(b3_win_positioner_t *positioner)
+{
+	Array *processing_pos_arr;
+	b3_win_pos_t *pos;
+	int length;
+	int i;
+
+	WaitForSingleObject(positioner->mutex, INFINITE);
+	processing_pos_arr = positioner->pending_pos_arr;
+	positioner->pending_pos_arr = positioner->processing_pos_arr;
+	positioner->processing_pos_arr = processing_pos_arr;
+	hashtable_remove_all(positioner->pending_pos_table);
+	ReleaseMutex(positioner->mutex);
+
+	/**
+	 * The sink is called without holding the mutex, hence pushing is never
+	 * blocked by positioning windows.
+	 */
+	length = array_size(processing_pos_arr);
+	b3_win_batch_begin(positioner->batch);
+	for (i = 0; i < length; i++) {
+		array_get_at(processing_pos_arr, i, (void *) &pos);
+		b3_win_batch_add_pos(positioner->batch, pos);
+	}
+	b3_win_batch_commit(positioner->batch);
+
+	WaitForSingleObject(positioner->mutex, INFINITE);
+	for (i = 0; i < length; i++) {
+		array_get_at(processing_pos_arr, i, (void *) &pos);
+		array_add(positioner->free_pos_arr, pos);
+	}
+	array_remove_all(processing_pos_arr);
+	positioner->apply_count += length;
+	ReleaseMutex(positioner->mutex);
+
+	return length;
+}
+
+int
+b3_win_positioner_start_impl(b3_win_positioner_t *positioner)
+{
+	int error;
+
+	error = 1;
+	if (!positioner->running) {
+		positioner->running = 1;
+		positioner->thread = CreateThread(NULL,
+										  0,
+										  b3_win_positioner_run,
+										  (LPVOID) positioner,
+										  0,
+										  NULL);
+		if (positioner->thread) {
+			error = 0;
+		} else {
+			wbk_logger_log(&logger, SEVERE, "Unable to start the worker\n");
+			positioner->running = 0;
+		}
+	}
+
+	return error;
+}
+
+int
+b3_win_positioner_stop_impl(b3_win_positioner_t *positioner)
+{
+	int error;
+
+	error = 1;
+	if (positioner->running) {
+		positioner->running = 0;
+		SetEvent(positioner->wake_event);
+
+		WaitForSingleObject(positioner->thread, INFINITE);
+		CloseHandle(positioner->thread);
+		positioner->thread = NULL;
+
+		error = 0;
+	}
+
+	return error;
+}
+
+DWORD WINAPI
+b3_win_positioner_run(LPVOID param)
+{
+	b3_win_positioner_t *positioner;
+
+	positioner = (b3_win_positioner_t *) param;
+
+	while (positioner->running) {
+		WaitForSingleObject(positioner->wake_event, INFINITE);
+
+		if (positioner->running) {
+			/**
+			 * Give the windows time to settle and collect the burst of
+			 * positions of an arrangement.
+			 */
+			Sleep(positioner->settle_delay);
+
+			b3_win_positioner_process(positioner);
+		}
+	}
+
+	return 0;
+}
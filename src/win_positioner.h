@@ -0,0 +1,177 @@
+/******************************************************************************
+  This file is part of b3.
+
+  Copyright 2021 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * @author Richard Bäck <richard.baeck@mailbox.org>
+ * @date 2021-04-17
+ * @brief File contains the window positioner class definition
+ */
+
+#include <collectc/array.h>
+#include <collectc/hashtable.h>
+#include <windows.h>
+
+#include "win.h"
+
+#ifndef B3_WIN_POSITIONER_H
+#define B3_WIN_POSITIONER_H
+
+/**
+ * Default time in milliseconds the worker waits after being woken up before it
+ * applies the pending positions. Requests arriving in the meantime are
+ * coalesced.
+ */
+#define B3_WIN_POSITIONER_SETTLE_DELAY 100
+
+struct b3_win_positioner_s
+{
+	int (* b3_win_positioner_free)(b3_win_positioner_t *positioner);
+	int (* b3_win_positioner_push)(b3_win_positioner_t *positioner, const b3_win_pos_t *pos_arr, int length);
+	int (* b3_win_positioner_process)(b3_win_positioner_t *positioner);
+	int (* b3_win_positioner_start)(b3_win_positioner_t *positioner);
+	int (* b3_win_positioner_stop)(b3_win_positioner_t *positioner);
+
+	/**
+	 * Receives all positions applied by one b3_win_positioner_process() at
+	 * once. It is the backend of batch.
+	 */
+	b3_win_batch_t *batch;
+
+	DWORD settle_delay;
+
+	/**
+	 * Guards the pending positions and the counters.
+	 */
+	HANDLE mutex;
+
+	/**
+	 * Auto-reset event signaled if positions are pending or the worker should
+	 * stop.
+	 */
+	HANDLE wake_event;
+
+	HANDLE thread;
+	char running;
+
+	/**
+	 * Array of b3_win_pos_t *
+	 *
+	 * The pending positions in the order their windows were first requested.
+	 */
+	Array *pending_pos_arr;
+
+	/**
+	 * HashTable of HWND -> b3_win_pos_t *
+	 *
+	 * Index of pending_pos_arr by the window handler.
+	 */
+	HashTable *pending_pos_table;
+
+	/**
+	 * Array of b3_win_pos_t *
+	 *
+	 * The positions currently applied by b3_win_positioner_process(). It is
+	 * swapped with pending_pos_arr.
+	 */
+	Array *processing_pos_arr;
+
+	/**
+	 * Array of b3_win_pos_t *
+	 *
+	 * Entries which are currently not in use.
+	 */
+	Array *free_pos_arr;
+
+	/**
+	 * Number of positions pushed.
+	 */
+	int push_count;
+
+	/**
+	 * Number of pushed positions which replaced a pending one.
+	 */
+	int merge_count;
+
+	/**
+	 * Number of positions committed to the sink.
+	 */
+	int apply_count;
+};
+
+/**
+ * @brief Creates a new window positioner. The worker is not started yet.
+ * @param sink Applies the positions to their windows at once. Use
+ * b3_win_batch_apply() to actually position windows on the screen.
+ * @param sink_data Passed to every call of sink. Will not be freed.
+ * @return A new window positioner or NULL if allocation failed
+ */
+extern b3_win_positioner_t *
+b3_win_positioner_new(int sink(const b3_win_pos_t *pos_arr, int length, void *data),
+					  void *sink_data);
+
+/**
+ * @brief Deletes a window positioner. The worker is stopped if it is running.
+ * Pending positions are dropped.
+ * @return Non-0 if the deletion failed
+ */
+extern int
+b3_win_positioner_free(b3_win_positioner_t *positioner);
+
+/**
+ * Queues the positions of pos_arr at once. If a position of the same window is
+ * still pending, then it is replaced. Therefore only the latest position of a
+ * window is applied.
+ *
+ * @param pos_arr Is copied.
+ * @return 0 if the positions were queued. Non-0 otherwise.
+ */
+extern int
+b3_win_positioner_push(b3_win_positioner_t *positioner, const b3_win_pos_t *pos_arr, int length);
+
+/**
+ * Commits all pending positions to the sink at once. The worker calls it after every
+ * wake up. It can be called directly if the worker is not running.
+ *
+ * @return The number of applied positions.
+ */
+extern int
+b3_win_positioner_process(b3_win_positioner_t *positioner);
+
+/**
+ * Starts the worker thread.
+ *
+ * @return 0 if the worker was started. Non-0 otherwise.
+ */
+extern int
+b3_win_positioner_start(b3_win_positioner_t *positioner);
+
+/**
+ * Stops the worker thread and waits for it to finish.
+ *
+ * @return 0 if the worker was stopped. Non-0 otherwise.
+ */
+extern int
+b3_win_positioner_stop(b3_win_positioner_t *positioner);
+
+#endif // B3_WIN_POSITIONER_H
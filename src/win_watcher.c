@@ -31,24 +31,6 @@
 #include <windows.h>
 #include <collectc/hashtable.h>
 
-typedef struct b3_win_watcher_win_focused_comm_s
-{
-	b3_win_watcher_t *win_watcher;
-	HWND focused_window_handler;
-} b3_win_watcher_win_focused_comm_t;
-
-typedef struct b3_win_watcher_win_opened_comm_s
-{
-	b3_win_watcher_t *win_watcher;
-	HWND opened_window_handler;
-} b3_win_watcher_win_opened_comm_t;
-
-typedef struct b3_win_watcher_win_closed_comm_s
-{
-	b3_win_watcher_t *win_watcher;
-	HWND closed_window_handler;
-} b3_win_watcher_win_closed_comm_t;
-
 static wbk_logger_t logger =  { "win_watcher" };
 
 static int
@@ -60,34 +42,101 @@ b3_win_watcher_start_impl(b3_win_watcher_t *win_watcher);
 static int
 b3_win_watcher_stop_impl(b3_win_watcher_t *win_watcher);
 
-static LRESULT CALLBACK
-b3_win_watcher_wnd_proc(HWND window_handler, UINT msg, WPARAM wParam, LPARAM lParam);
+/**
+ * Handler of the event queue.
+ *
+ * @param data Actually from type b3_win_watcher_t *
+ */
+static int
+b3_win_watcher_handle_event(const b3_win_event_t *event, void *data);
+
+static int
+b3_win_watcher_win_focused(b3_win_watcher_t *win_watcher, HWND focused_window_handler);
 
-static DWORD WINAPI
-b3_win_watcher_win_focused_threaded(LPVOID param);
+static int
+b3_win_watcher_win_opened(b3_win_watcher_t *win_watcher, HWND opened_window_handler);
 
-static DWORD WINAPI
-b3_win_watcher_win_opened_threaded(LPVOID param);
+static int
+b3_win_watcher_win_closed(b3_win_watcher_t *win_watcher, HWND closed_window_handler);
 
-static DWORD WINAPI
-b3_win_watcher_win_closed_threaded(LPVOID param);
+/**
+ * Refreshes the cached attributes of the window, if it is known.
+ */
+static int
+b3_win_watcher_win_redrawn(b3_win_watcher_t *win_watcher, HWND redrawn_window_handler);
 
 static int
 b3_win_watcher_managable_window_handler_impl(b3_win_watcher_t *win_watcher, HWND window_handler);
 
-static BOOL CALLBACK
-b3_win_watcher_enum_windows(HWND window_handler, LPARAM param);
+/**
+ * Must be called with verdict_mutex held.
+ *
+ * @return The cached verdict of the window. If the window has no verdict yet,
+ * then it is made. NULL if the window does not exist.
+ */
+static b3_win_watcher_verdict_t *
+b3_win_watcher_get_verdict(b3_win_watcher_t *win_watcher, HWND window_handler);
+
+/**
+ * Removes the cached verdict of a window.
+ */
+static int
+b3_win_watcher_forget_verdict(b3_win_watcher_t *win_watcher, HWND window_handler);
 
+/**
+ * Must be called with verdict_mutex held.
+ */
 static int
-b3_win_watcher_set_threaded_impl(b3_win_watcher_t *win_watcher, int threaded);
+b3_win_watcher_clear_verdicts(b3_win_watcher_t *win_watcher);
 
+/**
+ * @return Non-0 if the window is one of the bars or the window of the window
+ * watcher.
+ */
 static int
-b3_win_watcher_is_threaded_impl(b3_win_watcher_t *win_watcher);
+b3_win_watcher_is_own_window(b3_win_watcher_t *win_watcher, HWND window_handler);
+
+static BOOL CALLBACK
+b3_win_watcher_enum_windows(HWND window_handler, LPARAM param);
+
+/**
+ * Windows of Windows itself that are never managed.
+ */
+static const char *g_excluded_classes[] = {
+	"Windows.UI.Core.CoreWindow",
+	"ForegroundStaging",
+	"ApplicationManager_DesktopShellWindow",
+	"Static",
+	"Scrollbar",
+	"Progman",
+	"TaskManagerWindow",
+	"ApplicationFrameWindow",
+	NULL
+};
+
+static const char *g_excluded_titles[] = {
+	"Windows Shell Experience Host",
+	"Microsoft Text Input Application",
+	"Action center",
+	"New Notification",
+	"Date and Time Information",
+	"Volume Control",
+	"Network Connections",
+	"Cortana",
+	"Start",
+	"Windows Default Lock Screen",
+	"Search",
+	"Microsoft Store",
+	"TaskManagerWindow",
+	NULL
+};
 
 b3_win_watcher_t *
 b3_win_watcher_new(b3_win_factory_t *win_factory, b3_director_t *director)
 {
 	b3_win_watcher_t *win_watcher;
+	HashTableConf conf;
+	int i;
 
 	win_watcher = NULL;
 	win_watcher = malloc(sizeof(b3_win_watcher_t));
@@ -98,11 +147,40 @@ b3_win_watcher_new(b3_win_factory_t *win_factory, b3_director_t *director)
 		win_watcher->b3_win_watcher_start = b3_win_watcher_start_impl;
 		win_watcher->b3_win_watcher_stop = b3_win_watcher_stop_impl;
 		win_watcher->b3_win_watcher_managable_window_handler = b3_win_watcher_managable_window_handler_impl;
-		win_watcher->b3_win_watcher_set_threaded = b3_win_watcher_set_threaded_impl;
-		win_watcher->b3_win_watcher_is_threaded = b3_win_watcher_is_threaded_impl;
 
 		win_watcher->win_factory = win_factory;
 		win_watcher->director = director;
+
+		win_watcher->event_queue = b3_win_event_queue_new(B3_WIN_EVENT_QUEUE_LENGTH,
+														  b3_win_watcher_handle_event,
+														  win_watcher);
+		if (win_watcher->event_queue == NULL) {
+			free(win_watcher);
+			win_watcher = NULL;
+		}
+	}
+
+	if (win_watcher) {
+		win_watcher->event_queue->grace_period = b3_director_get_new_win_grace_period(director);
+
+		hashtable_conf_init(&conf);
+		conf.hash = POINTER_HASH;
+		conf.key_compare = cc_common_cmp_ptr;
+		conf.key_length = KEY_LENGTH_POINTER;
+		win_watcher->verdict_table = NULL;
+		hashtable_new_conf(&conf, &(win_watcher->verdict_table));
+		win_watcher->verdict_mutex = CreateMutex(NULL, FALSE, NULL);
+
+		win_watcher->verdict_hit_count = 0;
+		win_watcher->verdict_miss_count = 0;
+
+		for (i = 0; g_excluded_classes[i]; i++) {
+			b3_director_exclude_class(director, g_excluded_classes[i]);
+		}
+
+		for (i = 0; g_excluded_titles[i]; i++) {
+			b3_director_exclude_title(director, g_excluded_titles[i]);
+		}
 	}
 
 	return win_watcher;
@@ -131,23 +209,19 @@ b3_win_watcher_managable_window_handler(b3_win_watcher_t *win_watcher, HWND wind
 	return win_watcher->b3_win_watcher_managable_window_handler(win_watcher, window_handler);
 }
 
-int
-b3_win_watcher_set_threaded(b3_win_watcher_t *win_watcher, int threaded)
-{
-	return win_watcher->b3_win_watcher_set_threaded(win_watcher, threaded);
-}
-
-int
-b3_win_watcher_is_threaded(b3_win_watcher_t *win_watcher)
-{
-	return win_watcher->b3_win_watcher_is_threaded(win_watcher);
-}
-
 int
 b3_win_watcher_free_impl(b3_win_watcher_t *win_watcher)
 {
 	b3_win_watcher_stop(win_watcher);
 
+	b3_win_event_queue_free(win_watcher->event_queue);
+	win_watcher->event_queue = NULL;
+
+	b3_win_watcher_clear_verdicts(win_watcher);
+	hashtable_destroy(win_watcher->verdict_table);
+	win_watcher->verdict_table = NULL;
+	CloseHandle(win_watcher->verdict_mutex);
+
 	win_watcher->win_factory = NULL;
 
 	win_watcher->director = NULL;
@@ -227,6 +301,10 @@ b3_win_watcher_start_impl(b3_win_watcher_t *win_watcher)
 		b3_director_w32_set_active_window(foreground_window, 1);
 	}
 
+	if (!error) {
+		b3_win_event_queue_start(win_watcher->event_queue);
+	}
+
 	return 0;
 }
 
@@ -236,8 +314,15 @@ b3_win_watcher_stop_impl(b3_win_watcher_t *win_watcher)
 	if (win_watcher->window_handler) {
 		DestroyWindow(win_watcher->window_handler);
 		win_watcher->window_handler = NULL;
+
+		wbk_logger_log(&logger, INFO,
+					   "Verdicts: %d cached, %d made\n",
+					   win_watcher->verdict_hit_count,
+					   win_watcher->verdict_miss_count);
 	}
 
+	b3_win_event_queue_stop(win_watcher->event_queue);
+
 	return 0;
 }
 
@@ -245,10 +330,7 @@ LRESULT CALLBACK
 b3_win_watcher_wnd_proc(HWND window_handler, UINT msg, WPARAM wParam, LPARAM lParam)
 {
 	b3_win_watcher_t *win_watcher;
-	b3_win_t *win;
-	b3_win_watcher_win_focused_comm_t focused_comm;
-	b3_win_watcher_win_opened_comm_t opened_comm;
-	b3_win_watcher_win_closed_comm_t closed_comm;
+	b3_win_event_t event;
 
     win_watcher = (b3_win_watcher_t *) GetWindowLongPtr(window_handler, GWLP_USERDATA);
 
@@ -260,51 +342,32 @@ b3_win_watcher_wnd_proc(HWND window_handler, UINT msg, WPARAM wParam, LPARAM lPa
 	default:
 		if (win_watcher
 		    && msg == win_watcher->shellhookid) {
+			event.window_handler = (HWND) lParam;
 			switch (wParam & 0x7fff) {
 				case HSHELL_WINDOWCREATED:
-					opened_comm.win_watcher = win_watcher;
-					opened_comm.opened_window_handler = (HWND) lParam;
-					if (b3_win_watcher_is_threaded(win_watcher)) {
-						CreateThread(NULL,
-									 0,
-									 b3_win_watcher_win_opened_threaded,
-									 (LPVOID) &opened_comm,
-									 0,
-									 NULL);
-					} else {
-						b3_win_watcher_win_opened_threaded((LPVOID) &opened_comm);
-					}
+					event.type = WIN_CREATED;
 					break;
 
 				case HSHELL_WINDOWDESTROYED:
-					closed_comm.win_watcher = win_watcher;
-					closed_comm.closed_window_handler = (HWND) lParam;
-					if (b3_win_watcher_is_threaded(win_watcher)) {
-						CreateThread(NULL,
-									 0,
-									 b3_win_watcher_win_closed_threaded,
-									 (LPVOID) &closed_comm,
-									 0,
-									 NULL);
-					} else {
-						b3_win_watcher_win_closed_threaded((LPVOID) &closed_comm);
-					}
+					event.type = WIN_DESTROYED;
 					break;
 
 				case HSHELL_WINDOWACTIVATED:
-					focused_comm.win_watcher = win_watcher;
-					focused_comm.focused_window_handler = (HWND) lParam;
-					if (b3_win_watcher_is_threaded(win_watcher)) {
-						CreateThread(NULL,
-									 0,
-									 b3_win_watcher_win_focused_threaded,
-									 (LPVOID) &focused_comm,
-									 0,
-									 NULL);
-					} else {
-						b3_win_watcher_win_focused_threaded((LPVOID) &focused_comm);
-					}
+					event.type = WIN_ACTIVATED;
+					break;
+
+				case HSHELL_REDRAW:
+					event.type = WIN_REDRAWN;
 					break;
+
+				default:
+					event.window_handler = NULL;
+			}
+
+			if (event.window_handler) {
+				b3_win_event_queue_push(win_watcher->event_queue,
+										event.type,
+										event.window_handler);
 			}
 		} else {
 			return DefWindowProc(window_handler, msg, wParam, lParam);
@@ -314,39 +377,64 @@ b3_win_watcher_wnd_proc(HWND window_handler, UINT msg, WPARAM wParam, LPARAM lPa
 	return 0;
 }
 
-DWORD WINAPI
-b3_win_watcher_win_focused_threaded(LPVOID param)
+int
+b3_win_watcher_handle_event(const b3_win_event_t *event, void *data)
+{
+	b3_win_watcher_t *win_watcher;
+	int error;
+
+	win_watcher = (b3_win_watcher_t *) data;
+
+	error = 1;
+	switch (event->type) {
+		case WIN_CREATED:
+			error = b3_win_watcher_win_opened(win_watcher, event->window_handler);
+			break;
+
+		case WIN_DESTROYED:
+			error = b3_win_watcher_win_closed(win_watcher, event->window_handler);
+			break;
+
+		case WIN_ACTIVATED:
+			error = b3_win_watcher_win_focused(win_watcher, event->window_handler);
+			break;
+
+		case WIN_REDRAWN:
+			error = b3_win_watcher_win_redrawn(win_watcher, event->window_handler);
+			break;
+	}
+
+	return error;
+}
+
+int
+b3_win_watcher_win_focused(b3_win_watcher_t *win_watcher, HWND focused_window_handler)
 {
-	b3_win_watcher_win_focused_comm_t *comm;
 	b3_win_t *win;
 
-	comm = (b3_win_watcher_win_focused_comm_t *) param;
-	if (b3_win_watcher_managable_window_handler(comm->win_watcher, comm->focused_window_handler)) {
-		win = b3_win_factory_win_create(comm->win_watcher->win_factory, comm->focused_window_handler);
-		if (b3_director_set_active_win(comm->win_watcher->director, win) == 0) {
+	if (b3_win_watcher_managable_window_handler(win_watcher, focused_window_handler)) {
+		win = b3_win_factory_win_create(win_watcher->win_factory, focused_window_handler);
+		if (b3_director_set_active_win(win_watcher->director, win) == 0) {
 		}
 	}
 
 	return 0;
 }
 
-DWORD WINAPI
-b3_win_watcher_win_opened_threaded(LPVOID param)
+int
+b3_win_watcher_win_opened(b3_win_watcher_t *win_watcher, HWND opened_window_handler)
 {
-	b3_win_watcher_win_opened_comm_t *comm;
 	HMONITOR monitor;
     MONITORINFOEX monitor_info;
 	b3_win_t *win;
 
-	comm = (b3_win_watcher_win_opened_comm_t *) param;
-
-	if (b3_win_watcher_managable_window_handler(comm->win_watcher, comm->opened_window_handler)) {
-		monitor = MonitorFromWindow(comm->opened_window_handler, MONITOR_DEFAULTTONEAREST);
+	if (b3_win_watcher_managable_window_handler(win_watcher, opened_window_handler)) {
+		monitor = MonitorFromWindow(opened_window_handler, MONITOR_DEFAULTTONEAREST);
 		monitor_info.cbSize = sizeof(MONITORINFOEX);
 		GetMonitorInfo(monitor, (LPMONITORINFO) &monitor_info);
 
-		win = b3_win_factory_win_create(comm->win_watcher->win_factory, comm->opened_window_handler);
-		if (b3_director_add_win(comm->win_watcher->director, monitor_info.szDevice, win)) {
+		win = b3_win_factory_win_create(win_watcher->win_factory, opened_window_handler);
+		if (b3_director_add_win(win_watcher->director, monitor_info.szDevice, win)) {
 		}
 
 		DeleteObject(monitor);
@@ -355,18 +443,37 @@ b3_win_watcher_win_opened_threaded(LPVOID param)
 	return 0;
 }
 
-DWORD WINAPI
-b3_win_watcher_win_closed_threaded(LPVOID param)
+int
+b3_win_watcher_win_closed(b3_win_watcher_t *win_watcher, HWND closed_window_handler)
 {
-	b3_win_watcher_win_closed_comm_t *comm;
 	b3_win_t *win;
 
-	comm = (b3_win_watcher_win_closed_comm_t *) param;
+	b3_win_watcher_forget_verdict(win_watcher, closed_window_handler);
+
+	/**
+	 * A window that was never created by the factory cannot be managed by the
+	 * director.
+	 */
+	win = b3_win_factory_win_get(win_watcher->win_factory, closed_window_handler);
+	if (win) {
+		if (b3_director_remove_win(win_watcher->director, win) == 0) {
+			b3_director_remove_empty_ws(win_watcher->director);
+		}
 
-	win = b3_win_factory_win_create(comm->win_watcher->win_factory, comm->closed_window_handler);
-	if (b3_director_remove_win(comm->win_watcher->director, win) == 0) {
-		b3_win_factory_win_free(comm->win_watcher->win_factory, win);
-		b3_director_remove_empty_ws(comm->win_watcher->director);
+		b3_win_factory_win_free(win_watcher->win_factory, win);
+	}
+
+	return 0;
+}
+
+int
+b3_win_watcher_win_redrawn(b3_win_watcher_t *win_watcher, HWND redrawn_window_handler)
+{
+	b3_win_t *win;
+
+	win = b3_win_factory_win_get(win_watcher->win_factory, redrawn_window_handler);
+	if (win) {
+		b3_win_refresh_attr(win);
 	}
 
 	return 0;
@@ -401,104 +508,133 @@ b3_win_watcher_enum_windows(HWND window_handler, LPARAM param)
 int
 b3_win_watcher_managable_window_handler_impl(b3_win_watcher_t *win_watcher, HWND window_handler)
 {
-	int exstyle;
-	HWND window_owner;
+	b3_win_watcher_verdict_t *verdict;
 	HWND parent;
-	RECT rect;
-	ArrayIter iter;
-	b3_monitor_t *monitor_iter;
-	int parent_managable;
-	int ret;
-	char classname[B3_WIN_WATCHER_BUFFER_LENGTH];
-	char title[B3_WIN_WATCHER_BUFFER_LENGTH];
-	char iter_title[B3_WIN_WATCHER_BUFFER_LENGTH];
+	int managable;
+	b3_win_t *win;
+	const char *title;
+	char title_buffer[B3_WIN_WATCHER_BUFFER_LENGTH];
 
-	parent_managable = 0;
+	managable = 0;
+	parent = NULL;
 	if (window_handler != 0) {
-		parent = GetParent(window_handler);
-		parent_managable = b3_win_watcher_managable_window_handler(win_watcher, parent);
+		WaitForSingleObject(win_watcher->verdict_mutex, INFINITE);
+		verdict = b3_win_watcher_get_verdict(win_watcher, window_handler);
+		if (verdict) {
+			managable = verdict->managable;
+			parent = verdict->parent;
+		}
+		ReleaseMutex(win_watcher->verdict_mutex);
+
+		if (managable) {
+			win = b3_win_factory_win_get(win_watcher->win_factory, window_handler);
+			if (win) {
+				title = b3_win_get_title(win);
+			} else {
+				GetWindowText(window_handler, title_buffer, B3_WIN_WATCHER_BUFFER_LENGTH);
+				title = title_buffer;
+			}
 
-		GetWindowText(window_handler, title, B3_WIN_WATCHER_BUFFER_LENGTH);
-		GetClassName(window_handler, classname, B3_WIN_WATCHER_BUFFER_LENGTH);
+			managable = IsWindowVisible(window_handler)
+				&& !b3_director_is_title_excluded(win_watcher->director, title)
+				&& (!parent || b3_win_watcher_managable_window_handler(win_watcher, parent));
 
-		ret = 1;
-		array_iter_init(&iter, b3_director_get_monitor_arr(win_watcher->director));
-		while (ret && array_iter_next(&iter, (void*) &monitor_iter) != CC_ITER_END) {
-			GetWindowText(b3_monitor_get_bar(monitor_iter)->window_handler, iter_title, B3_WIN_WATCHER_BUFFER_LENGTH);
-			if (strcmp(title, iter_title) == 0) {
-				ret = 0;
-			}
+			wbk_logger_log(&logger, DEBUG, "%s - title: %s\n",
+						   managable ? "Managable" : "Not managable", title);
 		}
+	}
 
-		GetWindowText(win_watcher->window_handler, iter_title, B3_WIN_WATCHER_BUFFER_LENGTH);
-
-	    if (ret
-			/**
-			 * Not the win_watcher himself!
-			 */
-	    	&& strcmp(title, iter_title)
-
-	    	/**
-	    	 * All Windows related
-	    	 */
-	    	&& strcmp(classname, "Windows.UI.Core.CoreWindow")
-	        && strcmp(title, "Windows Shell Experience Host")
-	        && strcmp(title, "Microsoft Text Input Application")
-	        && strcmp(title, "Action center")
-	        && strcmp(title, "New Notification")
-	        && strcmp(title, "Date and Time Information")
-	        && strcmp(title, "Volume Control")
-	        && strcmp(title, "Network Connections")
-	        && strcmp(title, "Cortana")
-	        && strcmp(title, "Start")
-	        && strcmp(title, "Windows Default Lock Screen")
-	        && strcmp(title, "Search")
-	        && strcmp(title, "Microsoft Store")
-	        && strcmp(title, "TaskManagerWindow")
-			&& strcmp(classname, "ForegroundStaging")
-	        && strcmp(classname, "ApplicationManager_DesktopShellWindow")
-	        && strcmp(classname, "Static")
-	        && strcmp(classname, "Scrollbar")
-	        && strcmp(classname, "Progman")
-	        && strcmp(classname, "TaskManagerWindow")
-	        && strcmp(classname, "ApplicationFrameWindow")
-
-			/**
-			 * General window stuff
-			 */
-		    && IsWindow(window_handler)
-			&& IsWindowVisible(window_handler)
-			&& (!parent || parent_managable)
-			) {
+	return managable;
+}
+
+b3_win_watcher_verdict_t *
+b3_win_watcher_get_verdict(b3_win_watcher_t *win_watcher, HWND window_handler)
+{
+	b3_win_watcher_verdict_t *verdict;
+	int exstyle;
+	HWND window_owner;
+	char classname[B3_WIN_WATCHER_BUFFER_LENGTH];
+
+	verdict = NULL;
+	if (hashtable_get(win_watcher->verdict_table, window_handler, (void *) &verdict) == CC_OK) {
+		win_watcher->verdict_hit_count++;
+	} else if (IsWindow(window_handler)
+			   && (verdict = malloc(sizeof(b3_win_watcher_verdict_t)))) {
+		GetClassName(window_handler, classname, B3_WIN_WATCHER_BUFFER_LENGTH);
+
+		verdict->managable = !b3_director_is_class_excluded(win_watcher->director, classname)
+			&& !b3_win_watcher_is_own_window(win_watcher, window_handler);
+
+		if (verdict->managable) {
 			exstyle = GetWindowLong(window_handler, GWL_EXSTYLE);
 			window_owner = GetWindow(window_handler, GW_OWNER);
 
-			GetWindowRect(window_handler, &rect);
+			verdict->managable = ((((exstyle & WS_EX_TOOLWINDOW) == 0) && window_owner == 0)
+								  || ((exstyle & WS_EX_APPWINDOW) && window_owner != 0))
+				&& (((exstyle & WS_EX_NOACTIVATE) == 0) && window_owner == 0);
+		}
 
+		verdict->parent = GetParent(window_handler);
 
-			if (((((exstyle & WS_EX_TOOLWINDOW) == 0) && window_owner == 0)
-				  || ((exstyle & WS_EX_APPWINDOW) && window_owner != 0))
-				&& (((exstyle & WS_EX_NOACTIVATE) == 0) && window_owner == 0)) {
-				wbk_logger_log(&logger, DEBUG, "Managable - title: %s, classname: %s\n", title, classname);
-				return 1;
-			}
+		if (hashtable_size(win_watcher->verdict_table) >= B3_WIN_WATCHER_VERDICT_TABLE_SIZE) {
+			b3_win_watcher_clear_verdicts(win_watcher);
 		}
 
-		wbk_logger_log(&logger, DEBUG, "Not managable - title: %s, classname: %s\n", title, classname);
+		hashtable_add(win_watcher->verdict_table, window_handler, verdict);
+		win_watcher->verdict_miss_count++;
+
+		wbk_logger_log(&logger, DEBUG, "Verdict - classname: %s, managable: %d\n",
+					   classname, verdict->managable);
 	}
 
+	return verdict;
+}
+
+int
+b3_win_watcher_forget_verdict(b3_win_watcher_t *win_watcher, HWND window_handler)
+{
+	b3_win_watcher_verdict_t *verdict;
+
+	WaitForSingleObject(win_watcher->verdict_mutex, INFINITE);
+
+	verdict = NULL;
+	hashtable_remove(win_watcher->verdict_table, window_handler, (void *) &verdict);
+	free(verdict);
+
+	ReleaseMutex(win_watcher->verdict_mutex);
+
 	return 0;
 }
 
 int
-b3_win_watcher_set_threaded_impl(b3_win_watcher_t *win_watcher, int threaded)
+b3_win_watcher_clear_verdicts(b3_win_watcher_t *win_watcher)
 {
-	win_watcher->threaded = threaded;
+	HashTableIter iter;
+	TableEntry *entry;
+
+	hashtable_iter_init(&iter, win_watcher->verdict_table);
+	while (hashtable_iter_next(&iter, &entry) != CC_ITER_END) {
+		free(entry->value);
+	}
+
+	hashtable_remove_all(win_watcher->verdict_table);
+
 	return 0;
 }
 
 int
-b3_win_watcher_is_threaded_impl(b3_win_watcher_t *win_watcher)
+b3_win_watcher_is_own_window(b3_win_watcher_t *win_watcher, HWND window_handler)
 {
-	return win_watcher->threaded;
+	ArrayIter iter;
+	b3_monitor_t *monitor_iter;
+	int own;
+
+	own = window_handler == win_watcher->window_handler;
+
+	array_iter_init(&iter, b3_director_get_monitor_arr(win_watcher->director));
+	while (!own && array_iter_next(&iter, (void*) &monitor_iter) != CC_ITER_END) {
+		own = window_handler == b3_monitor_get_bar(monitor_iter)->window_handler;
+	}
+
+	return own;
 }
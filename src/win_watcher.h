@@ -31,13 +31,37 @@
 #ifndef B3_WIN_WATCHER_H
 #define B3_WIN_WATCHER_H
 
+#include <collectc/hashtable.h>
 #include <windows.h>
 
 #include "win_factory.h"
+#include "win_event_queue.h"
 #include "director.h"
 
 #define B3_WIN_WATCHER_BUFFER_LENGTH 1024
 
+/**
+ * Maximum number of cached verdicts. Windows that are destroyed without a
+ * shell message (e.g. child windows) are never removed from the cache, so it
+ * is flushed if it grows beyond this size.
+ */
+#define B3_WIN_WATCHER_VERDICT_TABLE_SIZE 4096
+
+/**
+ * The part of the managability of a window that does not change during its
+ * lifetime.
+ */
+typedef struct b3_win_watcher_verdict_s
+{
+	/**
+	 * Non-0 if neither the class nor the styles of the window prevent
+	 * managing it.
+	 */
+	char managable;
+
+	HWND parent;
+} b3_win_watcher_verdict_t;
+
 typedef struct b3_win_watcher_s b3_win_watcher_t;
 
 struct b3_win_watcher_s
@@ -46,8 +70,6 @@ struct b3_win_watcher_s
 	int (* b3_win_watcher_start)(b3_win_watcher_t *win_watcher);
 	int (* b3_win_watcher_stop)(b3_win_watcher_t *win_watcher);
 	int (* b3_win_watcher_managable_window_handler)(b3_win_watcher_t *win_watcher, HWND window_handler);
-	int (* b3_win_watcher_set_threaded)(b3_win_watcher_t *win_watcher, int threaded);
-	int (* b3_win_watcher_is_threaded)(b3_win_watcher_t *win_watcher);
 
 	b3_win_factory_t *win_factory;
 
@@ -57,7 +79,23 @@ struct b3_win_watcher_s
 
 	UINT shellhookid;
 
-	int threaded;
+	/**
+	 * The shell hook messages are pushed to it. Its consumer applies them to
+	 * the director in the order they arrived.
+	 */
+	b3_win_event_queue_t *event_queue;
+
+	/**
+	 * HashTable of HWND -> b3_win_watcher_verdict_t *
+	 *
+	 * Cache of b3_win_watcher_managable_window_handler(). A verdict is removed
+	 * if its window is destroyed.
+	 */
+	HashTable *verdict_table;
+	HANDLE verdict_mutex;
+
+	int verdict_hit_count;
+	int verdict_miss_count;
 };
 
 /**
@@ -82,13 +120,21 @@ b3_win_watcher_start(b3_win_watcher_t *win_watcher);
 extern int
 b3_win_watcher_stop(b3_win_watcher_t *win_watcher);
 
-extern int
-b3_win_watcher_set_threaded(b3_win_watcher_t *win_watcher, int threaded);
-
-extern int
-b3_win_watcher_is_threaded(b3_win_watcher_t *win_watcher);
+/**
+ * Window procedure of the window registered as shell hook window by
+ * b3_win_watcher_start(). Its user data must be the watcher. The shell hook
+ * messages are pushed to the event queue of the watcher.
+ */
+extern LRESULT CALLBACK
+b3_win_watcher_wnd_proc(HWND window_handler, UINT msg, WPARAM wParam, LPARAM lParam);
 
 /**
+ * The class name and the styles of a window are only checked the first time
+ * the window is passed. The title and the visibility are checked on every
+ * call. The title of a window already created by the window factory is taken
+ * from its cached attributes. Windows excluded by the director are never
+ * managable.
+ *
  * @return 0 if the window is not managable. Non-0 if it is managable.
  */
 extern int
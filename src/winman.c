@@ -34,8 +34,43 @@
 #include <string.h>
 #include <w32bindkeys/logger.h>
 
+#include "winman_factory.h"
+
+/**
+ * Number of tree levels b3_winman_traverse_until() can handle without
+ * allocating memory.
+ */
+#define B3_WINMAN_TRAVERSE_STACK_SIZE 32
+
 static wbk_logger_t logger = { "winman" };
 
+typedef struct b3_winman_traverse_frame_s
+{
+	b3_winman_t *winman;
+
+	/**
+	 * Position of the next child of winman to visit.
+	 */
+	int child_pos;
+} b3_winman_traverse_frame_t;
+
+typedef struct b3_winman_traverse_adapter_s
+{
+	void (*visitor)(b3_winman_t *winman, void *data);
+
+	void *data;
+} b3_winman_traverse_adapter_t;
+
+typedef struct b3_winman_search_s
+{
+	/**
+	 * The search criteria. Its type depends on the visitor.
+	 */
+	const void *criteria;
+
+	b3_winman_t *found;
+} b3_winman_search_t;
+
 static int
 b3_winman_free_impl(b3_winman_t *winman);
 
@@ -44,9 +79,38 @@ b3_winman_traverse_impl(b3_winman_t *winman,
 						 void visitor(b3_winman_t *winman, void *data),
 						 void *data);
 
+static int
+b3_winman_traverse_until_impl(b3_winman_t *winman,
+							  b3_winman_traverse_order_t order,
+							  int visitor(b3_winman_t *winman, void *data),
+							  void *data);
+
+/**
+ * Calls the void visitor of b3_winman_traverse() and never stops.
+ *
+ * @param data Must be actually of type b3_winman_traverse_adapter_t *.
+ */
+static int
+b3_winman_traverse_adapter_visitor(b3_winman_t *winman, void *data);
+
 static int
 b3_winman_add_winman_impl(b3_winman_t *root, b3_winman_t *winman);
 
+static int
+b3_winman_add_winman_at_impl(b3_winman_t *root, b3_winman_t *winman, int index);
+
+/**
+ * Removes winman from the first level of its current parent (if it has any).
+ */
+static void
+b3_winman_detach(b3_winman_t *winman);
+
+/**
+ * Adds delta to the window count of winman and all of its ancestors.
+ */
+static void
+b3_winman_update_win_count(b3_winman_t *winman, int delta);
+
 static int
 b3_winman_remove_winman_impl(b3_winman_t *root, b3_winman_t *winman);
 
@@ -68,6 +132,13 @@ b3_winman_get_parent_impl(b3_winman_t *root, b3_winman_t *winman);
 static b3_winman_t *
 b3_winman_contains_win_impl(b3_winman_t *winman, const b3_win_t *win);
 
+/**
+ * @param data Must be actually of type b3_winman_search_t * with a criteria of
+ * type const b3_win_t *.
+ */
+static int
+b3_winman_contains_win_visitor(b3_winman_t *winman, void *data);
+
 static b3_winman_t *
 b3_winman_get_winman_rel_to_winman_impl(b3_winman_t *root,
 										b3_winman_t *winman,
@@ -77,15 +148,35 @@ b3_winman_get_winman_rel_to_winman_impl(b3_winman_t *root,
 static int
 b3_winman_is_empty_impl(b3_winman_t *root, char check_deeply);
 
+static int
+b3_winman_get_win_count_impl(b3_winman_t *winman);
+
 static int
 b3_winman_reorg_impl(b3_winman_t *winman);
 
+static int
+b3_winman_reorg_path_impl(b3_winman_t *root, b3_winman_t *winman);
+
 static b3_win_t *
 b3_winman_get_maximized_impl(b3_winman_t *winman);
 
+/**
+ * @param data Must be actually of type b3_winman_search_t *. The criteria is
+ * not used.
+ */
+static int
+b3_winman_get_maximized_visitor(b3_winman_t *winman, void *data);
+
 static b3_win_t *
 b3_winman_get_win_at_pos_impl(b3_winman_t *winman, POINT *position);
 
+/**
+ * @param data Must be actually of type b3_winman_search_t * with a criteria of
+ * type POINT *.
+ */
+static int
+b3_winman_get_win_at_pos_visitor(b3_winman_t *winman, void *data);
+
 b3_winman_t *
 b3_winman_new(b3_winman_mode_t mode)
 {
@@ -95,30 +186,45 @@ b3_winman_new(b3_winman_mode_t mode)
 	winman = malloc(sizeof(b3_winman_t));
 
 	if (winman) {
-		winman->b3_winman_free = b3_winman_free_impl;
-		winman->b3_winman_traverse = b3_winman_traverse_impl;
-		winman->b3_winman_add_winman = b3_winman_add_winman_impl;
-		winman->b3_winman_remove_winman = b3_winman_remove_winman_impl;
-		winman->b3_winman_get_winman_arr = b3_winman_get_winman_arr_impl;
-		winman->b3_winman_set_win = b3_winman_set_win_impl;
-		winman->b3_winman_get_win = b3_winman_get_win_impl;
-		winman->b3_winman_get_mode = b3_winman_get_mode_impl;
-		winman->b3_winman_get_parent = b3_winman_get_parent_impl;
-		winman->b3_winman_contains_win = b3_winman_contains_win_impl;
-		winman->b3_winman_get_winman_rel_to_winman = b3_winman_get_winman_rel_to_winman_impl;
-		winman->b3_winman_is_empty = b3_winman_is_empty_impl;
-		winman->b3_winman_reorg = b3_winman_reorg_impl;
-		winman->b3_winman_get_maximized = b3_winman_get_maximized_impl;
-		winman->b3_winman_get_win_at_pos = b3_winman_get_win_at_pos_impl;
-
 		array_new(&(winman->winman_arr));
-		winman->win = NULL;
-		winman->mode = mode;
+		b3_winman_init(winman, mode);
 	}
 
 	return winman;
 }
 
+int
+b3_winman_init(b3_winman_t *winman, b3_winman_mode_t mode)
+{
+	winman->b3_winman_free = b3_winman_free_impl;
+	winman->b3_winman_traverse = b3_winman_traverse_impl;
+	winman->b3_winman_traverse_until = b3_winman_traverse_until_impl;
+	winman->b3_winman_add_winman = b3_winman_add_winman_impl;
+	winman->b3_winman_add_winman_at = b3_winman_add_winman_at_impl;
+	winman->b3_winman_remove_winman = b3_winman_remove_winman_impl;
+	winman->b3_winman_get_winman_arr = b3_winman_get_winman_arr_impl;
+	winman->b3_winman_set_win = b3_winman_set_win_impl;
+	winman->b3_winman_get_win = b3_winman_get_win_impl;
+	winman->b3_winman_get_mode = b3_winman_get_mode_impl;
+	winman->b3_winman_get_parent = b3_winman_get_parent_impl;
+	winman->b3_winman_contains_win = b3_winman_contains_win_impl;
+	winman->b3_winman_get_winman_rel_to_winman = b3_winman_get_winman_rel_to_winman_impl;
+	winman->b3_winman_is_empty = b3_winman_is_empty_impl;
+	winman->b3_winman_get_win_count = b3_winman_get_win_count_impl;
+	winman->b3_winman_reorg = b3_winman_reorg_impl;
+	winman->b3_winman_reorg_path = b3_winman_reorg_path_impl;
+	winman->b3_winman_get_maximized = b3_winman_get_maximized_impl;
+	winman->b3_winman_get_win_at_pos = b3_winman_get_win_at_pos_impl;
+
+	winman->win = NULL;
+	winman->mode = mode;
+	winman->parent = NULL;
+	winman->factory = NULL;
+	winman->win_count = 0;
+
+	return 0;
+}
+
 int
 b3_winman_free(b3_winman_t *winman)
 {
@@ -133,12 +239,27 @@ b3_winman_traverse(b3_winman_t *winman,
 	return winman->b3_winman_traverse(winman, visitor, data);
 }
 
+int
+b3_winman_traverse_until(b3_winman_t *winman,
+						 b3_winman_traverse_order_t order,
+						 int visitor(b3_winman_t *winman, void *data),
+						 void *data)
+{
+	return winman->b3_winman_traverse_until(winman, order, visitor, data);
+}
+
 int
 b3_winman_add_winman(b3_winman_t *root, b3_winman_t *winman)
 {
 	return winman->b3_winman_add_winman(root, winman);
 }
 
+int
+b3_winman_add_winman_at(b3_winman_t *root, b3_winman_t *winman, int index)
+{
+	return winman->b3_winman_add_winman_at(root, winman, index);
+}
+
 int
 b3_winman_remove_winman(b3_winman_t *root, b3_winman_t *winman)
 {
@@ -196,12 +317,24 @@ b3_winman_is_empty(b3_winman_t *root, char check_deeply)
 	return root->b3_winman_is_empty(root, check_deeply);
 }
 
+int
+b3_winman_get_win_count(b3_winman_t *winman)
+{
+	return winman->b3_winman_get_win_count(winman);
+}
+
 int
 b3_winman_reorg(b3_winman_t *winman)
 {
 	return winman->b3_winman_reorg(winman);
 }
 
+int
+b3_winman_reorg_path(b3_winman_t *root, b3_winman_t *winman)
+{
+	return winman->b3_winman_reorg_path(root, winman);
+}
+
 b3_win_t *
 b3_winman_get_maximized(b3_winman_t *winman)
 {
@@ -229,12 +362,16 @@ b3_winman_free_impl(b3_winman_t *winman)
     	array_iter_remove(&iter, NULL);
     	b3_winman_free(winman_iter);
     }
-	array_destroy(winman->winman_arr);
-	winman->winman_arr = NULL;
-
 	winman->win = NULL;
 
-	free(winman);
+	if (winman->factory) {
+		b3_winman_factory_winman_free(winman->factory, winman);
+	} else {
+		array_destroy(winman->winman_arr);
+		winman->winman_arr = NULL;
+
+		free(winman);
+	}
 
 	return 0;
 }
@@ -244,15 +381,105 @@ b3_winman_traverse_impl(b3_winman_t *winman,
 						 void visitor(b3_winman_t *winman, void *data),
 						 void *data)
 {
-	ArrayIter iter;
-	b3_winman_t *winman_iter;
+	b3_winman_traverse_adapter_t adapter;
 
-	visitor(winman, data);
+	adapter.visitor = visitor;
+	adapter.data = data;
 
-	array_iter_init(&iter, b3_winman_get_winman_arr(winman));
-	while (array_iter_next(&iter, (void*) &winman_iter) != CC_ITER_END) {
-		b3_winman_traverse(winman_iter, visitor, data);
+	b3_winman_traverse_until(winman, PRE_ORDER,
+							 b3_winman_traverse_adapter_visitor,
+							 &adapter);
+}
+
+int
+b3_winman_traverse_adapter_visitor(b3_winman_t *winman, void *data)
+{
+	b3_winman_traverse_adapter_t *adapter;
+
+	adapter = (b3_winman_traverse_adapter_t *) data;
+	adapter->visitor(winman, adapter->data);
+
+	return 0;
+}
+
+int
+b3_winman_traverse_until_impl(b3_winman_t *winman,
+							  b3_winman_traverse_order_t order,
+							  int visitor(b3_winman_t *winman, void *data),
+							  void *data)
+{
+	b3_winman_traverse_frame_t local_stack[B3_WINMAN_TRAVERSE_STACK_SIZE];
+	b3_winman_traverse_frame_t *stack;
+	b3_winman_traverse_frame_t *bigger_stack;
+	b3_winman_traverse_frame_t *top;
+	int stack_len;
+	int stack_size;
+	b3_winman_t *child;
+	int stop;
+
+	stack = local_stack;
+	stack_size = B3_WINMAN_TRAVERSE_STACK_SIZE;
+	stack_len = 0;
+	stop = 0;
+
+	if (order == PRE_ORDER) {
+		stop = visitor(winman, data);
 	}
+
+	if (!stop) {
+		stack[0].winman = winman;
+		stack[0].child_pos = 0;
+		stack_len = 1;
+	}
+
+	while (!stop && stack_len > 0) {
+		top = &(stack[stack_len - 1]);
+
+		if (top->child_pos < array_size(b3_winman_get_winman_arr(top->winman))) {
+			array_get_at(b3_winman_get_winman_arr(top->winman), top->child_pos, (void *) &child);
+			top->child_pos++;
+
+			if (order == PRE_ORDER) {
+				stop = visitor(child, data);
+			}
+
+			if (!stop && stack_len >= stack_size) {
+				/**
+				 * The tree is deeper than the stack. Double its size.
+				 */
+				bigger_stack = malloc(sizeof(b3_winman_traverse_frame_t) * stack_size * 2);
+				if (bigger_stack) {
+					memcpy(bigger_stack, stack, sizeof(b3_winman_traverse_frame_t) * stack_size);
+					if (stack != local_stack) {
+						free(stack);
+					}
+					stack = bigger_stack;
+					stack_size *= 2;
+				} else {
+					wbk_logger_log(&logger, SEVERE, "Unable to grow the traversal stack.\n");
+					stop = -1;
+				}
+			}
+
+			if (!stop) {
+				stack[stack_len].winman = child;
+				stack[stack_len].child_pos = 0;
+				stack_len++;
+			}
+		} else {
+			stack_len--;
+
+			if (order == POST_ORDER) {
+				stop = visitor(top->winman, data);
+			}
+		}
+	}
+
+	if (stack != local_stack) {
+		free(stack);
+	}
+
+	return stop;
 }
 
 int
@@ -260,11 +487,67 @@ b3_winman_add_winman_impl(b3_winman_t *root, b3_winman_t *winman)
 {
 	int error;
 
+	b3_winman_detach(winman);
+
 	error = array_add(root->winman_arr, winman);
+	if (!error) {
+		winman->parent = root;
+		b3_winman_update_win_count(root, winman->win_count);
+	}
 
 	return error;
 }
 
+int
+b3_winman_add_winman_at_impl(b3_winman_t *root, b3_winman_t *winman, int index)
+{
+	int error;
+
+	b3_winman_detach(winman);
+
+	error = array_add_at(root->winman_arr, winman, index);
+	if (!error) {
+		winman->parent = root;
+		b3_winman_update_win_count(root, winman->win_count);
+	}
+
+	return error;
+}
+
+void
+b3_winman_detach(b3_winman_t *winman)
+{
+	ArrayIter iter;
+	b3_winman_t *winman_iter;
+	char found;
+
+	if (winman->parent) {
+		found = 0;
+		array_iter_init(&iter, b3_winman_get_winman_arr(winman->parent));
+		while (!found && array_iter_next(&iter, (void*) &winman_iter) != CC_ITER_END) {
+			if (winman_iter == winman) {
+				array_iter_remove(&iter, NULL);
+				found = 1;
+			}
+		}
+
+		if (found) {
+			b3_winman_update_win_count(winman->parent, -winman->win_count);
+		}
+
+		winman->parent = NULL;
+	}
+}
+
+void
+b3_winman_update_win_count(b3_winman_t *winman, int delta)
+{
+	while (delta && winman) {
+		winman->win_count += delta;
+		winman = winman->parent;
+	}
+}
+
 int
 b3_winman_remove_winman_impl(b3_winman_t *root, b3_winman_t *winman)
 {
@@ -280,6 +563,8 @@ b3_winman_remove_winman_impl(b3_winman_t *root, b3_winman_t *winman)
 		while (error && array_iter_next(&iter, (void*) &winman_iter) != CC_ITER_END) {
 			if (winman_iter == winman) {
 				array_iter_remove(&iter, NULL);
+				b3_winman_update_win_count(container, -winman->win_count);
+				winman->parent = NULL;
 				error = 0;
 			}
 		}
@@ -297,6 +582,8 @@ b3_winman_get_winman_arr_impl(b3_winman_t *winman)
 int
 b3_winman_set_win_impl(b3_winman_t *winman, b3_win_t *win)
 {
+	b3_winman_update_win_count(winman, (win != NULL) - (winman->win != NULL));
+
 	winman->win = win;
 	return 0;
 }
@@ -317,18 +604,20 @@ b3_winman_t *
 b3_winman_get_parent_impl(b3_winman_t *root, b3_winman_t *winman)
 {
 	b3_winman_t *container;
-	ArrayIter iter;
-	b3_winman_t *winman_iter;
+	b3_winman_t *ancestor;
 
-	container = NULL;
+	container = winman->parent;
 
-	array_iter_init(&iter, b3_winman_get_winman_arr(root));
-	while (container == NULL && array_iter_next(&iter, (void*) &winman_iter) != CC_ITER_END) {
-		if (winman_iter == winman) {
-			container = root;
-		} else {
-			container = b3_winman_get_parent(winman_iter, winman);
-		}
+	/**
+	 * Only return the parent if winman actually is located below root.
+	 */
+	ancestor = container;
+	while (ancestor && ancestor != root) {
+		ancestor = ancestor->parent;
+	}
+
+	if (ancestor == NULL) {
+		container = NULL;
 	}
 
 	return container;
@@ -337,27 +626,33 @@ b3_winman_get_parent_impl(b3_winman_t *root, b3_winman_t *winman)
 b3_winman_t *
 b3_winman_contains_win_impl(b3_winman_t *winman, const b3_win_t *win)
 {
-	b3_winman_t *container;
+	b3_winman_search_t search;
+
+	search.criteria = win;
+	search.found = NULL;
+
+	b3_winman_traverse_until(winman, PRE_ORDER,
+							 b3_winman_contains_win_visitor,
+							 &search);
+
+	return search.found;
+}
+
+int
+b3_winman_contains_win_visitor(b3_winman_t *winman, void *data)
+{
+	b3_winman_search_t *search;
 	b3_win_t *winman_win;
-	ArrayIter iter;
-	b3_winman_t *winman_iter;
 
-	container = NULL;
+	search = (b3_winman_search_t *) data;
 
 	winman_win = b3_winman_get_win(winman);
 	if (winman_win
-		&& b3_win_compare(winman_win, win) == 0) {
-		container = winman;
+		&& b3_win_compare(winman_win, (const b3_win_t *) search->criteria) == 0) {
+		search->found = winman;
 	}
 
-	if (container == NULL) {
-		array_iter_init(&iter, b3_winman_get_winman_arr(winman));
-		while (container == NULL && array_iter_next(&iter, (void*) &winman_iter) != CC_ITER_END) {
-			container = b3_winman_contains_win(winman_iter, win);
-		}
-	}
-
-	return container;
+	return search->found != NULL;
 }
 
 b3_winman_t *
@@ -420,14 +715,14 @@ b3_winman_is_empty_impl(b3_winman_t *root, char check_deeply)
 
 	is_empty = 0;
 
-	if (b3_winman_get_win(root) == NULL) {
+	if (check_deeply) {
+		is_empty = root->win_count <= 0;
+	} else if (b3_winman_get_win(root) == NULL) {
 		is_empty = 1;
 		array_iter_init(&iter, b3_winman_get_winman_arr(root));
 		while (is_empty && array_iter_next(&iter, (void*) &winman_iter) != CC_ITER_END) {
 			if (b3_winman_get_win(winman_iter)) {
 				is_empty = 0;
-			} else if (check_deeply) {
-				is_empty = b3_winman_is_empty(winman_iter, check_deeply);
 			}
 		}
 	}
@@ -435,6 +730,12 @@ b3_winman_is_empty_impl(b3_winman_t *root, char check_deeply)
 	return is_empty;
 }
 
+int
+b3_winman_get_win_count_impl(b3_winman_t *winman)
+{
+	return winman->win_count;
+}
+
 int
 b3_winman_reorg_impl(b3_winman_t *winman)
 {
@@ -448,6 +749,8 @@ b3_winman_reorg_impl(b3_winman_t *winman)
 	while (!error && array_iter_next(&iter, (void*) &winman_iter) != CC_ITER_END) {
 		if (b3_winman_is_empty(winman_iter, 1)) {
 			array_iter_remove(&iter, NULL);
+			winman_iter->parent = NULL;
+			b3_winman_free(winman_iter);
 		} else {
 			error = b3_winman_reorg(winman_iter);
 		}
@@ -456,46 +759,101 @@ b3_winman_reorg_impl(b3_winman_t *winman)
 	return error;
 }
 
+int
+b3_winman_reorg_path_impl(b3_winman_t *root, b3_winman_t *winman)
+{
+	int error;
+	b3_winman_t *parent;
+
+	error = 0;
+
+	while (!error && winman != root && b3_winman_is_empty(winman, 1)) {
+		parent = b3_winman_get_parent(root, winman);
+		if (parent) {
+			error = b3_winman_remove_winman(parent, winman);
+			if (!error) {
+				b3_winman_free(winman);
+				winman = parent;
+			}
+		} else {
+			wbk_logger_log(&logger, SEVERE, "'winman' cannot be found in 'root'\n");
+			error = 1;
+		}
+	}
+
+	return error;
+}
+
 b3_win_t *
 b3_winman_get_maximized_impl(b3_winman_t *winman)
 {
+	b3_winman_search_t search;
 	b3_win_t *maximized;
-	ArrayIter iter;
-	b3_winman_t *winman_iter;
 
-	maximized = b3_winman_get_win(winman);
-	if (maximized) {
-		if (b3_win_get_state(maximized) != MAXIMIZED) {
-			maximized = NULL;
-		}
-	} else {
-		array_iter_init(&iter, b3_winman_get_winman_arr(winman));
-		while (maximized == NULL && array_iter_next(&iter, (void*) &winman_iter) != CC_ITER_END) {
-			maximized = b3_winman_get_maximized(winman_iter);
-		}
+	search.criteria = NULL;
+	search.found = NULL;
+
+	b3_winman_traverse_until(winman, PRE_ORDER,
+							 b3_winman_get_maximized_visitor,
+							 &search);
+
+	maximized = NULL;
+	if (search.found) {
+		maximized = b3_winman_get_win(search.found);
 	}
 
 	return maximized;
 }
 
+int
+b3_winman_get_maximized_visitor(b3_winman_t *winman, void *data)
+{
+	b3_winman_search_t *search;
+	b3_win_t *win;
+
+	search = (b3_winman_search_t *) data;
+
+	win = b3_winman_get_win(winman);
+	if (win && b3_win_get_state(win) == MAXIMIZED) {
+		search->found = winman;
+	}
+
+	return search->found != NULL;
+}
+
 b3_win_t *
 b3_winman_get_win_at_pos_impl(b3_winman_t *winman, POINT *position)
 {
+	b3_winman_search_t search;
 	b3_win_t *win_at_pos;
-	ArrayIter iter;
-	b3_winman_t *winman_iter;
 
-	win_at_pos = b3_winman_get_win(winman);
-	if (win_at_pos) {
-		if (!b3_win_is_point_in_rect(win_at_pos, position)) {
-			win_at_pos = NULL;
-		}
-	} else {
-		array_iter_init(&iter, b3_winman_get_winman_arr(winman));
-		while (win_at_pos == NULL && array_iter_next(&iter, (void*) &winman_iter) != CC_ITER_END) {
-			win_at_pos = b3_winman_get_win_at_pos_impl(winman_iter, position);
-		}
+	search.criteria = position;
+	search.found = NULL;
+
+	b3_winman_traverse_until(winman, PRE_ORDER,
+							 b3_winman_get_win_at_pos_visitor,
+							 &search);
+
+	win_at_pos = NULL;
+	if (search.found) {
+		win_at_pos = b3_winman_get_win(search.found);
 	}
 
 	return win_at_pos;
 }
+
+int
+b3_winman_get_win_at_pos_visitor(b3_winman_t *winman, void *data)
+{
+	b3_winman_search_t *search;
+	b3_win_t *win;
+
+	search = (b3_winman_search_t *) data;
+
+	win = b3_winman_get_win(winman);
+	if (win && b3_win_is_point_in_rect(win, (POINT *) search->criteria)) {
+		search->found = winman;
+	}
+
+	return search->found != NULL;
+}
@@ -48,14 +48,27 @@ typedef enum b3_winman_get_rel_e
     NEXT
 } b3_winman_get_rel_t;
 
+typedef enum b3_winman_traverse_order_e
+{
+	PRE_ORDER = 0,
+	POST_ORDER
+} b3_winman_traverse_order_t;
+
 typedef struct b3_winman_s b3_winman_t;
 
+typedef struct b3_winman_factory_s b3_winman_factory_t;
+
 struct b3_winman_s {
 	int (*b3_winman_free)(b3_winman_t *winman);
 	void (*b3_winman_traverse)(b3_winman_t *winman,
 							   void visitor(b3_winman_t *winman, void *data),
 							   void *data);
+	int (*b3_winman_traverse_until)(b3_winman_t *winman,
+									b3_winman_traverse_order_t order,
+									int visitor(b3_winman_t *winman, void *data),
+									void *data);
 	int (*b3_winman_add_winman)(b3_winman_t *root, b3_winman_t *winman);
+	int (*b3_winman_add_winman_at)(b3_winman_t *root, b3_winman_t *winman, int index);
 	int (*b3_winman_remove_winman)(b3_winman_t *root, b3_winman_t *winman);
 	Array *(*b3_winman_get_winman_arr)(b3_winman_t *winman);
 	int (*b3_winman_set_win)(b3_winman_t *winman, b3_win_t *win);
@@ -68,7 +81,9 @@ struct b3_winman_s {
 													   b3_winman_get_rel_t direction,
 													   char rolling);
 	int (*b3_winman_is_empty)(b3_winman_t *root, char check_deep);
+	int (*b3_winman_get_win_count)(b3_winman_t *winman);
 	int (*b3_winman_reorg)(b3_winman_t *winman);
+	int (*b3_winman_reorg_path)(b3_winman_t *root, b3_winman_t *winman);
 	b3_win_t *(*b3_winman_get_maximized)(b3_winman_t *winman);
 	b3_win_t *(*b3_winman_get_win_at_pos)(b3_winman_t *winman, POINT *position);
 
@@ -80,6 +95,27 @@ struct b3_winman_s {
 	b3_win_t *win;
 
 	b3_winman_mode_t mode;
+
+	/**
+	 * The window manager containing this window manager in its winman_arr. NULL
+	 * if this window manager is the root of a tree. It is maintained by
+	 * b3_winman_add_winman(), b3_winman_add_winman_at(),
+	 * b3_winman_remove_winman() and b3_winman_reorg().
+	 */
+	b3_winman_t *parent;
+
+	/**
+	 * The factory owning the memory of this window manager. NULL if it was
+	 * created by b3_winman_new().
+	 */
+	b3_winman_factory_t *factory;
+
+	/**
+	 * Number of windows within this window manager and all of its children. It
+	 * is updated along the path to the root whenever a window or a window
+	 * manager is added or removed.
+	 */
+	int win_count;
 };
 
 /**
@@ -89,6 +125,14 @@ struct b3_winman_s {
 extern b3_winman_t *
 b3_winman_new(b3_winman_mode_t mode);
 
+/**
+ * @brief Initializes a window manager object in already allocated memory
+ * @param winman The member winman_arr must already point to an empty array.
+ * @return Non-0 if the initialization failed
+ */
+extern int
+b3_winman_init(b3_winman_t *winman, b3_winman_mode_t mode);
+
 /**
  * @brief Deletes a window manager object
  * @return Non-0 if the deletion failed
@@ -108,7 +152,26 @@ b3_winman_traverse(b3_winman_t *winman,
 					void *data);
 
 /**
- * Add another window manager object to a window manager object.
+ * Traverses a window manager without recursion until the visitor asks to stop.
+ *
+ * @param order PRE_ORDER visits a window manager before its children,
+ * POST_ORDER after its children.
+ * @param visitor The visitor of each node. If it returns non-0, then the
+ * traversal stops immediately.
+ * @param data A data object which is passed in to the visitor.
+ * @return The non-0 value returned by the visitor which stopped the traversal.
+ * 0 if all nodes were visited.
+ */
+extern int
+b3_winman_traverse_until(b3_winman_t *winman,
+						 b3_winman_traverse_order_t order,
+						 int visitor(b3_winman_t *winman, void *data),
+						 void *data);
+
+/**
+ * Add another window manager object to a window manager object. If winman is
+ * already contained in another window manager, then it is removed from there
+ * first.
  *
  * @param root The window manager object to which the window manager will be
  * added.
@@ -119,6 +182,17 @@ b3_winman_traverse(b3_winman_t *winman,
 extern int
 b3_winman_add_winman(b3_winman_t *root, b3_winman_t *winman);
 
+/**
+ * Same as b3_winman_add_winman(), but places winman at the given position of
+ * the first level of root.
+ *
+ * @param index The position within root. If it is equal to the number of
+ * window managers in root, then winman is appended.
+ * @return 0 if added. Non-0 otherwise.
+ */
+extern int
+b3_winman_add_winman_at(b3_winman_t *root, b3_winman_t *winman, int index);
+
 /**
  * Remove a window manager object from a window manager object. It uses a
  * reference comparison to check for equality. It only removes the window
@@ -165,9 +239,9 @@ extern b3_winman_mode_t
 b3_winman_get_mode(b3_winman_t *winman);
 
 /**
- * Searches for the parent of a window manager instance within a window
- * manager. It uses a reference comparison to check for equality. The search
- * runs through the entire tree.
+ * Returns the parent of a window manager instance within a window manager. The
+ * parent is looked up directly, root is only verified by walking up the
+ * ancestors of winman.
  *
  * @param root The window manager to search in
  * @param winman The window manager to search for
@@ -213,19 +287,41 @@ b3_winman_get_winman_rel_to_winman(b3_winman_t *root,
  * If root does not contain any window manager containing a window, then root is empty.
  *
  * @param root The window manager to check for emptiness.
- * @param check_deeply If non-0, then the tree is checked deeply. Otherwise only
- * the first level of root is checked.
+ * @param check_deeply If non-0, then the tree is checked deeply (in constant
+ * time). Otherwise only the first level of root is checked.
  * @return Non-0 if root contains any window manager containing a window.
  */
 extern int
 b3_winman_is_empty(b3_winman_t *root, char check_deeply);
 
+/**
+ * @return The number of windows within the window manager and all of its
+ * children.
+ */
+extern int
+b3_winman_get_win_count(b3_winman_t *winman);
+
 /**
  * Re-organize the window manager tree internally by removing empty subtrees.
  */
 extern int
 b3_winman_reorg(b3_winman_t *winman);
 
+/**
+ * Re-organize only the path from winman up to root. Starting at winman, every
+ * empty window manager is removed from its parent and freed, until a
+ * non-empty window manager or root is reached. root itself is never removed.
+ *
+ * Use it after an edit which might have emptied winman. Only the nodes on the
+ * path are touched, in contrast to b3_winman_reorg().
+ *
+ * @param winman Must be within root. It might be freed, so do not use it
+ * afterwards unless it still contains windows.
+ * @return 0 if the path was re-organized. Non-0 otherwise.
+ */
+extern int
+b3_winman_reorg_path(b3_winman_t *root, b3_winman_t *winman);
+
 /**
  * @return NULL if no window is maxmized. Otherwise the maximized window is returned.
  */
@@ -0,0 +1,197 @@
+/******************************************************************************
+  This file is part of b3.
+
+  Copyright 2021 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * @author Richard Bäck <richard.baeck@mailbox.org>
+ * @date 2021-04-10
+ * @brief File contains the window manager factory class implementation and private methods
+ */
+
+#include "winman_factory.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <w32bindkeys/logger.h>
+
+static wbk_logger_t logger = { "winman_factory" };
+
+static int
+b3_winman_factory_free_impl(b3_winman_factory_t *winman_factory);
+
+static b3_winman_t *
+b3_winman_factory_winman_create_impl(b3_winman_factory_t *winman_factory, b3_winman_mode_t mode);
+
+static int
+b3_winman_factory_winman_free_impl(b3_winman_factory_t *winman_factory, b3_winman_t *winman);
+
+/**
+ * Allocates a new slab of window managers and adds them to the free window
+ * managers.
+ *
+ * @return 0 if the slab was added. Non-0 otherwise.
+ */
+static int
+b3_winman_factory_add_slab(b3_winman_factory_t *winman_factory);
+
+b3_winman_factory_t *
+b3_winman_factory_new(void)
+{
+	b3_winman_factory_t *winman_factory;
+
+	winman_factory = malloc(sizeof(b3_winman_factory_t));
+	if (winman_factory) {
+		memset(winman_factory, 0, sizeof(b3_winman_factory_t));
+
+		winman_factory->b3_winman_factory_free = b3_winman_factory_free_impl;
+		winman_factory->b3_winman_factory_winman_create = b3_winman_factory_winman_create_impl;
+		winman_factory->b3_winman_factory_winman_free = b3_winman_factory_winman_free_impl;
+
+		array_new(&(winman_factory->slab_arr));
+		array_new(&(winman_factory->free_winman_arr));
+	}
+
+	return winman_factory;
+}
+
+int
+b3_winman_factory_free(b3_winman_factory_t *winman_factory)
+{
+	return winman_factory->b3_winman_factory_free(winman_factory);
+}
+
+b3_winman_t *
+b3_winman_factory_winman_create(b3_winman_factory_t *winman_factory, b3_winman_mode_t mode)
+{
+	return winman_factory->b3_winman_factory_winman_create(winman_factory, mode);
+}
+
+int
+b3_winman_factory_winman_free(b3_winman_factory_t *winman_factory, b3_winman_t *winman)
+{
+	return winman_factory->b3_winman_factory_winman_free(winman_factory, winman);
+}
+
+int
+b3_winman_factory_free_impl(b3_winman_factory_t *winman_factory)
+{
+	ArrayIter iter;
+	b3_winman_t *slab_iter;
+	int i;
+
+	array_iter_init(&iter, winman_factory->slab_arr);
+	while (array_iter_next(&iter, (void *) &slab_iter) != CC_ITER_END) {
+		for (i = 0; i < B3_WINMAN_FACTORY_SLAB_SIZE; i++) {
+			array_destroy(slab_iter[i].winman_arr);
+		}
+		free(slab_iter);
+	}
+	array_destroy(winman_factory->slab_arr);
+	winman_factory->slab_arr = NULL;
+
+	array_destroy(winman_factory->free_winman_arr);
+	winman_factory->free_winman_arr = NULL;
+
+	free(winman_factory);
+
+	return 0;
+}
+
+b3_winman_t *
+b3_winman_factory_winman_create_impl(b3_winman_factory_t *winman_factory, b3_winman_mode_t mode)
+{
+	b3_winman_t *winman;
+
+	winman = NULL;
+
+	if (array_size(winman_factory->free_winman_arr) <= 0) {
+		b3_winman_factory_add_slab(winman_factory);
+	}
+
+	if (array_remove_last(winman_factory->free_winman_arr, (void *) &winman) == CC_OK) {
+		b3_winman_init(winman, mode);
+		winman->factory = winman_factory;
+	} else {
+		wbk_logger_log(&logger, SEVERE, "Unable to allocate a window manager.\n");
+		winman = NULL;
+	}
+
+	return winman;
+}
+
+int
+b3_winman_factory_winman_free_impl(b3_winman_factory_t *winman_factory, b3_winman_t *winman)
+{
+	int error;
+
+	error = 1;
+
+	if (winman->factory == winman_factory) {
+		/**
+		 * Keep the child array of the window manager, so it does not have to
+		 * be allocated again.
+		 */
+		array_remove_all(winman->winman_arr);
+		winman->win = NULL;
+		winman->parent = NULL;
+		winman->win_count = 0;
+
+		error = array_add(winman_factory->free_winman_arr, winman);
+	} else {
+		wbk_logger_log(&logger, SEVERE, "Window manager was not created by this factory.\n");
+	}
+
+	return error;
+}
+
+int
+b3_winman_factory_add_slab(b3_winman_factory_t *winman_factory)
+{
+	int error;
+	b3_winman_t *slab;
+	int i;
+
+	error = 1;
+
+	slab = malloc(sizeof(b3_winman_t) * B3_WINMAN_FACTORY_SLAB_SIZE);
+	if (slab) {
+		memset(slab, 0, sizeof(b3_winman_t) * B3_WINMAN_FACTORY_SLAB_SIZE);
+
+		array_add(winman_factory->slab_arr, slab);
+
+		/**
+		 * Add them in reverse order, so they are handed out in the order of
+		 * their memory location.
+		 */
+		for (i = B3_WINMAN_FACTORY_SLAB_SIZE - 1; i >= 0; i--) {
+			array_new(&(slab[i].winman_arr));
+
+			slab[i].factory = winman_factory;
+			array_add(winman_factory->free_winman_arr, &(slab[i]));
+		}
+
+		error = 0;
+	}
+
+	return error;
+}
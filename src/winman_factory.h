@@ -0,0 +1,101 @@
+/******************************************************************************
+  This file is part of b3.
+
+  Copyright 2021 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * @author Richard Bäck <richard.baeck@mailbox.org>
+ * @date 2021-04-10
+ * @brief File contains the window manager factory class definition
+ */
+
+#include <collectc/array.h>
+
+#include "winman.h"
+
+#ifndef B3_WINMAN_FACTORY_H
+#define B3_WINMAN_FACTORY_H
+
+/**
+ * Number of window managers allocated at once by a window manager factory.
+ */
+#define B3_WINMAN_FACTORY_SLAB_SIZE 32
+
+struct b3_winman_factory_s
+{
+	int (* b3_winman_factory_free)(b3_winman_factory_t *winman_factory);
+	b3_winman_t *(* b3_winman_factory_winman_create)(b3_winman_factory_t *winman_factory, b3_winman_mode_t mode);
+	int (* b3_winman_factory_winman_free)(b3_winman_factory_t *winman_factory, b3_winman_t *winman);
+
+	/**
+	 * Array of b3_winman_t *
+	 *
+	 * Each element points to B3_WINMAN_FACTORY_SLAB_SIZE window managers which
+	 * were allocated at once.
+	 */
+	Array *slab_arr;
+
+	/**
+	 * Array of b3_winman_t *
+	 *
+	 * Window managers of the slabs that are currently not in use.
+	 */
+	Array *free_winman_arr;
+};
+
+/**
+ * @brief Creates a new window manager factory
+ * @return A new window manager factory or NULL if allocation failed
+ */
+extern b3_winman_factory_t *
+b3_winman_factory_new(void);
+
+/**
+ * @brief Deletes a window manager factory. All window managers created by the
+ * factory are released at once, regardless of whether they were freed before.
+ * @return Non-0 if the deletion failed
+ */
+extern int
+b3_winman_factory_free(b3_winman_factory_t *winman_factory);
+
+/**
+ * Takes a window manager from the free window managers of the factory. Only
+ * if none is left, then a new slab of window managers is allocated.
+ *
+ * @return A new window manager. Free it by using b3_winman_free(). It is then
+ * given back to the factory.
+ */
+extern b3_winman_t *
+b3_winman_factory_winman_create(b3_winman_factory_t *winman_factory, b3_winman_mode_t mode);
+
+/**
+ * Gives a window manager back to the factory. It is called by b3_winman_free()
+ * for window managers created by the factory, so you usually do not need to
+ * call it by yourself. The child window managers have to be removed already.
+ *
+ * @return 0 if the window manager is managed and was given back. Non-0
+ * otherwise.
+ */
+extern int
+b3_winman_factory_winman_free(b3_winman_factory_t *winman_factory, b3_winman_t *winman);
+
+#endif // B3_WINMAN_FACTORY_H
@@ -28,11 +28,13 @@
 #include <string.h>
 #include <w32bindkeys/logger.h>
 #include <windows.h>
-#include <collectc/stack.h>
 
 #include "win.h"
 #include "winman.h"
 
+#define B3_WS_PENDING_AREA_ARR_MIN_SIZE 16
+#define B3_WS_PREVIOUSLY_FOCUSED_ARR_MIN_SIZE 16
+
 static wbk_logger_t logger = { "ws" };
 
 typedef struct b3_ws_toggle_floating_visitor_s
@@ -52,14 +54,23 @@ typedef struct b3_ws_toggle_floating_visitor_s
 	const b3_win_t *floating_win;
 } b3_ws_toggle_floating_visitor_t;
 
-typedef struct b3_ws_find_last_previous_s
+typedef struct b3_ws_layout_s
 {
-	int found;
+	int error;
+
+	b3_ws_t *ws;
 
 	/**
-	 * The same as the member previously_focused_win_arr of the struct b3_ws_t.
+	 * Number of entries in ws->pending_area_arr.
 	 */
-	Array *previously_focused_win_arr;
+	int pending_area_count;
+} b3_ws_layout_t;
+
+typedef struct b3_ws_find_last_previous_s
+{
+	int found;
+
+	b3_ws_t *ws;
 } b3_ws_find_last_previous_t;
 
 static int
@@ -107,12 +118,6 @@ b3_ws_contains_win_impl(b3_ws_t *ws, const b3_win_t *win);
 static int
 b3_ws_is_empty_impl(b3_ws_t *ws);
 
-/**
- * @param data Must be actually of type int *.
- */
-static void
-b3_ws_is_empty_visitor(b3_winman_t *winman, void *data);
-
 static b3_win_t *
 b3_ws_get_win_rel_to_focused_win_impl_internal(b3_ws_t *ws,
 											   b3_ws_move_direction_t direction,
@@ -125,28 +130,89 @@ b3_ws_get_win_rel_to_focused_win_impl(b3_ws_t *ws,
 
 /**
  * A traverser searching for the container containing the last (highest)
- * previously focused window.
+ * previously focused window. It stops as soon as the most recently focused
+ * window was found.
  *
  * @param data Must be actually of type b3_ws_find_last_previous_t *.
  */
-static void
+static int
 b3_ws_find_last_previous_visitor(b3_winman_t *winman, void *data);
 
 static int
 b3_ws_arrange_wins_impl(b3_ws_t *ws, RECT monitor_area);
 
-static DWORD WINAPI
-b3_ws_show_floating_threaded(LPVOID param);
+static int
+b3_ws_layout_wins_impl(b3_ws_t *ws, RECT monitor_area);
 
 /**
- * @param data Must be actually of type Stack * (containing only RECT *).
+ * @param data Must be actually of type b3_ws_layout_t *.
  */
-static void
-b3_ws_arrange_wins_visitor(b3_winman_t *winman, void *data);
+static int
+b3_ws_layout_wins_visitor(b3_winman_t *winman, void *data);
+
+/**
+ * Grows ws->pending_area_arr to hold at least min_size areas.
+ */
+static int
+b3_ws_layout_grow_pending(b3_ws_t *ws, int min_size);
 
 static b3_win_t *
 b3_ws_get_win_at_pos_impl(b3_ws_t *ws, POINT *position);
 
+/**
+ * Pushes win onto ws->previously_focused_arr, unless it is already on top.
+ */
+static int
+b3_ws_push_previously_focused(b3_ws_t *ws, const b3_win_t *win);
+
+/**
+ * Removes all occurrences of win from ws->previously_focused_arr.
+ */
+static int
+b3_ws_remove_previously_focused(b3_ws_t *ws, const b3_win_t *win);
+
+/**
+ * Pops the top of ws->previously_focused_arr. Handles of freed windows are
+ * dropped.
+ *
+ * @return The previously focused window. NULL if there is none.
+ */
+static b3_win_t *
+b3_ws_pop_previously_focused(b3_ws_t *ws);
+
+/**
+ * @return A new hash table using window handlers as keys.
+ */
+static HashTable *
+b3_ws_win_table_new(void);
+
+/**
+ * @return The leaf of the window tree containing win. NULL if win is not
+ * within the window tree. Do not free it!
+ */
+static b3_winman_t *
+b3_ws_get_winman_of_win(b3_ws_t *ws, const b3_win_t *win);
+
+/**
+ * @return The floating window equal to win. NULL if win is not a floating
+ * window of the workspace. Do not free it!
+ */
+static b3_win_t *
+b3_ws_get_floating_win(b3_ws_t *ws, const b3_win_t *win);
+
+/**
+ * Removes the empty window managers on the path from winman up to the root of
+ * the workspace. In debug builds the whole tree is re-organized afterwards to
+ * validate that the path was the only part needing a re-organization.
+ */
+static int
+b3_ws_reorg_path(b3_ws_t *ws, b3_winman_t *winman);
+
+#ifdef DEBUG_ENABLED
+static void
+b3_ws_count_winman_visitor(b3_winman_t *winman, void *data);
+#endif
+
 b3_ws_t *
 b3_ws_new(const char *name)
 {
@@ -171,15 +237,28 @@ b3_ws_new(const char *name)
 		ws->b3_ws_is_empty = b3_ws_is_empty_impl;
 		ws->b3_ws_get_win_rel_to_focused_win = b3_ws_get_win_rel_to_focused_win_impl;
 		ws->b3_ws_arrange_wins = b3_ws_arrange_wins_impl;
+		ws->b3_ws_layout_wins = b3_ws_layout_wins_impl;
 		ws->b3_ws_get_win_at_pos = b3_ws_get_win_at_pos_impl;
 
-		ws->winman = b3_winman_new(HORIZONTAL);
+		ws->winman_factory = b3_winman_factory_new();
+		ws->winman = b3_winman_factory_winman_create(ws->winman_factory, HORIZONTAL);
 		ws->mode = DEFAULT;
 		b3_ws_set_name(ws, name);
 		ws->focused_win = NULL;
 		ws->focused_win_tree = NULL;
-		array_new(&(ws->previously_focused_win_arr));
+		ws->previously_focused_arr = NULL;
+		ws->previously_focused_arr_size = 0;
+		ws->previously_focused_count = 0;
 		array_new(&(ws->floating_win_arr));
+		ws->winman_table = b3_ws_win_table_new();
+		ws->floating_win_table = b3_ws_win_table_new();
+		ws->pending_area_arr = NULL;
+		ws->pending_area_arr_size = 0;
+		ws->leaf_area_arr = NULL;
+		ws->leaf_win_arr = NULL;
+		ws->leaf_area_arr_size = 0;
+		ws->leaf_area_count = 0;
+		ws->batch = b3_win_batch_new(b3_win_batch_queue, NULL);
 	}
 
 	return ws;
@@ -277,6 +356,12 @@ b3_ws_arrange_wins(b3_ws_t *ws, RECT monitor_area)
 	return ws->b3_ws_arrange_wins(ws, monitor_area);
 }
 
+int
+b3_ws_layout_wins(b3_ws_t *ws, RECT monitor_area)
+{
+	return ws->b3_ws_layout_wins(ws, monitor_area);
+}
+
 b3_win_t *
 b3_ws_get_win_at_pos(b3_ws_t *ws, POINT *position)
 {
@@ -286,7 +371,12 @@ b3_ws_get_win_at_pos(b3_ws_t *ws, POINT *position)
 int
 b3_ws_free_impl(b3_ws_t *ws)
 {
-	b3_winman_free(ws->winman);
+	/**
+	 * Releases all window managers at once. There is no need to free the tree
+	 * beforehand.
+	 */
+	b3_winman_factory_free(ws->winman_factory);
+	ws->winman_factory = NULL;
 	ws->winman = NULL;
 
 	free(ws->name);
@@ -294,12 +384,32 @@ b3_ws_free_impl(b3_ws_t *ws)
 
 	ws->focused_win = NULL;
 
-	array_destroy(ws->previously_focused_win_arr);
-	ws->previously_focused_win_arr = NULL;
+	free(ws->previously_focused_arr);
+	ws->previously_focused_arr = NULL;
+	ws->previously_focused_arr_size = 0;
+	ws->previously_focused_count = 0;
 
 	array_destroy(ws->floating_win_arr);
 	ws->floating_win_arr = NULL;
 
+	hashtable_destroy(ws->winman_table);
+	ws->winman_table = NULL;
+
+	hashtable_destroy(ws->floating_win_table);
+	ws->floating_win_table = NULL;
+
+	free(ws->pending_area_arr);
+	ws->pending_area_arr = NULL;
+
+	free(ws->leaf_area_arr);
+	ws->leaf_area_arr = NULL;
+
+	free(ws->leaf_win_arr);
+	ws->leaf_win_arr = NULL;
+
+	b3_win_batch_free(ws->batch);
+	ws->batch = NULL;
+
 	free(ws);
 	return 0;
 }
@@ -333,35 +443,22 @@ b3_ws_set_focused_win_impl(b3_ws_t *ws, const b3_win_t *win)
 {
 	b3_winman_t *winman;
 	int error;
-	int i;
-	int j;
-	int len;
-	ArrayIter iter;
-	b3_win_t *win_iter;
 	b3_win_t *new_focused_win;
-	b3_win_t *a;
-	b3_win_t *b;
 
 	error = 1;
 	if (win) {
-		new_focused_win = NULL;
 		ws->focused_win_tree = NULL;
 
 		/**
 		 * Search in the floating windows.
 		 */
-		array_iter_init(&iter, ws->floating_win_arr);
-		while (new_focused_win == NULL && array_iter_next(&iter, (void*) &win_iter) != CC_ITER_END) {
-			if (b3_win_compare(win_iter, win) == 0) {
-				new_focused_win = win_iter;
-			}
-		}
+		new_focused_win = b3_ws_get_floating_win(ws, win);
 
 		/**
 		 * Search in the window tree.
 		 */
 		if (new_focused_win == NULL) {
-			winman = b3_winman_contains_win(ws->winman, win);
+			winman = b3_ws_get_winman_of_win(ws, win);
 			if (winman) {
 				new_focused_win = b3_winman_get_win(winman);
 				ws->focused_win_tree = new_focused_win;
@@ -371,27 +468,9 @@ b3_ws_set_focused_win_impl(b3_ws_t *ws, const b3_win_t *win)
 		if (new_focused_win) {
 			error = 0;
 			if (ws->focused_win) {
-				array_add(ws->previously_focused_win_arr, ws->focused_win);
+				b3_ws_push_previously_focused(ws, ws->focused_win);
 			}
 			ws->focused_win = new_focused_win;
-
-			/**
-			 * Remove all duplicates
-			 */
-			len = array_size(ws->previously_focused_win_arr);
-			for (i = 0; i < len; i++) {
-				array_get_at(ws->previously_focused_win_arr, i, (void *) &a);
-				for (j = i + 1; j < len; j++) {
-					array_get_at(ws->previously_focused_win_arr, j, (void *) &b);
-					if (a == b) {
-						array_remove_at(ws->previously_focused_win_arr, j, NULL);
-						j--;
-						len--;
-					} else {
-						j = len;
-					}
-				}
-			}
 		}
 	} else if (b3_ws_is_empty(ws)) {
 		ws->focused_win = NULL;
@@ -414,10 +493,11 @@ b3_ws_add_win_impl(b3_ws_t *ws, b3_win_t *win)
 
 	if (b3_win_get_floating(win)) {
 		array_add(ws->floating_win_arr, win);
+		hashtable_add(ws->floating_win_table, b3_win_get_window_handler(win), win);
 		b3_ws_set_focused_win(ws, win);
 		error = 0;
 	} else {
-		winman = b3_winman_contains_win(ws->winman, win);
+		winman = b3_ws_get_winman_of_win(ws, win);
 		if (!winman) {
 			/**
 			 * Window was not yet added
@@ -428,7 +508,7 @@ b3_ws_add_win_impl(b3_ws_t *ws, b3_win_t *win)
 				/**
 				 * There is at least one window already in the workspace
 				 */
-				winman = b3_winman_contains_win(ws->winman, focused_win);
+				winman = b3_ws_get_winman_of_win(ws, focused_win);
 
 				if (winman) {
 					winman = b3_winman_get_parent(ws->winman, winman);
@@ -443,10 +523,13 @@ b3_ws_add_win_impl(b3_ws_t *ws, b3_win_t *win)
 			}
 
 			if (!error) {
-				winman_for_win = b3_winman_new(UNSPECIFIED);
+				winman_for_win = b3_winman_factory_winman_create(ws->winman_factory, UNSPECIFIED);
 				b3_winman_set_win(winman_for_win, win);
 
 				b3_winman_add_winman(winman, winman_for_win);
+				hashtable_add(ws->winman_table,
+							  b3_win_get_window_handler(win),
+							  winman_for_win);
 
 				b3_ws_set_focused_win(ws, win);
 			}
@@ -472,58 +555,52 @@ b3_ws_remove_win_impl(b3_ws_t *ws, b3_win_t *win)
 	root = NULL;
 	new_focused_win = NULL;
 
-	array_iter_init(&iter, ws->floating_win_arr);
-	while (error && array_iter_next(&iter, (void*) &win_iter) != CC_ITER_END) {
-		if (b3_win_compare(win_iter, win) == 0) {
-			array_iter_remove(&iter, NULL);
-			error = 0;
+	if (b3_ws_get_floating_win(ws, win)) {
+		array_iter_init(&iter, ws->floating_win_arr);
+		while (error && array_iter_next(&iter, (void*) &win_iter) != CC_ITER_END) {
+			if (b3_win_compare(win_iter, win) == 0) {
+				array_iter_remove(&iter, NULL);
+				error = 0;
+			}
 		}
+
+		hashtable_remove(ws->floating_win_table, b3_win_get_window_handler(win), NULL);
 	}
 
 	if (error) {
-		winman = b3_winman_contains_win(ws->winman, win);
+		winman = b3_ws_get_winman_of_win(ws, win);
 		if (winman) {
 			root = b3_winman_get_parent(ws->winman, winman);
 			if (root) {
 				error = b3_winman_remove_winman(root, winman);
 			}
+
+			if (!error) {
+				hashtable_remove(ws->winman_table, b3_win_get_window_handler(win), NULL);
+			}
 		}
 	}
 
 	if (!error) {
 		/**
-		 * Remove all occurrences of win in ws->previously_focused_win_arr.
+		 * Remove all occurrences of win in ws->previously_focused_arr.
 		 */
-		array_iter_init(&iter, ws->previously_focused_win_arr);
-		while (array_iter_next(&iter, (void*) &win_iter) != CC_ITER_END) {
-			if (b3_win_compare(win_iter, win) == 0) {
-				array_iter_remove(&iter, NULL);
-			}
-		}
+		b3_ws_remove_previously_focused(ws, win);
 
 		/**
 		 * Set new focused window
 		 */
 		if (b3_ws_get_focused_win(ws)
 			&& b3_win_compare(b3_ws_get_focused_win(ws), win) == 0) {
-			new_focused_win = NULL;
-
-			if (array_size(ws->previously_focused_win_arr)) {
-				array_remove_last(ws->previously_focused_win_arr, (void *) &new_focused_win);
-			}
+			new_focused_win = b3_ws_pop_previously_focused(ws);
 
 			b3_ws_set_focused_win(ws, new_focused_win);
 
 			/**
 			 * Again remove all occurrences of win in in
-			 * ws->previously_focused_win_arr since b3_ws_set_focused_win_impl() added new_focused_win again.
+			 * ws->previously_focused_arr since b3_ws_set_focused_win_impl() added new_focused_win again.
 			 */
-			array_iter_init(&iter, ws->previously_focused_win_arr);
-			while (array_iter_next(&iter, (void*) &win_iter) != CC_ITER_END) {
-				if (b3_win_compare(win_iter, win) == 0) {
-					array_iter_remove(&iter, NULL);
-				}
-			}
+			b3_ws_remove_previously_focused(ws, win);
 		}
 
 		if (winman) {
@@ -533,33 +610,11 @@ b3_ws_remove_win_impl(b3_ws_t *ws, b3_win_t *win)
 		/**
 		 * Remove all parent window managers that are now empty
 		 */
-		while (root && root != ws->winman) {
-			if (array_size(b3_winman_get_winman_arr(root)) <= 0) {
-				winman = root;
-				root = b3_winman_get_parent(ws->winman, winman);
-				if (b3_winman_remove_winman(root, winman)) {
-					wbk_logger_log(&logger, SEVERE, "Unexpected error in workspace. Please contact the project maintainer(s)!\n");
-
-					/**
-					 * Exit the loop
-					 */
-					root = NULL;
-				} else {
-					b3_winman_free(winman);
-				}
-			} else {
-				/**
-				 * Exit the loop
-				 */
-				root = NULL;
-			}
+		if (root && b3_ws_reorg_path(ws, root)) {
+			wbk_logger_log(&logger, SEVERE, "Unexpected error in workspace. Please contact the project maintainer(s)!\n");
 		}
 	}
 
-	if (!error) {
-		b3_winman_reorg(ws->winman);
-	}
-
 	return error;
 }
 
@@ -572,13 +627,13 @@ b3_ws_split_impl(b3_ws_t *ws, b3_winman_mode_t mode)
 	b3_winman_t *split;
 
 	error = 1;
-	winman = b3_winman_contains_win(ws->winman, b3_ws_get_focused_win(ws));
+	winman = b3_ws_get_winman_of_win(ws, b3_ws_get_focused_win(ws));
 	if (winman) {
 		root = b3_winman_get_parent(ws->winman, winman);
 		if (root) {
 			b3_winman_remove_winman(root, winman);
 
-			split = b3_winman_new(mode);
+			split = b3_winman_factory_winman_create(ws->winman_factory, mode);
 			b3_winman_add_winman(split, winman);
 
 			b3_winman_add_winman(root, split);
@@ -630,7 +685,7 @@ b3_ws_move_focused_win_impl(b3_ws_t *ws, b3_ws_move_direction_t direction)
 
 	focused_win = b3_ws_get_focused_win(ws);
 	if (focused_win) {
-		focused_win_container = b3_winman_contains_win(ws->winman, focused_win);
+		focused_win_container = b3_ws_get_winman_of_win(ws, focused_win);
 		if (focused_win_container) {
 			root = b3_winman_get_parent(ws->winman, focused_win_container);
 			if (root == NULL) {
@@ -646,7 +701,7 @@ b3_ws_move_focused_win_impl(b3_ws_t *ws, b3_ws_move_direction_t direction)
 		/**
 		 * Utilize the available window manager
 		 */
-		container = b3_winman_contains_win(ws->winman, win_in_direction);
+		container = b3_ws_get_winman_of_win(ws, win_in_direction);
 		if (container) {
 			root_new = b3_winman_get_parent(ws->winman, container);
 			if (root_new == NULL) {
@@ -677,15 +732,25 @@ b3_ws_move_focused_win_impl(b3_ws_t *ws, b3_ws_move_direction_t direction)
 			 */
 			container = b3_winman_get_parent(ws->winman, root);
 			if (container) {
-				root_new = container;
-				container = b3_winman_new(mode);
-				b3_winman_add_winman(container, root);
-				b3_winman_add_winman(root_new, container);
+				/**
+				 * Put root into a new window manager which takes over the
+				 * position of root.
+				 */
+				root_new = b3_winman_factory_winman_create(ws->winman_factory, mode);
+				arr_len = array_size(b3_winman_get_winman_arr(container));
+				for (i = 0; i < arr_len; i++) {
+					array_get_at(b3_winman_get_winman_arr(container), i, (void *) &winman_iter);
+					if (winman_iter == root) {
+						b3_winman_add_winman_at(container, root_new, i);
+						i = arr_len;
+					}
+				}
+				b3_winman_add_winman(root_new, root);
 			} else {
 				/**
 				 * root == ws->winman!
 				 */
-				root_new = b3_winman_new(mode);
+				root_new = b3_winman_factory_winman_create(ws->winman_factory, mode);
 				b3_winman_add_winman(root_new, root);
 				ws->winman = root_new;
 			}
@@ -727,14 +792,7 @@ b3_ws_move_focused_win_impl(b3_ws_t *ws, b3_ws_move_direction_t direction)
 		 *
 		 * Therefore we first have to remove focused_win_container from root.
 		 */
-		arr_len = array_size(b3_winman_get_winman_arr(root));
-		for (i = 0; i < arr_len; i++) {
-			array_get_at(b3_winman_get_winman_arr(root), i, (void *) &winman_iter);
-			if (winman_iter == focused_win_container) {
-				array_remove_at(b3_winman_get_winman_arr(root), i, NULL);
-				i = arr_len;
-			}
-		}
+		b3_winman_remove_winman(root, focused_win_container);
 
 		/**
 		 * Now we can place focused_win_container before/after the position
@@ -756,9 +814,7 @@ b3_ws_move_focused_win_impl(b3_ws_t *ws, b3_ws_move_direction_t direction)
 					i = arr_len;
 				}
 
-				array_add_at(b3_winman_get_winman_arr(root_new),
-							 focused_win_container,
-							 i);
+				b3_winman_add_winman_at(root_new, focused_win_container, i);
 
 				i = arr_len;
 			}
@@ -771,14 +827,7 @@ b3_ws_move_focused_win_impl(b3_ws_t *ws, b3_ws_move_direction_t direction)
 		 *
 		 * Therefore we first have to remove focused_win_container from root.
 		 */
-		arr_len = array_size(b3_winman_get_winman_arr(root));
-		for (i = 0; i < arr_len; i++) {
-			array_get_at(b3_winman_get_winman_arr(root), i, (void *) &winman_iter);
-			if (winman_iter == focused_win_container) {
-				array_remove_at(b3_winman_get_winman_arr(root), i, NULL);
-				i = arr_len;
-			}
-		}
+		b3_winman_remove_winman(root, focused_win_container);
 
 		b3_winman_add_winman(root_new, focused_win_container);
 
@@ -786,7 +835,13 @@ b3_ws_move_focused_win_impl(b3_ws_t *ws, b3_ws_move_direction_t direction)
 	}
 
 	if (!error) {
-		b3_winman_reorg(ws->winman);
+		/**
+		 * Only the old and the new parent of focused_win_container were
+		 * modified. The new parent contains focused_win_container, so only the
+		 * path of the old one can contain empty window managers.
+		 */
+		b3_ws_reorg_path(ws, root);
+		b3_ws_reorg_path(ws, b3_winman_get_parent(ws->winman, focused_win_container));
 	}
 
 	return error;
@@ -861,20 +916,13 @@ b3_ws_contains_win_impl(b3_ws_t *ws, const b3_win_t *win)
 {
 	b3_winman_t *container;
 	b3_win_t *found;
-	ArrayIter iter;
-	b3_win_t *win_iter;
 
 	found = NULL;
-	container = b3_winman_contains_win(ws->winman, win);
+	container = b3_ws_get_winman_of_win(ws, win);
 	if (container) {
 		found = b3_winman_get_win(container);
 	} else {
-		array_iter_init(&iter, ws->floating_win_arr);
-		while (found == NULL && array_iter_next(&iter, (void*) &win_iter) != CC_ITER_END) {
-			if (b3_win_compare(win_iter, win) == 0) {
-				found = win_iter;
-			}
-		}
+		found = b3_ws_get_floating_win(ws, win);
 	}
 
 	return found;
@@ -883,35 +931,15 @@ b3_ws_contains_win_impl(b3_ws_t *ws, const b3_win_t *win)
 int
 b3_ws_is_empty_impl(b3_ws_t *ws)
 {
-	int number;
+	int is_empty;
 
-	number = 0;
+	is_empty = 0;
 
-	number = array_size(ws->floating_win_arr);
-	if (number > 0) {
-		number = 0;
-	} else {
-		b3_winman_traverse(ws->winman, b3_ws_is_empty_visitor, &number);
-		if (number > 0) {
-			number = 0;
-		} else {
-			number = 1;
-		}
+	if (array_size(ws->floating_win_arr) <= 0) {
+		is_empty = b3_winman_is_empty(ws->winman, 1);
 	}
 
-	return number;
-}
-
-void
-b3_ws_is_empty_visitor(b3_winman_t *winman, void *data)
-{
-	int *number;
-
-	number = (int *) data;
-
-	if (b3_winman_get_win(winman)) {
-		(*number)++;
-	}
+	return is_empty;
 }
 
 b3_win_t *
@@ -943,7 +971,7 @@ b3_ws_get_win_rel_to_focused_win_impl_internal(b3_ws_t *ws,
 		child_to_get = NEXT;
 	}
 
-	focused_win_container = b3_winman_contains_win(ws->winman, b3_ws_get_focused_win(ws));
+	focused_win_container = b3_ws_get_winman_of_win(ws, b3_ws_get_focused_win(ws));
 	if (focused_win_container) {
 		parent = focused_win_container;
 		container = focused_win_container;
@@ -996,14 +1024,14 @@ b3_ws_get_win_rel_to_focused_win_impl_internal(b3_ws_t *ws,
 		 */
 		if (parent) {
 			find_last_previous.found = -1;
-			find_last_previous.previously_focused_win_arr = ws->previously_focused_win_arr;
+			find_last_previous.ws = ws;
 
-			b3_winman_traverse(parent, b3_ws_find_last_previous_visitor,
-							   (void *) &find_last_previous);
+			b3_winman_traverse_until(parent, PRE_ORDER,
+									 b3_ws_find_last_previous_visitor,
+									 (void *) &find_last_previous);
 
 			if (find_last_previous.found >= 0) {
-				array_get_at(ws->previously_focused_win_arr, find_last_previous.found,
-							 (void *) &found);
+				found = b3_win_from_handle(ws->previously_focused_arr[find_last_previous.found]);
 			}
 		}
 	}
@@ -1034,14 +1062,18 @@ b3_ws_get_win_rel_to_focused_win_impl(b3_ws_t *ws,
 	return found;
 }
 
-void
+int
 b3_ws_find_last_previous_visitor(b3_winman_t *winman, void *data)
 {
 	b3_ws_find_last_previous_t *find_last_previous;
 	b3_win_t *win;
+	b3_win_handle_t handle;
+	b3_ws_t *ws;
 	int i;
 	int length;
-	b3_win_t *win_iter;
+	int stop;
+
+	stop = 0;
 
 	find_last_previous = (b3_ws_find_last_previous_t *) data;
 	if (find_last_previous) {
@@ -1051,58 +1083,57 @@ b3_ws_find_last_previous_visitor(b3_winman_t *winman, void *data)
 			 * Is a leaf node
 			 */
 
-			length = array_size(find_last_previous->previously_focused_win_arr);
+			ws = find_last_previous->ws;
+			handle = b3_win_get_handle(win);
+			length = ws->previously_focused_count;
 			for (i = find_last_previous->found + 1; i < length; i++) {
-				array_get_at(find_last_previous->previously_focused_win_arr,
-							 i,
-							 (void *) &win_iter);
-				if (win_iter
-				    && b3_win_compare(win, win_iter) == 0) {
+				if (handle != B3_WIN_HANDLE_NULL
+				    && ws->previously_focused_arr[i] == handle) {
 					find_last_previous->found = i;
 				}
 			}
+
+			/**
+			 * Nothing can be found after the last element.
+			 */
+			if (find_last_previous->found == length - 1) {
+				stop = 1;
+			}
 		}
 	}
+
+	return stop;
 }
 
 int
 b3_ws_arrange_wins_impl(b3_ws_t *ws, RECT monitor_area)
 {
 	b3_win_t *maximized_win;
+	ArrayIter iter;
+	b3_win_t *win_iter;
+	int i;
 
 	maximized_win = b3_winman_get_maximized(ws->winman);
 	if (maximized_win == NULL) {
-		/**
-		 * Stack of RECT *
-		 */
-		Stack *area_stack;
+		b3_win_batch_begin(ws->batch);
 
-		RECT *my_area;
-
-		stack_new(&area_stack);
-
-		my_area = malloc(sizeof(RECT));
-		my_area->top = monitor_area.top;
-		my_area->bottom = monitor_area.bottom;
-		my_area->left = monitor_area.left;
-		my_area->right = monitor_area.right;
-		stack_push(area_stack, my_area);
-
-		b3_winman_traverse(ws->winman,
-						   b3_ws_arrange_wins_visitor,
-						   area_stack);
-
-		stack_destroy(area_stack);
+		if (b3_ws_layout_wins(ws, monitor_area) == 0) {
+			for (i = 0; i < ws->leaf_area_count; i++) {
+				b3_win_set_rect(ws->leaf_win_arr[i], ws->leaf_area_arr[i]);
+				b3_win_batch_add(ws->batch, ws->leaf_win_arr[i], 0);
+			}
+		}
 
 		/*
-		 * Now show all floating windows.
+		 * Now show all floating windows. They are positioned after the tiled
+		 * ones, hence they stay on top.
 		 */
-		CreateThread(NULL,
-					 0,
-					 b3_ws_show_floating_threaded,
-					 (LPVOID) ws,
-					 0,
-					 NULL);
+		array_iter_init(&iter, ws->floating_win_arr);
+		while (array_iter_next(&iter, (void*) &win_iter) != CC_ITER_END) {
+			b3_win_batch_add(ws->batch, win_iter, 1);
+		}
+
+		b3_win_batch_commit(ws->batch);
 	} else {
 		b3_win_set_state(maximized_win, MAXIMIZED);
 	}
@@ -1110,101 +1141,186 @@ b3_ws_arrange_wins_impl(b3_ws_t *ws, RECT monitor_area)
 	return 0;
 }
 
-DWORD WINAPI
-b3_ws_show_floating_threaded(LPVOID param)
+int
+b3_ws_layout_wins_impl(b3_ws_t *ws, RECT monitor_area)
 {
-	b3_ws_t *ws;
-	ArrayIter iter;
-	b3_win_t *win_iter;
+	b3_ws_layout_t layout;
+	int win_count;
+	RECT *leaf_area_arr;
+	b3_win_t **leaf_win_arr;
+
+	layout.error = 0;
+	layout.ws = ws;
+	layout.pending_area_count = 0;
+
+	ws->leaf_area_count = 0;
+
+	win_count = b3_winman_get_win_count(ws->winman);
+	if (win_count > ws->leaf_area_arr_size) {
+		leaf_area_arr = realloc(ws->leaf_area_arr, sizeof(RECT) * win_count);
+		if (leaf_area_arr) {
+			ws->leaf_area_arr = leaf_area_arr;
+		}
 
-	ws = (b3_ws_t *) param;
+		leaf_win_arr = realloc(ws->leaf_win_arr, sizeof(b3_win_t *) * win_count);
+		if (leaf_win_arr) {
+			ws->leaf_win_arr = leaf_win_arr;
+		}
 
-	Sleep(100);
+		if (leaf_area_arr && leaf_win_arr) {
+			ws->leaf_area_arr_size = win_count;
+		} else {
+			wbk_logger_log(&logger, SEVERE, "Unable to grow the layout buffers\n");
+			layout.error = 1;
+		}
+	}
 
-	array_iter_init(&iter, ws->floating_win_arr);
-	while (array_iter_next(&iter, (void*) &win_iter) != CC_ITER_END) {
-		b3_win_show(win_iter, 1);
+	if (!layout.error && win_count > 0) {
+		/**
+		 * The area of the root is pushed by hand. The visitor pops the area of
+		 * every visited window manager.
+		 */
+		if (ws->pending_area_arr_size <= 0) {
+			layout.error = b3_ws_layout_grow_pending(ws, 1);
+		}
+
+		if (!layout.error) {
+			ws->pending_area_arr[0] = monitor_area;
+			layout.pending_area_count = 1;
+
+			b3_winman_traverse_until(ws->winman,
+									 PRE_ORDER,
+									 b3_ws_layout_wins_visitor,
+									 &layout);
+		}
 	}
 
-	return 0;
+	return layout.error;
 }
 
-void
-b3_ws_arrange_wins_visitor(b3_winman_t *winman, void *data)
+int
+b3_ws_layout_grow_pending(b3_ws_t *ws, int min_size)
 {
-	Stack *area_stack;
+	int error;
+	int size;
+	RECT *pending_area_arr;
+
+	error = 0;
+	if (min_size > ws->pending_area_arr_size) {
+		size = ws->pending_area_arr_size * 2;
+		if (size < B3_WS_PENDING_AREA_ARR_MIN_SIZE) {
+			size = B3_WS_PENDING_AREA_ARR_MIN_SIZE;
+		}
+		if (size < min_size) {
+			size = min_size;
+		}
+
+		pending_area_arr = realloc(ws->pending_area_arr, sizeof(RECT) * size);
+		if (pending_area_arr) {
+			ws->pending_area_arr = pending_area_arr;
+			ws->pending_area_arr_size = size;
+		} else {
+			wbk_logger_log(&logger, SEVERE, "Unable to grow the layout buffers\n");
+			error = 1;
+		}
+	}
+
+	return error;
+}
+
+int
+b3_ws_layout_wins_visitor(b3_winman_t *winman, void *data)
+{
+	b3_ws_layout_t *layout;
+	b3_ws_t *ws;
 	b3_win_t *my_win;
-	int current_pos;
+	RECT my_area;
+	RECT *child_area;
+	b3_winman_mode_t mode;
+	int length;
 	int increment;
+	int remainder;
+	int current_pos;
+	int child_length;
 	int size;
 	int i;
-	RECT *my_area;
-	RECT *child_area;
 
-	area_stack = (Stack *) data;
-	my_area = NULL;
-	stack_pop(area_stack, (void *) &my_area);
+	layout = (b3_ws_layout_t *) data;
+	ws = layout->ws;
+
+	/**
+	 * Every visited window manager has its area pushed by its parent (or by
+	 * b3_ws_layout_wins_impl() for the root).
+	 */
+	layout->pending_area_count--;
+	my_area = ws->pending_area_arr[layout->pending_area_count];
 
 	my_win = b3_winman_get_win(winman);
 	if (my_win == NULL) {
 		/**
 		 * Inner node containing only leaves
-		 *
-		 * my_area will be modified by the for loop.
 		 */
 
 		size = array_size(b3_winman_get_winman_arr(winman));
 		if (size > 0) {
-			if (b3_winman_get_mode(winman) == HORIZONTAL) {
-				increment = (my_area->right - my_area->left) / size;
-			} else if (b3_winman_get_mode(winman) == VERTICAL) {
-				increment = (my_area->bottom - my_area->top) / size;
-			}
+			layout->error = b3_ws_layout_grow_pending(ws, layout->pending_area_count + size);
+		}
 
-			if (b3_winman_get_mode(winman) == HORIZONTAL) {
-				current_pos = my_area->right;
-			} else if (b3_winman_get_mode(winman) == VERTICAL) {
-				current_pos = my_area->bottom;
+		if (!layout->error && size > 0) {
+			mode = b3_winman_get_mode(winman);
+			if (mode == VERTICAL) {
+				length = my_area.bottom - my_area.top;
+				current_pos = my_area.bottom;
+			} else {
+				length = my_area.right - my_area.left;
+				current_pos = my_area.right;
 			}
 
+			increment = length / size;
+			remainder = length % size;
+
 			/**
-			 * The right/top most areas have to be added first, since the stack
-			 * later will be popped the other way around. Thus start from
-			 * left/bottom would place the windows in the reverse (wrong) order
-			 * on the screen.
+			 * The right/bottom most areas have to be pushed first, since the
+			 * traversal will pop them the other way around. The first
+			 * remainder children (on the screen) are one pixel larger, hence
+			 * the areas exactly cover my_area.
 			 */
+			for (i = size - 1; i >= 0; i--) {
+				child_length = increment;
+				if (i < remainder) {
+					child_length++;
+				}
 
-			for (i = 0; i < size; i++) {
-				child_area = malloc(sizeof(RECT));
-				child_area->top = my_area->top;
-				child_area->bottom = my_area->bottom;
-				child_area->left = my_area->left;
-				child_area->right = my_area->right;
-
-				current_pos -= increment;
-				if (b3_winman_get_mode(winman) == HORIZONTAL) {
-					child_area->left = current_pos;
-					child_area->right = child_area->left + increment;
-				} else if (b3_winman_get_mode(winman) == VERTICAL) {
-					child_area->top = current_pos;
-					child_area->bottom = child_area->top + increment;
+				child_area = &(ws->pending_area_arr[layout->pending_area_count]);
+				*child_area = my_area;
+
+				if (mode == VERTICAL) {
+					child_area->bottom = current_pos;
+					child_area->top = current_pos - child_length;
+				} else {
+					child_area->right = current_pos;
+					child_area->left = current_pos - child_length;
 				}
 
-				stack_push(area_stack, (void *) child_area);
+				current_pos -= child_length;
+				layout->pending_area_count++;
 			}
 		}
 	} else {
 		/**
 		 * Leaf containing only a window
 		 */
-		b3_win_set_rect(my_win, *my_area);
-		b3_win_show(my_win, 0);
+		if (ws->leaf_area_count < ws->leaf_area_arr_size) {
+			ws->leaf_area_arr[ws->leaf_area_count] = my_area;
+			ws->leaf_win_arr[ws->leaf_area_count] = my_win;
+			ws->leaf_area_count++;
+		} else {
+			wbk_logger_log(&logger, SEVERE, "The window count of the tree is out of sync\n");
+			layout->error = 1;
+		}
 	}
 
-	if (my_area) {
-		free(my_area);
-		my_area = NULL;
-	}
+	return layout->error;
 }
 
 b3_win_t *
@@ -1212,3 +1328,167 @@ b3_ws_get_win_at_pos_impl(b3_ws_t *ws, POINT *position)
 {
 	return b3_winman_get_win_at_pos(ws->winman, position);
 }
+
+int
+b3_ws_push_previously_focused(b3_ws_t *ws, const b3_win_t *win)
+{
+	int error;
+	int size;
+	b3_win_handle_t handle;
+	b3_win_handle_t *previously_focused_arr;
+
+	error = 0;
+	handle = b3_win_get_handle((b3_win_t *) win);
+	if (handle == B3_WIN_HANDLE_NULL) {
+		error = 1;
+	} else if (ws->previously_focused_count == 0
+			   || ws->previously_focused_arr[ws->previously_focused_count - 1] != handle) {
+		if (ws->previously_focused_count == ws->previously_focused_arr_size) {
+			size = ws->previously_focused_arr_size * 2;
+			if (size < B3_WS_PREVIOUSLY_FOCUSED_ARR_MIN_SIZE) {
+				size = B3_WS_PREVIOUSLY_FOCUSED_ARR_MIN_SIZE;
+			}
+
+			previously_focused_arr = realloc(ws->previously_focused_arr,
+											 sizeof(b3_win_handle_t) * size);
+			if (previously_focused_arr) {
+				ws->previously_focused_arr = previously_focused_arr;
+				ws->previously_focused_arr_size = size;
+			} else {
+				error = 1;
+			}
+		}
+
+		if (!error) {
+			ws->previously_focused_arr[ws->previously_focused_count] = handle;
+			ws->previously_focused_count++;
+		}
+	}
+
+	return error;
+}
+
+int
+b3_ws_remove_previously_focused(b3_ws_t *ws, const b3_win_t *win)
+{
+	b3_win_handle_t handle;
+	int i;
+	int length;
+
+	handle = b3_win_get_handle((b3_win_t *) win);
+
+	/**
+	 * Neighbours that become equal by the removal are merged.
+	 */
+	length = 0;
+	for (i = 0; i < ws->previously_focused_count; i++) {
+		if (ws->previously_focused_arr[i] != handle
+			&& (length == 0
+				|| ws->previously_focused_arr[length - 1] != ws->previously_focused_arr[i])) {
+			ws->previously_focused_arr[length] = ws->previously_focused_arr[i];
+			length++;
+		}
+	}
+	ws->previously_focused_count = length;
+
+	return 0;
+}
+
+b3_win_t *
+b3_ws_pop_previously_focused(b3_ws_t *ws)
+{
+	b3_win_t *win;
+
+	win = NULL;
+	while (win == NULL && ws->previously_focused_count > 0) {
+		ws->previously_focused_count--;
+		win = b3_win_from_handle(ws->previously_focused_arr[ws->previously_focused_count]);
+	}
+
+	return win;
+}
+
+HashTable *
+b3_ws_win_table_new(void)
+{
+	HashTableConf conf;
+	HashTable *table;
+
+	hashtable_conf_init(&conf);
+	conf.hash = POINTER_HASH;
+	conf.key_compare = cc_common_cmp_ptr;
+	conf.key_length = KEY_LENGTH_POINTER;
+
+	table = NULL;
+	hashtable_new_conf(&conf, &table);
+
+	return table;
+}
+
+b3_winman_t *
+b3_ws_get_winman_of_win(b3_ws_t *ws, const b3_win_t *win)
+{
+	b3_winman_t *winman;
+
+	winman = NULL;
+	if (win) {
+		hashtable_get(ws->winman_table,
+					  b3_win_get_window_handler((b3_win_t *) win),
+					  (void *) &winman);
+	}
+
+	return winman;
+}
+
+b3_win_t *
+b3_ws_get_floating_win(b3_ws_t *ws, const b3_win_t *win)
+{
+	b3_win_t *found;
+
+	found = NULL;
+	if (win) {
+		hashtable_get(ws->floating_win_table,
+					  b3_win_get_window_handler((b3_win_t *) win),
+					  (void *) &found);
+	}
+
+	return found;
+}
+
+int
+b3_ws_reorg_path(b3_ws_t *ws, b3_winman_t *winman)
+{
+	int error;
+#ifdef DEBUG_ENABLED
+	int count_before;
+	int count_after;
+#endif
+
+	error = 1;
+	if (winman) {
+		error = b3_winman_reorg_path(ws->winman, winman);
+	}
+
+#ifdef DEBUG_ENABLED
+	count_before = 0;
+	b3_winman_traverse(ws->winman, b3_ws_count_winman_visitor, &count_before);
+	b3_winman_reorg(ws->winman);
+	count_after = 0;
+	b3_winman_traverse(ws->winman, b3_ws_count_winman_visitor, &count_after);
+	if (count_before != count_after) {
+		wbk_logger_log(&logger, SEVERE,
+					   "Path re-organization missed %d empty window manager(s)\n",
+					   count_before - count_after);
+	}
+#endif
+
+	return error;
+}
+
+#ifdef DEBUG_ENABLED
+void
+b3_ws_count_winman_visitor(b3_winman_t *winman, void *data)
+{
+	(*((int *) data))++;
+}
+#endif
@@ -32,11 +32,13 @@
 #define B3_WS_H
 
 #include <collectc/array.h>
+#include <collectc/hashtable.h>
 #include <windows.h>
 
 #include "til.h"
 #include "counter.h"
 #include "winman.h"
+#include "winman_factory.h"
 #include "win.h"
 
 typedef enum b3_ws_move_direction_s
@@ -67,10 +69,16 @@ struct b3_ws_s {
 												   b3_ws_move_direction_t direction,
 												   char rolling);
 	int (*b3_ws_arrange_wins)(b3_ws_t *ws, RECT monitor_area);
+	int (*b3_ws_layout_wins)(b3_ws_t *ws, RECT monitor_area);
 	b3_win_t *(*b3_ws_get_win_at_pos)(b3_ws_t *ws, POINT *position);
 
 	b3_winman_t *winman;
 
+	/**
+	 * Owns all window managers of winman.
+	 */
+	b3_winman_factory_t *winman_factory;
+
 	b3_til_mode_t mode;
 
 	char *name;
@@ -87,17 +95,19 @@ struct b3_ws_s {
 	b3_win_t *focused_win_tree;
 
 	/**
-	 * Array of b3_win_t *
-	 *
-	 * Stack containing the previously focused windows. If a window is removed,
-	 * then it is also removed from the previously focused windows.
+	 * Stack containing the handles of the previously focused windows. If a
+	 * window is removed, then it is also removed from the previously focused
+	 * windows. Handles of windows freed meanwhile resolve to NULL and are
+	 * skipped.
 	 *
 	 * It also only contains windows that are actually managed by one of the
 	 * following members:
 	 * - floating_win_arr
 	 * - winman
 	 */
-	Array *previously_focused_win_arr;
+	b3_win_handle_t *previously_focused_arr;
+	int previously_focused_arr_size;
+	int previously_focused_count;
 
 	/**
 	 * Array of b3_win_t *
@@ -105,6 +115,44 @@ struct b3_ws_s {
 	 * Array containing the floating windows.
 	 */
 	Array *floating_win_arr;
+
+	/**
+	 * HashTable of HWND -> b3_winman_t *
+	 *
+	 * Index of the leaves of winman by the window handler of their window.
+	 */
+	HashTable *winman_table;
+
+	/**
+	 * HashTable of HWND -> b3_win_t *
+	 *
+	 * Index of floating_win_arr by the window handler of the windows.
+	 */
+	HashTable *floating_win_table;
+
+	/**
+	 * Work stack of the layout pass containing the areas of the window
+	 * managers not yet visited. It is reused by every layout pass and only
+	 * grows if the tree needs more entries.
+	 */
+	RECT *pending_area_arr;
+	int pending_area_arr_size;
+
+	/**
+	 * Result of the last layout pass. Entry i of leaf_area_arr is the area of
+	 * the window leaf_win_arr[i], where i is the position of its leaf in the
+	 * traversal of winman. Both are reused by every layout pass.
+	 */
+	RECT *leaf_area_arr;
+	b3_win_t **leaf_win_arr;
+	int leaf_area_arr_size;
+	int leaf_area_count;
+
+	/**
+	 * Collects the positions of all windows of one b3_ws_arrange_wins(). They
+	 * are committed at once to b3_win_batch_queue().
+	 */
+	b3_win_batch_t *batch;
 };
 
 /**
@@ -243,6 +291,19 @@ b3_ws_get_win_rel_to_focused_win(b3_ws_t *ws,
 extern int
 b3_ws_arrange_wins(b3_ws_t *ws, RECT monitor_area);
 
+/**
+ * Computes the areas of all windows of the window tree without showing them.
+ * The result is stored in leaf_area_arr and leaf_win_arr. The areas exactly
+ * cover monitor_area: the pixels left over by a split are distributed one by
+ * one to the first children.
+ *
+ * No memory is allocated, unless the tree grew since the last layout pass.
+ *
+ * @return 0 if the layout pass was successful. Non-0 otherwise.
+ */
+extern int
+b3_ws_layout_wins(b3_ws_t *ws, RECT monitor_area);
+
 /**
  * @return Returns the window at position. If no window can be found at the
  * given position, then NULL is returned.
@@ -318,16 +318,18 @@ b3_wsman_remove_empty_ws(b3_wsman_t *wsman)
   while (i < len) {
     array_get_at(b3_wsman_get_ws_arr(wsman), i, (void *) &ws);
 
-    if (b3_wsman_get_focused_ws(wsman) != ws && b3_ws_get_focused_win(ws) == NULL) {
+    if (b3_wsman_get_focused_ws(wsman) != ws && b3_ws_is_empty(ws)) {
 			b3_wsman_remove(wsman, b3_ws_get_name(ws));
 			b3_ws_factory_remove(wsman->ws_factory, b3_ws_get_name(ws));
       ws = NULL;
 
-      i = -1;
+      /**
+       * The next workspace moved to position i.
+       */
       len = array_size(b3_wsman_get_ws_arr(wsman));
-		}
-
-    i++;
+		} else {
+      i++;
+    }
   }
 
 	ReleaseMutex(wsman->global_mutex);
@@ -32,6 +32,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <w32bindkeys/logger.h>
 
 static wbk_logger_t logger = { "test" };
@@ -93,3 +94,24 @@ b3_test_check_int(int act, int exp, char *msg)
 
 	return error;
 }
+
+int
+b3_test_check_str(const char *act, const char *exp, char *msg)
+{
+	int error;
+
+	if (act == NULL || exp == NULL) {
+		error = act != exp;
+		if (error) {
+			wbk_logger_log(&logger, SEVERE, "exp(%s) != act(%s): %s\n",
+						   exp ? exp : "NULL", act ? act : "NULL", msg);
+		}
+	} else if (strcmp(act, exp) == 0) {
+		error = 0;
+	} else {
+		error = 1;
+		wbk_logger_log(&logger, SEVERE, "exp(%s) != act(%s): %s\n", exp, act, msg);
+	}
+
+	return error;
+}
@@ -47,6 +47,9 @@ b3_test_check_void(void *act, void *exp, char *msg);
 extern int
 b3_test_check_int(int act, int exp, char *msg);
 
+extern int
+b3_test_check_str(const char *act, const char *exp, char *msg);
+
 #endif // B3_TEST_H
 
 
@@ -0,0 +1,583 @@
+/******************************************************************************
+  This file is part of b3.
+
+  Copyright 2020-2021 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * @author Richard Bäck <richard.baeck@mailbox.org>
+ * @date 2021-04-17
+ * @brief File contains the tests for the director class
+ */
+
+#include "../src/director.h"
+
+#include "test.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/ws_factory.h"
+#include "../src/wsman_factory.h"
+#include "../src/monitor_factory.h"
+#include "../src/rule.h"
+#include "../src/title_condition.h"
+#include "../src/mwtw_action.h"
+#include "../src/rule_index.h"
+
+#define ARRANGE_REQUEST_COUNT 10
+#define RULE_COUNT 200
+#define RULE_WIN_COUNT 100
+
+static b3_director_t *g_director;
+
+/**
+ * Fake window system. The title of a window is "Window " and its handler.
+ */
+static int
+fake_reader(HWND window_handler, b3_win_attr_t *attr)
+{
+	memset(attr, 0, sizeof(b3_win_attr_t));
+	sprintf(attr->title, "Window %d", (int) (INT_PTR) window_handler);
+
+	return 0;
+}
+
+static void
+setup(void)
+{
+	g_director = b3_director_new(NULL);
+}
+
+static void
+teardown(void)
+{
+	b3_director_free(g_director);
+	g_director = NULL;
+}
+
+static int
+test_arrange_without_arranger(void)
+{
+	int error;
+	int i;
+
+	error = 0;
+	for (i = 0; !error && i < ARRANGE_REQUEST_COUNT; i++) {
+		error = b3_director_arrange_wins(g_director);
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_director->arrange_perform_count, ARRANGE_REQUEST_COUNT, "Requests were not arranged immediately.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_director->layout_dirty, 0, "Layout is still dirty.");
+	}
+
+	return error;
+}
+
+static int
+test_arrange_coalesced(void)
+{
+	int error;
+	int i;
+
+	/**
+	 * Make sure the whole burst is requested before the arranger wakes up.
+	 */
+	g_director->arrange_delay = 200;
+	error = b3_director_start_arranger(g_director);
+
+	for (i = 0; !error && i < ARRANGE_REQUEST_COUNT; i++) {
+		error = b3_director_arrange_wins(g_director);
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_director->arrange_request_count, ARRANGE_REQUEST_COUNT, "Unexpected count of requested arrangements.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_director->arrange_perform_count, 0, "Arrangement was not deferred.");
+	}
+
+	if (!error) {
+		error = b3_director_stop_arranger(g_director);
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_director->arrange_perform_count, 1, "Requests were not coalesced into one arrangement.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_director->layout_dirty, 0, "Layout is still dirty.");
+	}
+
+	return error;
+}
+
+static int
+test_arrange_monitor(void)
+{
+	int error;
+	b3_monitor_t *monitor_a;
+	b3_monitor_t *monitor_b;
+	b3_monitor_t *monitor_c;
+
+	/**
+	 * The monitors are never arranged, only marked. So fake ones are enough.
+	 */
+	monitor_a = (b3_monitor_t *) 1;
+	monitor_b = (b3_monitor_t *) 2;
+	monitor_c = (b3_monitor_t *) 3;
+	array_add(g_director->monitor_arr, monitor_a);
+	array_add(g_director->monitor_arr, monitor_b);
+	array_add(g_director->monitor_arr, monitor_c);
+
+	g_director->arrange_delay = 200;
+	error = b3_director_start_arranger(g_director);
+
+	if (!error) {
+		b3_director_arrange_monitor(g_director, monitor_b);
+		b3_director_arrange_monitor(g_director, monitor_b);
+		b3_director_arrange_monitor(g_director, monitor_c);
+
+		error = b3_test_check_int(array_size(g_director->dirty_monitor_arr), 2, "Unexpected count of dirty monitors.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(array_contains(g_director->dirty_monitor_arr, monitor_a), 0, "Untouched monitor is dirty.");
+	}
+
+	if (!error) {
+		b3_director_arrange_wins(g_director);
+
+		error = b3_test_check_int(array_size(g_director->dirty_monitor_arr), 3, "Not all monitors are dirty.");
+	}
+
+	/**
+	 * Forget the requests before the arranger flushes them.
+	 */
+	WaitForSingleObject(g_director->global_mutex, INFINITE);
+	array_remove_all(g_director->dirty_monitor_arr);
+	g_director->layout_dirty = 0;
+	ReleaseMutex(g_director->global_mutex);
+
+	b3_director_stop_arranger(g_director);
+	array_remove_all(g_director->monitor_arr);
+
+	return error;
+}
+
+static int
+test_find_win(void)
+{
+	int error;
+	RECT area;
+	b3_ws_factory_t *ws_factory;
+	b3_wsman_factory_t *wsman_factory;
+	b3_monitor_factory_t *monitor_factory;
+	b3_monitor_t *monitor_a;
+	b3_monitor_t *monitor_b;
+	b3_monitor_t *monitor;
+	b3_ws_t *ws;
+	b3_win_t *win1;
+	b3_win_t *win2;
+
+	ws_factory = b3_ws_factory_new();
+	wsman_factory = b3_wsman_factory_new(ws_factory);
+	monitor_factory = b3_monitor_factory_new(wsman_factory);
+
+	area.top = 0;
+	area.left = 0;
+	area.bottom = 600;
+	area.right = 800;
+	monitor_a = b3_monitor_factory_create(monitor_factory, "A", area, NULL);
+	area.left = 800;
+	area.right = 1600;
+	monitor_b = b3_monitor_factory_create(monitor_factory, "B", area, NULL);
+	array_add(g_director->monitor_arr, monitor_a);
+	array_add(g_director->monitor_arr, monitor_b);
+	g_director->focused_monitor = monitor_a;
+
+	win1 = b3_win_new((HWND) 1, 0);
+	win2 = b3_win_new((HWND) 2, 0);
+
+	error = b3_director_add_win(g_director, "A", win1);
+
+	if (!error) {
+		error = b3_director_add_win(g_director, "B", win2);
+	}
+
+	if (!error) {
+		ws = b3_director_find_win(g_director, win2, &monitor);
+		error = b3_test_check_int(ws == b3_monitor_get_focused_ws(monitor_b), 1, "Window was found on the wrong workspace.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(monitor == monitor_b, 1, "Window was found on the wrong monitor.");
+	}
+
+	if (!error) {
+		error = b3_director_move_win_to_ws(g_director, win1, "3");
+	}
+
+	if (!error) {
+		ws = b3_director_find_win(g_director, win1, &monitor);
+		error = b3_test_check_int(ws != NULL, 1, "Moved window was not found.");
+	}
+
+	if (!error) {
+		error = b3_test_check_str(b3_ws_get_name(ws), "3", "Moved window was not found on its new workspace.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(monitor == monitor_a, 1, "Moved window was found on the wrong monitor.");
+	}
+
+	if (!error) {
+		error = b3_director_remove_win(g_director, win1);
+	}
+
+	if (!error) {
+		error = b3_test_check_int(b3_director_find_win(g_director, win1, NULL) == NULL, 1, "Removed window was found.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(hashtable_size(g_director->win_location_table), 1, "Removed window is still indexed.");
+	}
+
+	b3_director_remove_win(g_director, win2);
+	array_remove_all(g_director->monitor_arr);
+	g_director->focused_monitor = NULL;
+
+	b3_win_free(win1);
+	b3_win_free(win2);
+
+	b3_monitor_factory_free(monitor_factory);
+	b3_wsman_factory_free(wsman_factory);
+	b3_ws_factory_free(ws_factory);
+
+	return error;
+}
+
+static int
+test_arrange_flush(void)
+{
+	int error;
+
+	error = b3_director_flush_arrange(g_director);
+
+	if (!error) {
+		error = b3_test_check_int(g_director->arrange_perform_count, 0, "Arranged without request.");
+	}
+
+	return error;
+}
+
+static b3_ws_factory_t *g_ws_factory;
+static b3_wsman_factory_t *g_wsman_factory;
+static b3_monitor_factory_t *g_monitor_factory;
+
+/**
+ * Adds the focused monitor "A" to the director.
+ */
+static void
+add_fake_monitor(void)
+{
+	RECT area;
+	b3_monitor_t *monitor;
+
+	g_ws_factory = b3_ws_factory_new();
+	g_wsman_factory = b3_wsman_factory_new(g_ws_factory);
+	g_monitor_factory = b3_monitor_factory_new(g_wsman_factory);
+
+	area.top = 0;
+	area.left = 0;
+	area.bottom = 600;
+	area.right = 800;
+	monitor = b3_monitor_factory_create(g_monitor_factory, "A", area, NULL);
+	array_add(g_director->monitor_arr, monitor);
+	g_director->focused_monitor = monitor;
+}
+
+static void
+remove_fake_monitor(void)
+{
+	array_remove_all(g_director->monitor_arr);
+	g_director->focused_monitor = NULL;
+
+	b3_monitor_factory_free(g_monitor_factory);
+	b3_wsman_factory_free(g_wsman_factory);
+	b3_ws_factory_free(g_ws_factory);
+}
+
+/**
+ * Copy of b3_director_add_win() from before the rules were found outside of
+ * the director lock. It searches and evaluates the rules while the director
+ * is locked. Only used to compare the lock time.
+ *
+ * @param lock_ticks Incremented by the performance counter ticks the director
+ * was locked.
+ */
+static int
+add_win_find_rules_locked(b3_director_t *director, const char *monitor_name, b3_win_t *win, LONGLONG *lock_ticks)
+{
+	ArrayIter iter;
+	b3_monitor_t *monitor;
+	b3_rule_index_entry_t *entry;
+	Array *entry_arr;
+	LARGE_INTEGER start;
+	LARGE_INTEGER end;
+	char found;
+	int error;
+
+	array_new(&entry_arr);
+
+	WaitForSingleObject(director->global_mutex, INFINITE);
+	QueryPerformanceCounter(&start);
+
+	found = 0;
+	array_iter_init(&iter, director->monitor_arr);
+	while (!found && array_iter_next(&iter, (void *) &monitor) != CC_ITER_END) {
+		found = strcmp(b3_monitor_get_monitor_name(monitor), monitor_name) == 0;
+	}
+
+	error = 1;
+	if (found) {
+		error = b3_monitor_add_win(monitor, win);
+
+		WaitForSingleObject(director->rule_mutex, INFINITE);
+		b3_rule_index_find_candidate_entries(director->rule_index, director, win, entry_arr);
+		ReleaseMutex(director->rule_mutex);
+
+		array_iter_init(&iter, entry_arr);
+		while (array_iter_next(&iter, (void *) &entry) != CC_ITER_END) {
+			if (entry->decided || b3_rule_applies(entry->rule, director, win)) {
+				b3_rule_exec(entry->rule, director, win);
+			}
+		}
+	}
+
+	if (!error) {
+		b3_director_arrange_monitor(director, monitor);
+	}
+
+	QueryPerformanceCounter(&end);
+	*lock_ticks += end.QuadPart - start.QuadPart;
+
+	ReleaseMutex(director->global_mutex);
+
+	array_destroy(entry_arr);
+
+	return error;
+}
+
+/**
+ * Adds RULE_WIN_COUNT windows, checks that their rules were executed and
+ * removes them again.
+ *
+ * @param find_rules_locked Non-0 to add the windows by
+ * add_win_find_rules_locked() instead of b3_director_add_win().
+ * @param lock_us Set to the microseconds per window the director was locked.
+ * Only measured for b3_director_add_win() in debug builds.
+ * @param add_us Set to the microseconds per window adding took.
+ */
+static int
+add_rule_wins(char find_rules_locked, double *lock_us, double *add_us)
+{
+	int error;
+	b3_win_t *win_arr[RULE_WIN_COUNT];
+	b3_ws_t *ws;
+	LARGE_INTEGER frequency;
+	LARGE_INTEGER start;
+	LARGE_INTEGER end;
+	LONGLONG add_win_ticks;
+	LONGLONG lock_ticks;
+	int i;
+
+#ifdef DEBUG_ENABLED
+	g_director->add_win_lock_ticks = 0;
+	g_director->add_win_count = 0;
+#endif
+
+	error = 0;
+	add_win_ticks = 0;
+	lock_ticks = 0;
+	QueryPerformanceFrequency(&frequency);
+	for (i = 0; i < RULE_WIN_COUNT; i++) {
+		win_arr[i] = b3_win_new((HWND) (INT_PTR) i, 0);
+
+		QueryPerformanceCounter(&start);
+		if (!error && find_rules_locked) {
+			error = add_win_find_rules_locked(g_director, "A", win_arr[i], &lock_ticks);
+		} else if (!error) {
+			error = b3_director_add_win(g_director, "A", win_arr[i]);
+		}
+		QueryPerformanceCounter(&end);
+		add_win_ticks += end.QuadPart - start.QuadPart;
+	}
+
+#ifdef DEBUG_ENABLED
+	if (!error && !find_rules_locked) {
+		lock_ticks = g_director->add_win_lock_ticks;
+		error = b3_test_check_int(g_director->add_win_count, RULE_WIN_COUNT, "Not all windows were added.");
+	}
+#endif
+
+	*lock_us = (double) lock_ticks * 1000000.0 / (double) frequency.QuadPart / RULE_WIN_COUNT;
+	*add_us = (double) add_win_ticks * 1000000.0 / (double) frequency.QuadPart / RULE_WIN_COUNT;
+
+	for (i = 0; !error && i < RULE_WIN_COUNT; i++) {
+		ws = b3_director_find_win(g_director, win_arr[i], NULL);
+		error = b3_test_check_int(ws != NULL && atoi(b3_ws_get_name(ws)) == i % 2 + 1, 1, "Rule was not executed.");
+	}
+
+	for (i = 0; i < RULE_WIN_COUNT; i++) {
+		b3_director_remove_win(g_director, win_arr[i]);
+		b3_win_free(win_arr[i]);
+	}
+
+	return error;
+}
+
+/**
+ * Every window gets a rule moving it to a workspace. Other rules never apply.
+ * The windows are added once with a copy of the old b3_director_add_win(),
+ * which found the rules while the director was locked, and once with the
+ * current one. The lock times are only printed in debug builds.
+ */
+static int
+test_add_win_rules(void)
+{
+	int error;
+	char pattern[32];
+	char *ws_id;
+	double locked_lock_us;
+	double locked_add_us;
+	double lock_us;
+	double add_us;
+	int i;
+
+	b3_win_set_attr_reader(fake_reader);
+	add_fake_monitor();
+
+	for (i = 0; i < RULE_COUNT; i++) {
+		sprintf(pattern, "^Window %d$", i);
+		ws_id = malloc(sizeof(char) * 2);
+		sprintf(ws_id, "%d", i % 2 + 1);
+		b3_director_add_rule(g_director,
+							 b3_rule_new((b3_condition_t *) b3_title_condition_new(pattern),
+										 (b3_action_t *) b3_mwtw_action_new(ws_id)));
+	}
+	b3_director_compile_rules(g_director);
+
+	/**
+	 * Like in b3 the arranger arranges the windows, not b3_director_add_win().
+	 */
+	error = b3_director_start_arranger(g_director);
+
+	if (!error) {
+		error = add_rule_wins(1, &locked_lock_us, &locked_add_us);
+	}
+
+	if (!error) {
+		error = add_rule_wins(0, &lock_us, &add_us);
+	}
+
+	b3_director_stop_arranger(g_director);
+
+#ifdef DEBUG_ENABLED
+	if (!error) {
+		fprintf(stdout, "%d windows, %d rules, rules found while locked: lock held %8.1f us of %8.1f us per window\n",
+				RULE_WIN_COUNT, RULE_COUNT, locked_lock_us, locked_add_us);
+		fprintf(stdout, "%d windows, %d rules, rules found before locking: lock held %8.1f us of %8.1f us per window\n",
+				RULE_WIN_COUNT, RULE_COUNT, lock_us, add_us);
+	}
+#endif
+
+	remove_fake_monitor();
+	b3_win_set_attr_reader(NULL);
+
+	return error;
+}
+
+/**
+ * The focused window used by a rule is the added window itself, since it is
+ * focused before the rules are evaluated.
+ */
+static int
+test_add_win_focused(void)
+{
+	int error;
+	b3_win_t *win_arr[2];
+	b3_ws_t *ws;
+	char *ws_id;
+	int i;
+
+	b3_win_set_attr_reader(fake_reader);
+	add_fake_monitor();
+
+	ws_id = malloc(sizeof(char) * 2);
+	strcpy(ws_id, "2");
+	b3_director_add_rule(g_director,
+						 b3_rule_new((b3_condition_t *) b3_title_condition_new(B3_PATTERN_CONDITION_PATTERN_FOCUSED),
+									 (b3_action_t *) b3_mwtw_action_new(ws_id)));
+
+	error = 0;
+	for (i = 0; i < 2; i++) {
+		win_arr[i] = b3_win_new((HWND) (INT_PTR) i, 0);
+		if (!error) {
+			error = b3_director_add_win(g_director, "A", win_arr[i]);
+		}
+	}
+
+	for (i = 0; !error && i < 2; i++) {
+		ws = b3_director_find_win(g_director, win_arr[i], NULL);
+		error = b3_test_check_int(ws != NULL && strcmp(b3_ws_get_name(ws), "2") == 0, 1, "Rule did not see the added window as focused.");
+	}
+
+	for (i = 0; i < 2; i++) {
+		b3_director_remove_win(g_director, win_arr[i]);
+		b3_win_free(win_arr[i]);
+	}
+
+	remove_fake_monitor();
+	b3_win_set_attr_reader(NULL);
+
+	return error;
+}
+
+int
+main(void)
+{
+	b3_test(setup, teardown, test_arrange_without_arranger, "test_arrange_without_arranger");
+	b3_test(setup, teardown, test_arrange_coalesced, "test_arrange_coalesced");
+	b3_test(setup, teardown, test_arrange_monitor, "test_arrange_monitor");
+	b3_test(setup, teardown, test_arrange_flush, "test_arrange_flush");
+	b3_test(setup, teardown, test_find_win, "test_find_win");
+	b3_test(setup, teardown, test_add_win_rules, "test_add_win_rules");
+	b3_test(setup, teardown, test_add_win_focused, "test_add_win_focused");
+
+	return 0;
+}
@@ -41,6 +41,7 @@
 #include "../src/kc_director_factory.h"
 #include "../src/condition_factory.h"
 #include "../src/action_factory.h"
+#include "../src/win_event_queue.h"
 
 static wbk_datafinder_t *g_datafinder;
 
@@ -135,6 +136,108 @@ test_parse_str_rules(void)
 	return 0;
 }
 
+static int
+test_parse_str_no_manage(void)
+{
+	wbk_kbman_t *kbman;
+	char config[] = "no_manage [class=\"Shell_TrayWnd\"]\n"
+			        "no_manage [title=\"Picture-in-Picture\"]\n";
+
+	kbman = b3_parser_parse_str(g_parser, g_director, config);
+
+	if (kbman == NULL) {
+		return 1;
+	}
+
+	wbk_kbman_free(kbman);
+
+	if (!b3_director_is_class_excluded(g_director, "Shell_TrayWnd")) {
+		return 1;
+	}
+
+	if (!b3_director_is_title_excluded(g_director, "Picture-in-Picture")) {
+		return 1;
+	}
+
+	if (b3_director_is_class_excluded(g_director, "Picture-in-Picture")) {
+		return 1;
+	}
+
+	return 0;
+}
+
+static int
+test_parse_str_new_window_grace_period(void)
+{
+	wbk_kbman_t *kbman;
+	char config[] = "new_window_grace_period 250\n";
+
+	if (b3_director_get_new_win_grace_period(g_director) != B3_WIN_EVENT_QUEUE_GRACE_PERIOD) {
+		return 1;
+	}
+
+	kbman = b3_parser_parse_str(g_parser, g_director, config);
+
+	if (kbman == NULL) {
+		return 1;
+	}
+
+	wbk_kbman_free(kbman);
+
+	if (b3_director_get_new_win_grace_period(g_director) != 250) {
+		return 1;
+	}
+
+	return 0;
+}
+
+static int
+test_parse_str_new_window_grace_period_invalid(void)
+{
+	wbk_kbman_t *kbman;
+	char *config_arr[] = {
+		"new_window_grace_period -1\n",
+		"new_window_grace_period abc\n",
+		"new_window_grace_period 250ms\n",
+		"new_window_grace_period 10001\n",
+		"new_window_grace_period 99999999999999999999\n",
+		NULL
+	};
+	int i;
+
+	for (i = 0; config_arr[i]; i++) {
+		kbman = b3_parser_parse_str(g_parser, g_director, config_arr[i]);
+
+		if (kbman != NULL) {
+			wbk_kbman_free(kbman);
+			return 1;
+		}
+
+		if (b3_director_get_new_win_grace_period(g_director) != B3_WIN_EVENT_QUEUE_GRACE_PERIOD) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static int
+test_parse_str_new_window_grace_period_in_text(void)
+{
+	wbk_kbman_t *kbman;
+	char config[] = "for_window [title=\"new_window_grace_period\"] floating enable\n";
+
+	kbman = b3_parser_parse_str(g_parser, g_director, config);
+
+	if (kbman == NULL) {
+		return 1;
+	}
+
+	wbk_kbman_free(kbman);
+
+	return 0;
+}
+
 static int
 test_parse_str(void)
 {
@@ -249,6 +352,10 @@ main(void)
 	b3_test(setup, teardown, test_parse_str_empty, "test_parse_str_empty");
 	b3_test(setup, teardown, test_parse_str_none, "test_parse_str_none");
 	b3_test(setup, teardown, test_parse_str_rules, "test_parse_str_rules");
+	b3_test(setup, teardown, test_parse_str_no_manage, "test_parse_str_no_manage");
+	b3_test(setup, teardown, test_parse_str_new_window_grace_period, "test_parse_str_new_window_grace_period");
+	b3_test(setup, teardown, test_parse_str_new_window_grace_period_invalid, "test_parse_str_new_window_grace_period_invalid");
+	b3_test(setup, teardown, test_parse_str_new_window_grace_period_in_text, "test_parse_str_new_window_grace_period_in_text");
 	b3_test(setup, teardown, test_parse_str, "test_parse_str");
 	b3_test(setup, teardown, test_parse_file_empty, "test_parse_file_empty");
 	b3_test(setup, teardown, test_parse_file_none, "test_parse_file_none");
@@ -0,0 +1,324 @@
+/******************************************************************************
+  This file is part of b3.
+
+  Copyright 2020-2021 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+
+/**
+ * @author Richard Bäck <richard.baeck@mailbox.org>
+ * @date 2021-04-17
+ * @brief File contains the tests for the pattern condition class
+ */
+
+#include "../src/pattern_condition.h"
+
+#include "test.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <windows.h>
+
+#include "../src/title_condition.h"
+#include "../src/utils.h"
+
+#define BENCHMARK_MATCH_COUNT 1000000
+
+static char g_fake_title_arr[2][B3_WIN_ATTR_LENGTH];
+
+/**
+ * A pattern of every kind.
+ */
+static const char *g_kind_pattern_arr[] = {
+	"^Mozilla Firefox$",
+	"^Untitled",
+	"- Notepad$",
+	".*Microsoft Teams.*",
+	"(Fire|Thunder)(fox|bird)"
+};
+
+static const char *g_subject_arr[] = {
+	"Mozilla Firefox",
+	"Untitled - Notepad",
+	"Chat | Microsoft Teams",
+	"Inbox - Mozilla Thunderbird",
+	"C:\\Windows\\system32\\cmd.exe"
+};
+
+static b3_pattern_condition_t *g_pattern_condition;
+static b3_win_t *g_win_arr[2];
+
+/**
+ * Fake window system. The window handler is the position within
+ * g_fake_title_arr.
+ */
+static int
+fake_reader(HWND window_handler, b3_win_attr_t *attr)
+{
+	memset(attr, 0, sizeof(b3_win_attr_t));
+	strcpy(attr->title, g_fake_title_arr[(INT_PTR) window_handler]);
+
+	return 0;
+}
+
+static void
+setup(void)
+{
+	b3_win_set_attr_reader(fake_reader);
+
+	strcpy(g_fake_title_arr[0], "a.b (1)");
+	strcpy(g_fake_title_arr[1], "Untitled - Notepad");
+	g_win_arr[0] = b3_win_new((HWND) 0, 0);
+	g_win_arr[1] = b3_win_new((HWND) 1, 0);
+
+	g_pattern_condition = (b3_pattern_condition_t *) b3_title_condition_new(B3_PATTERN_CONDITION_PATTERN_FOCUSED);
+}
+
+static void
+teardown(void)
+{
+	b3_condition_free((b3_condition_t *) g_pattern_condition);
+	g_pattern_condition = NULL;
+
+	b3_win_free(g_win_arr[0]);
+	b3_win_free(g_win_arr[1]);
+
+	b3_win_set_attr_reader(NULL);
+}
+
+/**
+ * Compiles the pattern of the focused window.
+ */
+static int
+compile_focused(int focused, pcre **re_compiled, pcre_extra **re_extra)
+{
+	return b3_pattern_condition_compile_focused(g_pattern_condition,
+												g_win_arr[focused],
+												b3_win_get_title(g_win_arr[focused]),
+												re_compiled,
+												re_extra);
+}
+
+static int
+matches(pcre *re_compiled, pcre_extra *re_extra, const char *subject)
+{
+	return pcre_exec(re_compiled, re_extra, subject, strlen(subject), 0, 0, NULL, 0) >= 0;
+}
+
+static int
+test_literal(void)
+{
+	int error;
+	pcre *re_compiled;
+	pcre_extra *re_extra;
+
+	error = compile_focused(0, &re_compiled, &re_extra);
+
+	if (!error) {
+		error = b3_test_check_int(matches(re_compiled, re_extra, "Project a.b (1)"), 1, "Title was not matched.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(matches(re_compiled, re_extra, "axb 1"), 0, "Title was matched as pattern.");
+	}
+
+	return error;
+}
+
+static int
+test_cache(void)
+{
+	int error;
+	pcre *re_compiled;
+	pcre_extra *re_extra;
+	pcre *cached_re_compiled;
+
+	error = compile_focused(0, &cached_re_compiled, &re_extra);
+
+	if (!error) {
+		error = compile_focused(0, &re_compiled, &re_extra);
+	}
+
+	if (!error) {
+		error = b3_test_check_void(re_compiled, cached_re_compiled, "Pattern was not cached.");
+	}
+
+	if (!error) {
+		b3_win_refresh_attr(g_win_arr[0]);
+		error = compile_focused(0, &re_compiled, &re_extra);
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_pattern_condition->focused_compile_count, 1, "Unchanged title was compiled again.");
+	}
+
+	return error;
+}
+
+static int
+test_invalidate(void)
+{
+	int error;
+	pcre *re_compiled;
+	pcre_extra *re_extra;
+
+	error = compile_focused(0, &re_compiled, &re_extra);
+
+	if (!error) {
+		error = compile_focused(1, &re_compiled, &re_extra);
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_pattern_condition->focused_compile_count, 2, "Focus change was not noticed.");
+	}
+
+	if (!error) {
+		strcpy(g_fake_title_arr[1], "notes.txt - Notepad");
+		b3_win_refresh_attr(g_win_arr[1]);
+		error = compile_focused(1, &re_compiled, &re_extra);
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_pattern_condition->focused_compile_count, 3, "Title change was not noticed.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(matches(re_compiled, re_extra, "notes.txt - Notepad"), 1, "New title was not matched.");
+	}
+
+	return error;
+}
+
+static int
+test_kind(void)
+{
+	int error;
+	b3_pattern_condition_t *pattern_condition;
+	int kind;
+
+	error = 0;
+	for (kind = PATTERN_EXACT; !error && kind <= PATTERN_REGEX; kind++) {
+		pattern_condition = (b3_pattern_condition_t *) b3_title_condition_new(g_kind_pattern_arr[kind]);
+
+		error = b3_test_check_int(b3_pattern_condition_get_kind(pattern_condition), kind, "Unexpected kind.");
+
+		if (!error) {
+			error = b3_test_check_int(pattern_condition->re_compiled != NULL, kind == PATTERN_REGEX, "Unexpected compilation.");
+		}
+
+		b3_condition_free((b3_condition_t *) pattern_condition);
+	}
+
+	return error;
+}
+
+/**
+ * Matches a pattern of every kind BENCHMARK_MATCH_COUNT times. Once as
+ * literal, once by pcre. Both have to agree.
+ */
+static int
+test_benchmark(void)
+{
+	int error;
+	b3_pattern_condition_t *pattern_condition;
+	pcre *re_compiled;
+	pcre_extra *re_extra;
+	LARGE_INTEGER frequency;
+	LARGE_INTEGER start;
+	LARGE_INTEGER end;
+	double kind_ms;
+	double pcre_ms;
+	int subject_count;
+	int match_count;
+	int kind;
+	int i;
+
+	subject_count = sizeof(g_subject_arr) / sizeof(g_subject_arr[0]);
+
+	QueryPerformanceFrequency(&frequency);
+
+	error = 0;
+	for (kind = PATTERN_EXACT; !error && kind <= PATTERN_REGEX; kind++) {
+		pattern_condition = (b3_pattern_condition_t *) b3_title_condition_new(g_kind_pattern_arr[kind]);
+		error = b3_compile_pattern(g_kind_pattern_arr[kind], &re_compiled, &re_extra);
+
+		for (i = 0; !error && i < subject_count; i++) {
+			if (b3_pattern_condition_matches(pattern_condition, g_subject_arr[i])
+				!= matches(re_compiled, re_extra, g_subject_arr[i])) {
+				error = b3_test_check_str(g_subject_arr[i], g_kind_pattern_arr[kind], "Kind and pcre disagree.");
+			}
+		}
+
+		match_count = 0;
+		QueryPerformanceCounter(&start);
+		for (i = 0; !error && i < BENCHMARK_MATCH_COUNT; i++) {
+			match_count += b3_pattern_condition_matches(pattern_condition, g_subject_arr[i % subject_count]);
+		}
+		QueryPerformanceCounter(&end);
+		kind_ms = (double) (end.QuadPart - start.QuadPart) * 1000.0 / (double) frequency.QuadPart;
+
+		QueryPerformanceCounter(&start);
+		for (i = 0; !error && i < BENCHMARK_MATCH_COUNT; i++) {
+			match_count -= matches(re_compiled, re_extra, g_subject_arr[i % subject_count]);
+		}
+		QueryPerformanceCounter(&end);
+		pcre_ms = (double) (end.QuadPart - start.QuadPart) * 1000.0 / (double) frequency.QuadPart;
+
+		fprintf(stdout, "kind %d (%s): %10.1f matches/ms by kind, %10.1f matches/ms by pcre\n",
+				kind,
+				g_kind_pattern_arr[kind],
+				BENCHMARK_MATCH_COUNT / kind_ms,
+				BENCHMARK_MATCH_COUNT / pcre_ms);
+
+		if (!error) {
+			error = b3_test_check_int(match_count, 0, "Kind and pcre disagree.");
+		}
+
+		if (re_compiled) {
+			pcre_free(re_compiled);
+		}
+
+		if (re_extra) {
+#ifdef PCRE_CONFIG_JIT
+			pcre_free_study(re_extra);
+#else
+			pcre_free(re_extra);
+#endif
+		}
+
+		b3_condition_free((b3_condition_t *) pattern_condition);
+	}
+
+	return error;
+}
+
+int
+main(void)
+{
+	b3_test(setup, teardown, test_literal, "test_literal");
+	b3_test(setup, teardown, test_cache, "test_cache");
+	b3_test(setup, teardown, test_invalidate, "test_invalidate");
+	b3_test(b3_test_empty_setup, b3_test_empty_teardown, test_kind, "test_kind");
+	b3_test(b3_test_empty_setup, b3_test_empty_teardown, test_benchmark, "test_benchmark");
+
+	return 0;
+}
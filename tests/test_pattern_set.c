@@ -0,0 +1,287 @@
+/******************************************************************************
+  This file is part of b3.
+
+  Copyright 2020-2021 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+
+/**
+ * @author Richard Bäck <richard.baeck@mailbox.org>
+ * @date 2021-04-17
+ * @brief File contains the tests for the pattern set class
+ */
+
+#include "../src/pattern_set.h"
+
+#include "test.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+
+#include "../src/utils.h"
+
+#define BENCHMARK_PATTERN_COUNT 500
+#define BENCHMARK_SUBJECT_COUNT 10000
+
+static b3_pattern_set_t *g_pattern_set;
+
+static void
+setup(void)
+{
+	g_pattern_set = b3_pattern_set_new();
+}
+
+static void
+teardown(void)
+{
+	b3_pattern_set_free(g_pattern_set);
+	g_pattern_set = NULL;
+}
+
+/**
+ * Generates the pattern with the number i. The patterns resemble the ones of
+ * a configuration: literals, anchors, character classes and alternations.
+ */
+static void
+generate_pattern(char *pattern, int i)
+{
+	switch (i % 5) {
+	case 0: sprintf(pattern, "^Window %d - ", i); break;
+	case 1: sprintf(pattern, ".*Document %d\\b", i); break;
+	case 2: sprintf(pattern, "Project\\[%d\\]$", i); break;
+	case 3: sprintf(pattern, "(Mail|Chat) %d", i); break;
+	default: sprintf(pattern, "[a-z]+ %d\\.txt", i); break;
+	}
+}
+
+/**
+ * Generates the title with the number i. Most titles match a few patterns.
+ */
+static void
+generate_subject(char *subject, int i)
+{
+	sprintf(subject, "Window %d - Document %d - notes %d.txt - Project[%d]",
+			i % 600,
+			i % 700,
+			i % 800,
+			i % 900);
+}
+
+static int
+test_add(void)
+{
+	int error;
+
+	error = b3_test_check_int(b3_pattern_set_add(g_pattern_set, "^Notepad$"), 0, "Unexpected id.");
+
+	if (!error) {
+		error = b3_test_check_int(b3_pattern_set_add(g_pattern_set, "Teams"), 1, "Unexpected id.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(b3_pattern_set_add(g_pattern_set, "^Notepad$"), 0, "Same pattern has another id.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(b3_pattern_set_add(g_pattern_set, "(Teams"), -1, "Invalid pattern was added.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(b3_pattern_set_add(g_pattern_set, "(a)\\1"), 2, "Unexpected id.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(b3_pattern_set_get_size(g_pattern_set), 3, "Unexpected size.");
+	}
+
+	return error;
+}
+
+static int
+test_match(void)
+{
+	int error;
+	char match_arr[4];
+
+	b3_pattern_set_add(g_pattern_set, "^Notepad$");
+	b3_pattern_set_add(g_pattern_set, "Teams");
+	b3_pattern_set_add(g_pattern_set, "q|z");
+	b3_pattern_set_add(g_pattern_set, "x*");
+
+	error = b3_test_check_int(b3_pattern_set_match(g_pattern_set, "Teams", match_arr), -1, "Matched without compiling.");
+
+	if (!error) {
+		error = b3_pattern_set_compile(g_pattern_set);
+	}
+
+	if (!error) {
+		error = b3_test_check_int(b3_pattern_set_match(g_pattern_set, "Notepad", match_arr), 2, "Unexpected count.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(match_arr[0] && !match_arr[1] && !match_arr[2] && match_arr[3], 1, "Unexpected matches.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(b3_pattern_set_match(g_pattern_set, "Microsoft Teams", match_arr), 2, "Unexpected count.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(!match_arr[0] && match_arr[1] && !match_arr[2] && match_arr[3], 1, "Unexpected matches.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(b3_pattern_set_match(g_pattern_set, "Quiz Notepad", match_arr), 2, "Unexpected count.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(!match_arr[0] && !match_arr[1] && match_arr[2] && match_arr[3], 1, "Unexpected matches.");
+	}
+
+	return error;
+}
+
+static int
+test_empty(void)
+{
+	int error;
+	char match_arr[1];
+
+	error = b3_pattern_set_compile(g_pattern_set);
+
+	if (!error) {
+		error = b3_test_check_int(b3_pattern_set_match(g_pattern_set, "Teams", match_arr), 0, "Empty set matched.");
+	}
+
+	return error;
+}
+
+/**
+ * Matches BENCHMARK_PATTERN_COUNT patterns against BENCHMARK_SUBJECT_COUNT
+ * titles. Once pattern by pattern, once with the set. Both have to agree.
+ */
+static int
+test_benchmark(void)
+{
+	int error;
+	char pattern[64];
+	char subject[128];
+	pcre *re_compiled_arr[BENCHMARK_PATTERN_COUNT];
+	pcre_extra *re_extra_arr[BENCHMARK_PATTERN_COUNT];
+	char *single_match_arr;
+	char match_arr[BENCHMARK_PATTERN_COUNT];
+	LARGE_INTEGER frequency;
+	LARGE_INTEGER start;
+	LARGE_INTEGER end;
+	double single_ms;
+	double set_ms;
+	int match_count;
+	int i;
+	int j;
+
+	memset(re_compiled_arr, 0, sizeof(re_compiled_arr));
+	memset(re_extra_arr, 0, sizeof(re_extra_arr));
+
+	error = 0;
+	for (i = 0; !error && i < BENCHMARK_PATTERN_COUNT; i++) {
+		generate_pattern(pattern, i);
+		error = b3_compile_pattern(pattern, &(re_compiled_arr[i]), &(re_extra_arr[i]));
+		if (!error) {
+			error = b3_test_check_int(b3_pattern_set_add(g_pattern_set, pattern), i, "Pattern was not added.");
+		}
+	}
+
+	if (!error) {
+		error = b3_pattern_set_compile(g_pattern_set);
+	}
+
+	single_match_arr = malloc(sizeof(char) * BENCHMARK_PATTERN_COUNT * BENCHMARK_SUBJECT_COUNT);
+
+	QueryPerformanceFrequency(&frequency);
+
+	QueryPerformanceCounter(&start);
+	for (i = 0; !error && i < BENCHMARK_SUBJECT_COUNT; i++) {
+		generate_subject(subject, i);
+		for (j = 0; j < BENCHMARK_PATTERN_COUNT; j++) {
+			single_match_arr[i * BENCHMARK_PATTERN_COUNT + j] =
+				pcre_exec(re_compiled_arr[j], re_extra_arr[j], subject, strlen(subject), 0, 0, NULL, 0) >= 0;
+		}
+	}
+	QueryPerformanceCounter(&end);
+	single_ms = (double) (end.QuadPart - start.QuadPart) * 1000.0 / (double) frequency.QuadPart;
+
+	match_count = 0;
+	QueryPerformanceCounter(&start);
+	for (i = 0; !error && i < BENCHMARK_SUBJECT_COUNT; i++) {
+		generate_subject(subject, i);
+		if (b3_pattern_set_match(g_pattern_set, subject, match_arr) < 0) {
+			error = b3_test_check_int(0, 1, "Matching failed.");
+		}
+
+		for (j = 0; !error && j < BENCHMARK_PATTERN_COUNT; j++) {
+			if (match_arr[j] != single_match_arr[i * BENCHMARK_PATTERN_COUNT + j]) {
+				error = b3_test_check_str(subject, "", "Set and single patterns disagree.");
+			}
+			match_count += match_arr[j];
+		}
+	}
+	QueryPerformanceCounter(&end);
+	set_ms = (double) (end.QuadPart - start.QuadPart) * 1000.0 / (double) frequency.QuadPart;
+
+	fprintf(stdout, "%d patterns x %d titles: %8.1f ms single, %8.1f ms set, %d matches\n",
+			BENCHMARK_PATTERN_COUNT,
+			BENCHMARK_SUBJECT_COUNT,
+			single_ms,
+			set_ms,
+			match_count);
+
+	free(single_match_arr);
+
+	for (i = 0; i < BENCHMARK_PATTERN_COUNT; i++) {
+		if (re_compiled_arr[i]) {
+			pcre_free(re_compiled_arr[i]);
+		}
+
+		if (re_extra_arr[i]) {
+#ifdef PCRE_CONFIG_JIT
+			pcre_free_study(re_extra_arr[i]);
+#else
+			pcre_free(re_extra_arr[i]);
+#endif
+		}
+	}
+
+	return error;
+}
+
+int
+main(void)
+{
+	b3_test(setup, teardown, test_add, "test_add");
+	b3_test(setup, teardown, test_match, "test_match");
+	b3_test(setup, teardown, test_empty, "test_empty");
+	b3_test(setup, teardown, test_benchmark, "test_benchmark");
+
+	return 0;
+}
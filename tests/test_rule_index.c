@@ -0,0 +1,313 @@
+/******************************************************************************
+  This file is part of b3.
+
+  Copyright 2020-2021 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck <richard.baeck@mailbox.org>
+ * @date 2021-04-17
+ * @brief File contains the tests for the rule index class
+ */
+
+#include "../src/rule_index.h"
+
+#include "test.h"
+
+#include <string.h>
+
+#include "../src/condition_and.h"
+#include "../src/class_condition.h"
+#include "../src/title_condition.h"
+
+#define RULE_COUNT 5
+
+typedef struct fake_win_s
+{
+	const char *classname;
+	const char *title;
+} fake_win_t;
+
+static fake_win_t g_fake_win_arr[] = {
+	{ "", "" },
+	{ "Notepad", "Untitled - Notepad" },
+	{ "CabinetWClass", "Microsoft Teams" },
+	{ "Other", "foo" }
+};
+
+static b3_rule_index_t *g_rule_index;
+static Array *g_rule_arr;
+
+/**
+ * Fake window system. The window handler is the position within
+ * g_fake_win_arr.
+ */
+static int
+fake_reader(HWND window_handler, b3_win_attr_t *attr)
+{
+	fake_win_t *fake_win;
+
+	memset(attr, 0, sizeof(b3_win_attr_t));
+
+	fake_win = &(g_fake_win_arr[(INT_PTR) window_handler]);
+	strcpy(attr->classname, fake_win->classname);
+	strcpy(attr->title, fake_win->title);
+
+	return 0;
+}
+
+static b3_rule_t *
+new_rule(const char *class_pattern, const char *title_pattern)
+{
+	b3_condition_and_t *condition_and;
+
+	condition_and = b3_condition_and_new();
+
+	if (class_pattern) {
+		b3_condition_and_add(condition_and, (b3_condition_t *) b3_class_condition_new(class_pattern));
+	}
+
+	if (title_pattern) {
+		b3_condition_and_add(condition_and, (b3_condition_t *) b3_title_condition_new(title_pattern));
+	}
+
+	return b3_rule_new((b3_condition_t *) condition_and, b3_action_new());
+}
+
+static void
+setup(void)
+{
+	b3_win_set_attr_reader(fake_reader);
+
+	g_rule_index = b3_rule_index_new();
+
+	array_new(&g_rule_arr);
+	array_add(g_rule_arr, new_rule("^Notepad$", NULL));
+	array_add(g_rule_arr, new_rule(NULL, ".*Teams.*"));
+	array_add(g_rule_arr, new_rule("Cabinet", NULL));
+	array_add(g_rule_arr, new_rule("^Notepad$", "Untitled"));
+	array_add(g_rule_arr, new_rule(NULL, "."));
+}
+
+static void
+teardown(void)
+{
+	ArrayIter iter;
+	b3_rule_t *rule;
+
+	b3_rule_index_free(g_rule_index);
+	g_rule_index = NULL;
+
+	array_iter_init(&iter, g_rule_arr);
+	while (array_iter_next(&iter, (void *) &rule) != CC_ITER_END) {
+		b3_rule_free(rule);
+	}
+	array_destroy(g_rule_arr);
+	g_rule_arr = NULL;
+
+	b3_win_set_attr_reader(NULL);
+}
+
+/**
+ * Checks that the candidates of a window are exactly the rules at the
+ * positions of position_arr.
+ */
+static int
+check_candidates(int window, int *position_arr, int position_count)
+{
+	int error;
+	Array *candidate_arr;
+	b3_win_t *win;
+	b3_rule_t *candidate;
+	b3_rule_t *rule;
+	int i;
+
+	win = b3_win_new((HWND) (INT_PTR) window, 0);
+	array_new(&candidate_arr);
+
+	error = b3_rule_index_find_candidates(g_rule_index, NULL, win, candidate_arr);
+
+	if (!error) {
+		error = b3_test_check_int(array_size(candidate_arr), position_count, "Unexpected count of candidates.");
+	}
+
+	for (i = 0; !error && i < position_count; i++) {
+		array_get_at(candidate_arr, i, (void *) &candidate);
+		array_get_at(g_rule_arr, position_arr[i], (void *) &rule);
+		error = b3_test_check_int(candidate == rule, 1, "Unexpected candidate or order.");
+	}
+
+	array_destroy(candidate_arr);
+	b3_win_free(win);
+
+	return error;
+}
+
+static int
+test_exact_class(void)
+{
+	int position_arr[] = { 0, 3, 4 };
+	int error;
+
+	error = b3_rule_index_compile(g_rule_index, g_rule_arr);
+
+	if (!error) {
+		error = b3_test_check_int(hashtable_size(g_rule_index->exact_class_table), 1, "Exact classes were not bucketed.");
+	}
+
+	if (!error) {
+		error = check_candidates(1, position_arr, 3);
+	}
+
+	return error;
+}
+
+static int
+test_class_pattern(void)
+{
+	int position_arr[] = { 1, 2, 4 };
+	int error;
+
+	error = b3_rule_index_compile(g_rule_index, g_rule_arr);
+
+	if (!error) {
+		error = check_candidates(2, position_arr, 3);
+	}
+
+	if (!error) {
+		error = check_candidates(2, position_arr, 3);
+	}
+
+	if (!error) {
+		error = b3_test_check_int(hashtable_size(g_rule_index->class_candidate_table), 1, "Class was not remembered once.");
+	}
+
+	return error;
+}
+
+static int
+test_fallback(void)
+{
+	int position_arr[] = { 4 };
+	int error;
+
+	error = b3_rule_index_compile(g_rule_index, g_rule_arr);
+
+	if (!error) {
+		error = check_candidates(3, position_arr, 1);
+	}
+
+	return error;
+}
+
+static int
+test_recompile(void)
+{
+	int old_position_arr[] = { 1, 2, 4 };
+	int position_arr[] = { 0 };
+	int error;
+	b3_rule_t *rule;
+
+	error = b3_rule_index_compile(g_rule_index, g_rule_arr);
+
+	if (!error) {
+		error = check_candidates(2, old_position_arr, 3);
+	}
+
+	if (!error) {
+		/**
+		 * Keep the first rule only.
+		 */
+		while (array_size(g_rule_arr) > 1) {
+			array_remove_last(g_rule_arr, (void *) &rule);
+			b3_rule_free(rule);
+		}
+
+		error = b3_rule_index_compile(g_rule_index, g_rule_arr);
+	}
+
+	if (!error) {
+		error = b3_test_check_int(hashtable_size(g_rule_index->class_candidate_table), 0, "Remembered classes survived the compilation.");
+	}
+
+	if (!error) {
+		error = check_candidates(1, position_arr, 1);
+	}
+
+	return error;
+}
+
+static int
+test_decided(void)
+{
+	int error;
+	Array *entry_arr;
+	b3_win_t *win;
+	b3_rule_index_entry_t *entry;
+	int i;
+
+	array_add(g_rule_arr, new_rule(NULL, B3_PATTERN_CONDITION_PATTERN_FOCUSED));
+
+	error = b3_rule_index_compile(g_rule_index, g_rule_arr);
+
+	win = b3_win_new((HWND) 1, 0);
+	array_new(&entry_arr);
+
+	if (!error) {
+		error = b3_rule_index_find_candidate_entries(g_rule_index, NULL, win, entry_arr);
+	}
+
+	if (!error) {
+		error = b3_test_check_int(array_size(entry_arr), 4, "Unexpected count of candidates.");
+	}
+
+	/**
+	 * The prefilter covers the class and title patterns, but not the focused
+	 * window.
+	 */
+	for (i = 0; !error && i < 3; i++) {
+		array_get_at(entry_arr, i, (void *) &entry);
+		error = b3_test_check_int(entry->decided, 1, "Rule covered by the prefilter is not decided.");
+	}
+
+	if (!error) {
+		array_get_at(entry_arr, 3, (void *) &entry);
+		error = b3_test_check_int(entry->decided, 0, "Rule using the focused window is decided.");
+	}
+
+	array_destroy(entry_arr);
+	b3_win_free(win);
+
+	return error;
+}
+
+int
+main(void)
+{
+	b3_test(setup, teardown, test_exact_class, "test_exact_class");
+	b3_test(setup, teardown, test_class_pattern, "test_class_pattern");
+	b3_test(setup, teardown, test_fallback, "test_fallback");
+	b3_test(setup, teardown, test_recompile, "test_recompile");
+	b3_test(setup, teardown, test_decided, "test_decided");
+
+	return 0;
+}
@@ -0,0 +1,146 @@
+/******************************************************************************
+  This file is part of b3.
+
+  Copyright 2020-2021 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * @author Richard Bäck <richard.baeck@mailbox.org>
+ * @date 2021-04-17
+ * @brief File contains the tests for the win class
+ */
+
+#include "../src/win.h"
+
+#include "test.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static int g_read_count;
+static char g_title[B3_WIN_ATTR_LENGTH];
+
+/**
+ * Fake window system. The title of every window is g_title, the class name
+ * is derived from the window handler.
+ */
+static int
+fake_reader(HWND window_handler, b3_win_attr_t *attr)
+{
+	strcpy(attr->title, g_title);
+	sprintf(attr->classname, "class %d", (int) (INT_PTR) window_handler);
+	attr->style = WS_VISIBLE;
+	attr->exstyle = WS_EX_TOOLWINDOW;
+	attr->owner = (HWND) 42;
+	attr->process_id = 4711;
+
+	g_read_count++;
+
+	return 0;
+}
+
+static void
+setup(void)
+{
+	g_read_count = 0;
+	strcpy(g_title, "first title");
+	b3_win_set_attr_reader(fake_reader);
+}
+
+static void
+teardown(void)
+{
+	b3_win_set_attr_reader(NULL);
+}
+
+static int
+test_attr_read_once(void)
+{
+	int error;
+	b3_win_t *win;
+	int i;
+
+	win = b3_win_new((HWND) 7, 0);
+
+	error = 0;
+	for (i = 0; !error && i < 100; i++) {
+		error = b3_test_check_str(b3_win_get_title(win), "first title", "Unexpected title.");
+	}
+
+	if (!error) {
+		error = b3_test_check_str(b3_win_get_classname(win), "class 7", "Unexpected class name.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(b3_win_get_style(win), WS_VISIBLE, "Unexpected style.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(b3_win_get_exstyle(win), WS_EX_TOOLWINDOW, "Unexpected extended style.");
+	}
+
+	if (!error) {
+		error = b3_test_check_void(b3_win_get_owner(win), (HWND) 42, "Unexpected owner.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(b3_win_get_process_id(win), 4711, "Unexpected process id.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_read_count, 1, "Attributes were read more than once.");
+	}
+
+	b3_win_free(win);
+
+	return error;
+}
+
+static int
+test_attr_refresh(void)
+{
+	int error;
+	b3_win_t *win;
+
+	win = b3_win_new((HWND) 7, 0);
+
+	strcpy(g_title, "second title");
+
+	error = b3_test_check_str(b3_win_get_title(win), "first title", "Title changed without a refresh.");
+
+	if (!error) {
+		b3_win_refresh_attr(win);
+		error = b3_test_check_str(b3_win_get_title(win), "second title", "Title was not refreshed.");
+	}
+
+	b3_win_free(win);
+
+	return error;
+}
+
+int
+main(void)
+{
+	b3_test(setup, teardown, test_attr_read_once, "test_attr_read_once");
+	b3_test(setup, teardown, test_attr_refresh, "test_attr_refresh");
+
+	return 0;
+}
@@ -0,0 +1,452 @@
+/******************************************************************************
+  This file is part of b3.
+
+  Copyright 2020-2021 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * @author Richard Bäck <richard.baeck@mailbox.org>
+ * @date 2021-04-17
+ * @brief File contains the tests for the win_event_queue class
+ */
+
+#include "../src/win_event_queue.h"
+
+#include "test.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define QUEUE_LENGTH 16
+#define EVENT_ARR_LEN 16
+#define STRESS_EVENT_COUNT 100000
+#define STRESS_WIN_COUNT 64
+
+typedef enum win_state_e
+{
+	CLOSED = 0,
+	OPENED,
+	ACTIVE
+} win_state_t;
+
+static int g_event_arr_i;
+static b3_win_event_t g_event_arr[EVENT_ARR_LEN];
+
+/**
+ * State of every fake window as seen by track_handler.
+ */
+static win_state_t g_win_state_arr[STRESS_WIN_COUNT];
+static int g_out_of_order_count;
+
+/**
+ * Fake handler recording the events instead of applying them.
+ */
+static int
+record_handler(const b3_win_event_t *event, void *data)
+{
+	if (g_event_arr_i < EVENT_ARR_LEN) {
+		g_event_arr[g_event_arr_i] = *event;
+	}
+	g_event_arr_i++;
+
+	return 0;
+}
+
+/**
+ * Fake handler tracking the state of the windows. A window may only be
+ * activated or destroyed after it was created.
+ */
+static int
+track_handler(const b3_win_event_t *event, void *data)
+{
+	win_state_t *state;
+
+	state = &(g_win_state_arr[(LONG_PTR) event->window_handler - 1]);
+	switch (event->type) {
+		case WIN_CREATED:
+			if (*state != CLOSED) {
+				g_out_of_order_count++;
+			}
+			*state = OPENED;
+			break;
+
+		case WIN_ACTIVATED:
+			if (*state != OPENED) {
+				g_out_of_order_count++;
+			}
+			*state = ACTIVE;
+			break;
+
+		case WIN_DESTROYED:
+			if (*state == CLOSED) {
+				g_out_of_order_count++;
+			}
+			*state = CLOSED;
+			break;
+	}
+
+	return 0;
+}
+
+static void
+setup(void)
+{
+	g_event_arr_i = 0;
+	memset(g_event_arr, 0, sizeof(g_event_arr));
+	memset(g_win_state_arr, 0, sizeof(g_win_state_arr));
+	g_out_of_order_count = 0;
+}
+
+static void
+teardown(void)
+{
+}
+
+static int
+test_order(void)
+{
+	int error;
+	b3_win_event_queue_t *queue;
+
+	queue = b3_win_event_queue_new(QUEUE_LENGTH, record_handler, NULL);
+	queue->grace_period = 0;
+
+	b3_win_event_queue_push(queue, WIN_CREATED, (HWND) 1);
+	b3_win_event_queue_push(queue, WIN_ACTIVATED, (HWND) 1);
+	b3_win_event_queue_push(queue, WIN_DESTROYED, (HWND) 1);
+
+	error = b3_test_check_int(b3_win_event_queue_process(queue), 3, "Unexpected count of handled events.");
+
+	if (!error) {
+		error = b3_test_check_int(g_event_arr[0].type, WIN_CREATED, "Creation is not handled first.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_event_arr[1].type, WIN_ACTIVATED, "Activation is not handled second.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_event_arr[2].type, WIN_DESTROYED, "Destruction is not handled last.");
+	}
+
+	if (!error) {
+		error = b3_test_check_void(g_event_arr[2].window_handler, (HWND) 1, "Window handler got lost.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(b3_win_event_queue_process(queue), 0, "Events were handled twice.");
+	}
+
+	b3_win_event_queue_free(queue);
+
+	return error;
+}
+
+static int
+test_full(void)
+{
+	int error;
+	b3_win_event_queue_t *queue;
+	int i;
+
+	queue = b3_win_event_queue_new(QUEUE_LENGTH, record_handler, NULL);
+	queue->grace_period = 0;
+
+	error = 0;
+	for (i = 0; !error && i < QUEUE_LENGTH; i++) {
+		error = b3_win_event_queue_push(queue, WIN_CREATED, (HWND) (LONG_PTR) (i + 1));
+	}
+
+	if (!error) {
+		error = b3_test_check_int(b3_win_event_queue_push(queue, WIN_CREATED, (HWND) 1) != 0, 1, "Full queue accepted an event.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(queue->refuse_count, 1, "Refused event was not counted.");
+	}
+
+	/**
+	 * Wrap around the end of the ring buffer.
+	 */
+	if (!error) {
+		b3_win_event_queue_process(queue);
+		g_event_arr_i = 0;
+		b3_win_event_queue_push(queue, WIN_CREATED, (HWND) 2);
+		b3_win_event_queue_push(queue, WIN_DESTROYED, (HWND) 2);
+		error = b3_test_check_int(b3_win_event_queue_process(queue), 2, "Unexpected count of handled events.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_event_arr[1].type, WIN_DESTROYED, "Order got lost after wrapping around.");
+	}
+
+	b3_win_event_queue_free(queue);
+
+	return error;
+}
+
+static int
+test_merge_activations(void)
+{
+	int error;
+	b3_win_event_queue_t *queue;
+
+	queue = b3_win_event_queue_new(QUEUE_LENGTH, record_handler, NULL);
+	queue->grace_period = 0;
+
+	b3_win_event_queue_push(queue, WIN_CREATED, (HWND) 1);
+	b3_win_event_queue_push(queue, WIN_ACTIVATED, (HWND) 1);
+	b3_win_event_queue_push(queue, WIN_ACTIVATED, (HWND) 2);
+	b3_win_event_queue_push(queue, WIN_ACTIVATED, (HWND) 3);
+	b3_win_event_queue_push(queue, WIN_DESTROYED, (HWND) 2);
+	b3_win_event_queue_push(queue, WIN_ACTIVATED, (HWND) 1);
+
+	error = b3_test_check_int(b3_win_event_queue_process(queue), 4, "Unexpected count of handled events.");
+
+	if (!error) {
+		error = b3_test_check_int(queue->merge_count, 2, "Unexpected count of merged events.");
+	}
+
+	if (!error) {
+		error = b3_test_check_void(g_event_arr[1].window_handler, (HWND) 3, "Latest activation was not kept.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_event_arr[2].type, WIN_DESTROYED, "Activation was merged over another event.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_event_arr[3].type, WIN_ACTIVATED, "Activation after another event is missing.");
+	}
+
+	b3_win_event_queue_free(queue);
+
+	return error;
+}
+
+static int
+test_merge_redraws(void)
+{
+	int error;
+	b3_win_event_queue_t *queue;
+
+	queue = b3_win_event_queue_new(QUEUE_LENGTH, record_handler, NULL);
+	queue->grace_period = 0;
+
+	b3_win_event_queue_push(queue, WIN_REDRAWN, (HWND) 1);
+	b3_win_event_queue_push(queue, WIN_REDRAWN, (HWND) 1);
+	b3_win_event_queue_push(queue, WIN_REDRAWN, (HWND) 2);
+	b3_win_event_queue_push(queue, WIN_REDRAWN, (HWND) 2);
+	b3_win_event_queue_push(queue, WIN_REDRAWN, (HWND) 1);
+
+	error = b3_test_check_int(b3_win_event_queue_process(queue), 3, "Unexpected count of handled events.");
+
+	if (!error) {
+		error = b3_test_check_int(queue->merge_count, 2, "Unexpected count of merged events.");
+	}
+
+	if (!error) {
+		error = b3_test_check_void(g_event_arr[1].window_handler, (HWND) 2, "Redraw of another window was merged.");
+	}
+
+	b3_win_event_queue_free(queue);
+
+	return error;
+}
+
+static int
+test_cancel_short_lived(void)
+{
+	int error;
+	b3_win_event_queue_t *queue;
+
+	queue = b3_win_event_queue_new(QUEUE_LENGTH, record_handler, NULL);
+	queue->grace_period = 10000;
+
+	b3_win_event_queue_push(queue, WIN_ACTIVATED, (HWND) 1);
+	b3_win_event_queue_push(queue, WIN_CREATED, (HWND) 2);
+	b3_win_event_queue_push(queue, WIN_ACTIVATED, (HWND) 2);
+	b3_win_event_queue_push(queue, WIN_CREATED, (HWND) 3);
+	b3_win_event_queue_push(queue, WIN_DESTROYED, (HWND) 2);
+
+	/**
+	 * The activation of window 1 is handled, the creation of window 3 is held
+	 * back.
+	 */
+	error = b3_test_check_int(b3_win_event_queue_process(queue), 1, "Unexpected count of handled events.");
+
+	if (!error) {
+		error = b3_test_check_int(queue->drop_count, 3, "Unexpected count of dropped events.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(queue->event_count, 1, "Unexpected count of pending events.");
+	}
+
+	if (!error) {
+		error = b3_test_check_void(queue->event_arr[queue->event_arr_head].window_handler, (HWND) 3, "Wrong events were dropped.");
+	}
+
+	b3_win_event_queue_free(queue);
+
+	return error;
+}
+
+static int
+test_grace_period_expired(void)
+{
+	int error;
+	b3_win_event_queue_t *queue;
+
+	queue = b3_win_event_queue_new(QUEUE_LENGTH, record_handler, NULL);
+	queue->grace_period = 20;
+
+	b3_win_event_queue_push(queue, WIN_CREATED, (HWND) 1);
+	b3_win_event_queue_push(queue, WIN_ACTIVATED, (HWND) 2);
+
+	error = b3_test_check_int(b3_win_event_queue_process(queue), 0, "Creation was not held back.");
+
+	if (!error) {
+		Sleep(queue->grace_period * 2);
+		b3_win_event_queue_push(queue, WIN_DESTROYED, (HWND) 1);
+
+		error = b3_test_check_int(queue->drop_count, 0, "Window living longer than the grace period was dropped.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(b3_win_event_queue_process(queue), 3, "Unexpected count of handled events.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_event_arr[1].type, WIN_ACTIVATED, "Order got lost while holding back.");
+	}
+
+	b3_win_event_queue_free(queue);
+
+	return error;
+}
+
+static int
+test_stress(void)
+{
+	int error;
+	b3_win_event_queue_t *queue;
+	LARGE_INTEGER frequency;
+	LARGE_INTEGER start;
+	LARGE_INTEGER end;
+	b3_win_event_type_t type;
+	HWND window_handler;
+	int expected_open_count;
+	int open_count;
+	int i;
+
+	queue = b3_win_event_queue_new(B3_WIN_EVENT_QUEUE_LENGTH, track_handler, NULL);
+	queue->grace_period = 0;
+	error = b3_win_event_queue_start(queue);
+
+	/**
+	 * Every window is created, activated and destroyed in turn. The windows
+	 * are interleaved so the consumer sees them mixed up. Of each run of
+	 * activations only the last one might be handled.
+	 */
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&start);
+	for (i = 0; !error && i < STRESS_EVENT_COUNT; i++) {
+		window_handler = (HWND) (LONG_PTR) (i % STRESS_WIN_COUNT + 1);
+		switch ((i / STRESS_WIN_COUNT) % 3) {
+			case 0: type = WIN_CREATED; break;
+			case 1: type = WIN_ACTIVATED; break;
+			default: type = WIN_DESTROYED; break;
+		}
+
+		while (b3_win_event_queue_push(queue, type, window_handler)) {
+			Sleep(0);
+		}
+	}
+
+	while (!error && queue->handle_count + queue->merge_count < queue->push_count) {
+		Sleep(1);
+	}
+	QueryPerformanceCounter(&end);
+
+	b3_win_event_queue_stop(queue);
+
+	fprintf(stdout, "%d events: %8.1f events/ms, %d handled, %d merged, %d refused while full\n",
+			STRESS_EVENT_COUNT,
+			(double) STRESS_EVENT_COUNT * (double) frequency.QuadPart
+			/ 1000.0
+			/ (double) (end.QuadPart - start.QuadPart),
+			queue->handle_count,
+			queue->merge_count,
+			queue->refuse_count);
+
+	if (!error) {
+		error = b3_test_check_int(queue->handle_count + queue->merge_count, STRESS_EVENT_COUNT, "Not all events were handled.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_out_of_order_count, 0, "Events were handled out of order.");
+	}
+
+	/**
+	 * 100000 events are 1562 full rounds of 64 events plus 32 events. The last
+	 * round destroys the first 32 windows, the others are still open. The
+	 * last window is active, unless the consumer was fast enough to handle
+	 * the activations one by one.
+	 */
+	expected_open_count = STRESS_WIN_COUNT - 32;
+	open_count = 0;
+	for (i = 0; i < STRESS_WIN_COUNT; i++) {
+		if (g_win_state_arr[i] != CLOSED) {
+			open_count++;
+		}
+	}
+
+	if (!error) {
+		error = b3_test_check_int(open_count, expected_open_count, "Unexpected count of open windows.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_win_state_arr[0], CLOSED, "First window is not destroyed.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_win_state_arr[STRESS_WIN_COUNT - 1], ACTIVE, "Last window is not active.");
+	}
+
+	b3_win_event_queue_free(queue);
+
+	return error;
+}
+
+int
+main(void)
+{
+	b3_test(setup, teardown, test_order, "test_order");
+	b3_test(setup, teardown, test_full, "test_full");
+	b3_test(setup, teardown, test_merge_activations, "test_merge_activations");
+	b3_test(setup, teardown, test_merge_redraws, "test_merge_redraws");
+	b3_test(setup, teardown, test_cancel_short_lived, "test_cancel_short_lived");
+	b3_test(setup, teardown, test_grace_period_expired, "test_grace_period_expired");
+	b3_test(setup, teardown, test_stress, "test_stress");
+
+	return 0;
+}
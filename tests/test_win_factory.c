@@ -0,0 +1,168 @@
+/******************************************************************************
+  This file is part of b3.
+
+  Copyright 2020-2021 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * @author Richard Bäck <richard.baeck@mailbox.org>
+ * @date 2021-04-17
+ * @brief File contains the tests for the win_factory class
+ */
+
+#include "../src/win_factory.h"
+
+#include "test.h"
+
+#define WIN_COUNT 1000
+
+static b3_win_factory_t *g_win_factory;
+
+static void
+setup(void)
+{
+	g_win_factory = b3_win_factory_new();
+}
+
+static void
+teardown(void)
+{
+	b3_win_factory_free(g_win_factory);
+}
+
+static int
+test_create_same(void)
+{
+	b3_win_t *win;
+
+	win = b3_win_factory_win_create(g_win_factory, (HWND) 1);
+
+	if (win == NULL) {
+		return 1;
+	}
+
+	if (b3_win_factory_win_create(g_win_factory, (HWND) 1) != win) {
+		return 1;
+	}
+
+	if (b3_win_factory_win_create(g_win_factory, (HWND) 2) == win) {
+		return 1;
+	}
+
+	return 0;
+}
+
+static int
+test_get(void)
+{
+	b3_win_t *win;
+
+	if (b3_win_factory_win_get(g_win_factory, (HWND) 1)) {
+		return 1;
+	}
+
+	win = b3_win_factory_win_create(g_win_factory, (HWND) 1);
+
+	if (b3_win_factory_win_get(g_win_factory, (HWND) 1) != win) {
+		return 1;
+	}
+
+	return 0;
+}
+
+static int
+test_free(void)
+{
+	b3_win_t *win;
+	int i;
+
+	for (i = 1; i <= WIN_COUNT; i++) {
+		b3_win_factory_win_create(g_win_factory, (HWND) (INT_PTR) i);
+	}
+
+	for (i = 1; i <= WIN_COUNT; i += 2) {
+		win = b3_win_factory_win_get(g_win_factory, (HWND) (INT_PTR) i);
+		if (b3_win_factory_win_free(g_win_factory, win)) {
+			return 1;
+		}
+	}
+
+	for (i = 1; i <= WIN_COUNT; i++) {
+		win = b3_win_factory_win_get(g_win_factory, (HWND) (INT_PTR) i);
+		if ((i % 2 == 1 && win) || (i % 2 == 0 && win == NULL)) {
+			return 1;
+		}
+	}
+
+	if (hashtable_size(g_win_factory->win_table) != WIN_COUNT / 2) {
+		return 1;
+	}
+
+	return 0;
+}
+
+static int
+test_handle_stale(void)
+{
+	b3_win_t *win;
+	b3_win_handle_t handle;
+	b3_win_handle_t other_handle;
+
+	win = b3_win_factory_win_create(g_win_factory, (HWND) 1);
+	handle = b3_win_get_handle(win);
+
+	if (handle == B3_WIN_HANDLE_NULL || b3_win_from_handle(handle) != win) {
+		return 1;
+	}
+
+	b3_win_factory_win_free(g_win_factory, win);
+
+	if (b3_win_from_handle(handle)) {
+		return 1;
+	}
+
+	/**
+	 * The new window reuses the slot, but not the handle.
+	 */
+	win = b3_win_factory_win_create(g_win_factory, (HWND) 2);
+	other_handle = b3_win_get_handle(win);
+
+	if (other_handle == handle || b3_win_from_handle(handle)) {
+		return 1;
+	}
+
+	if (b3_win_from_handle(other_handle) != win) {
+		return 1;
+	}
+
+	return 0;
+}
+
+int
+main(void)
+{
+	b3_test(setup, teardown, test_create_same, "test_create_same");
+	b3_test(setup, teardown, test_get, "test_get");
+	b3_test(setup, teardown, test_free, "test_free");
+	b3_test(setup, teardown, test_handle_stale, "test_handle_stale");
+
+	return 0;
+}
@@ -0,0 +1,438 @@
+/******************************************************************************
+  This file is part of b3.
+
+  Copyright 2020-2021 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * @author Richard Bäck <richard.baeck@mailbox.org>
+ * @date 2021-04-17
+ * @brief File contains the tests for the win_positioner class
+ */
+
+#include "../src/win_positioner.h"
+#include "../src/win.h"
+
+#include "test.h"
+
+#include <string.h>
+
+#define POS_ARR_LEN 16
+
+static int g_commit_count;
+static int g_pos_arr_i;
+static b3_win_pos_t g_pos_arr[POS_ARR_LEN];
+static RECT g_real_rect;
+static char g_real_iconic;
+
+/**
+ * Fake positioning sink recording the positions instead of moving windows.
+ */
+static int
+record_sink(const b3_win_pos_t *pos_arr, int length, void *data)
+{
+	int i;
+
+	g_commit_count++;
+	for (i = 0; i < length; i++) {
+		if (g_pos_arr_i < POS_ARR_LEN) {
+			g_pos_arr[g_pos_arr_i] = pos_arr[i];
+		}
+		g_pos_arr_i++;
+	}
+
+	return 0;
+}
+
+/**
+ * Fake placement reader returning the state of the window on the screen.
+ */
+static int
+fake_placement_reader(HWND window_handler, RECT *rect, char *iconic)
+{
+	*rect = g_real_rect;
+	*iconic = g_real_iconic;
+
+	return 0;
+}
+
+static b3_win_pos_t
+create_pos(HWND window_handler, int left, int right)
+{
+	b3_win_pos_t pos;
+
+	memset(&pos, 0, sizeof(b3_win_pos_t));
+	pos.window_handler = window_handler;
+	pos.rect.left = left;
+	pos.rect.right = right;
+	pos.rect.top = 0;
+	pos.rect.bottom = 100;
+
+	return pos;
+}
+
+static void
+setup(void)
+{
+	g_commit_count = 0;
+	g_pos_arr_i = 0;
+	memset(g_pos_arr, 0, sizeof(g_pos_arr));
+	memset(&g_real_rect, 0, sizeof(RECT));
+	g_real_iconic = 0;
+
+	b3_win_set_placement_reader(fake_placement_reader);
+}
+
+static void
+teardown(void)
+{
+	b3_win_set_placement_reader(NULL);
+}
+
+static int
+test_latest_pos_wins(void)
+{
+	int error;
+	b3_win_positioner_t *positioner;
+	b3_win_pos_t pos;
+
+	positioner = b3_win_positioner_new(record_sink, NULL);
+
+	pos = create_pos((HWND) 1, 0, 10);
+	b3_win_positioner_push(positioner, &pos, 1);
+	pos = create_pos((HWND) 2, 10, 20);
+	b3_win_positioner_push(positioner, &pos, 1);
+	pos = create_pos((HWND) 1, 0, 30);
+	b3_win_positioner_push(positioner, &pos, 1);
+	pos = create_pos((HWND) 1, 0, 40);
+	b3_win_positioner_push(positioner, &pos, 1);
+
+	error = b3_test_check_int(b3_win_positioner_process(positioner), 2, "Unexpected count of applied positions.");
+
+	if (!error) {
+		error = b3_test_check_int(g_commit_count, 1, "Positions were not committed at once.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_pos_arr_i, 2, "Unexpected count of committed positions.");
+	}
+
+	if (!error) {
+		error = b3_test_check_void(g_pos_arr[0].window_handler, (HWND) 1, "First requested window is not applied first.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_pos_arr[0].rect.right, 40, "Latest position was not applied.");
+	}
+
+	if (!error) {
+		error = b3_test_check_void(g_pos_arr[1].window_handler, (HWND) 2, "Second window is missing.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(positioner->merge_count, 2, "Unexpected count of merged positions.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(b3_win_positioner_process(positioner), 0, "Positions were applied twice.");
+	}
+
+	b3_win_positioner_free(positioner);
+
+	return error;
+}
+
+static int
+test_push_after_process(void)
+{
+	int error;
+	b3_win_positioner_t *positioner;
+	b3_win_pos_t pos;
+
+	positioner = b3_win_positioner_new(record_sink, NULL);
+
+	pos = create_pos((HWND) 1, 0, 10);
+	b3_win_positioner_push(positioner, &pos, 1);
+	b3_win_positioner_process(positioner);
+
+	error = b3_test_check_int(array_size(positioner->free_pos_arr), 1, "Entry was not given back.");
+
+	if (!error) {
+		pos = create_pos((HWND) 1, 0, 20);
+		b3_win_positioner_push(positioner, &pos, 1);
+		error = b3_test_check_int(array_size(positioner->free_pos_arr), 0, "Entry was not reused.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(b3_win_positioner_process(positioner), 1, "Window was not positioned again.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_pos_arr[1].rect.right, 20, "New position was not applied.");
+	}
+
+	b3_win_positioner_free(positioner);
+
+	return error;
+}
+
+static int
+test_worker(void)
+{
+	int error;
+	b3_win_positioner_t *positioner;
+	b3_win_pos_t pos;
+	int i;
+
+	positioner = b3_win_positioner_new(record_sink, NULL);
+	positioner->settle_delay = 0;
+
+	error = b3_win_positioner_start(positioner);
+
+	if (!error) {
+		pos = create_pos((HWND) 1, 0, 10);
+		b3_win_positioner_push(positioner, &pos, 1);
+
+		for (i = 0; i < 1000 && g_pos_arr_i < 1; i++) {
+			Sleep(1);
+		}
+
+		error = b3_win_positioner_stop(positioner);
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_pos_arr_i, 1, "Worker did not apply the position.");
+	}
+
+	b3_win_positioner_free(positioner);
+
+	return error;
+}
+
+static int
+test_win_show(void)
+{
+	int error;
+	b3_win_positioner_t *positioner;
+	b3_win_t *win;
+	RECT rect;
+
+	positioner = b3_win_positioner_new(record_sink, NULL);
+	b3_win_set_positioner(positioner);
+
+	win = b3_win_new((HWND) 1, 0);
+	rect.left = 0;
+	rect.right = 10;
+	rect.top = 0;
+	rect.bottom = 10;
+
+	b3_win_set_rect(win, rect);
+	g_real_rect = rect;
+	b3_win_show(win, 0);
+	b3_win_show(win, 0);
+
+	error = b3_test_check_int(positioner->push_count, 1, "Unchanged window was shown again.");
+
+	if (!error) {
+		rect.right = 20;
+		b3_win_set_rect(win, rect);
+		g_real_rect = rect;
+		b3_win_show(win, 0);
+		b3_win_show(win, 1);
+
+		error = b3_test_check_int(positioner->push_count, 3, "Changed window was not shown.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(b3_win_positioner_process(positioner), 1, "Positions of the window were not merged.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_pos_arr[0].topmost, 1, "Latest z-state was not applied.");
+	}
+
+	b3_win_set_positioner(NULL);
+	b3_win_positioner_free(positioner);
+	b3_win_free(win);
+
+	return error;
+}
+
+static int
+test_win_show_changed(void)
+{
+	int error;
+	b3_win_positioner_t *positioner;
+	b3_win_t *win;
+	RECT rect;
+
+	positioner = b3_win_positioner_new(record_sink, NULL);
+	b3_win_set_positioner(positioner);
+
+	win = b3_win_new((HWND) 1, 0);
+	rect.left = 0;
+	rect.right = 10;
+	rect.top = 0;
+	rect.bottom = 10;
+
+	b3_win_set_rect(win, rect);
+	g_real_rect = rect;
+	b3_win_show(win, 0);
+
+	/**
+	 * The user snaps the window somewhere else.
+	 */
+	g_real_rect.right = 50;
+	error = b3_test_check_int(b3_win_is_shown(win, 0), 0, "Moved window is still shown.");
+
+	if (!error) {
+		b3_win_show(win, 0);
+		error = b3_test_check_int(positioner->push_count, 2, "Moved window was not shown again.");
+	}
+
+	if (!error) {
+		g_real_rect = rect;
+		b3_win_show(win, 0);
+		error = b3_test_check_int(positioner->push_count, 2, "Restored window was shown again.");
+	}
+
+	/**
+	 * The user minimizes the window.
+	 */
+	if (!error) {
+		g_real_iconic = 1;
+		b3_win_show(win, 0);
+		error = b3_test_check_int(positioner->push_count, 3, "Minimized window was not shown again.");
+	}
+
+	b3_win_set_positioner(NULL);
+	b3_win_positioner_free(positioner);
+	b3_win_free(win);
+
+	return error;
+}
+
+static int
+test_win_minimize(void)
+{
+	int error;
+	b3_win_positioner_t *positioner;
+	b3_win_t *win;
+	RECT rect;
+
+	positioner = b3_win_positioner_new(record_sink, NULL);
+	b3_win_set_positioner(positioner);
+
+	win = b3_win_new((HWND) 1, 0);
+	rect.left = 0;
+	rect.right = 10;
+	rect.top = 0;
+	rect.bottom = 10;
+
+	b3_win_set_rect(win, rect);
+	g_real_rect = rect;
+	b3_win_show(win, 0);
+	b3_win_minimize(win);
+
+	error = b3_test_check_int(b3_win_positioner_process(positioner), 1, "Minimizing was not merged with the pending show.");
+
+	if (!error) {
+		error = b3_test_check_int(g_pos_arr[0].minimized, 1, "Pending show was applied after minimizing.");
+	}
+
+	if (!error) {
+		b3_win_show(win, 0);
+		b3_win_positioner_process(positioner);
+		error = b3_test_check_int(g_pos_arr[1].minimized, 0, "Minimized window was not shown again.");
+	}
+
+	b3_win_set_positioner(NULL);
+	b3_win_positioner_free(positioner);
+	b3_win_free(win);
+
+	return error;
+}
+
+static int
+test_batch(void)
+{
+	int error;
+	b3_win_batch_t *batch;
+	b3_win_pos_t pos;
+	int i;
+
+	batch = b3_win_batch_new(record_sink, NULL);
+
+	b3_win_batch_begin(batch);
+	error = b3_win_batch_commit(batch);
+
+	if (!error) {
+		error = b3_test_check_int(g_commit_count, 0, "Empty batch was committed.");
+	}
+
+	if (!error) {
+		pos = create_pos((HWND) 1, 0, 10);
+		b3_win_batch_add_pos(batch, &pos);
+		b3_win_batch_begin(batch);
+
+		for (i = 0; i < POS_ARR_LEN; i++) {
+			pos = create_pos((HWND) (LONG_PTR) (i + 1), i, i + 1);
+			b3_win_batch_add_pos(batch, &pos);
+		}
+
+		error = b3_win_batch_commit(batch);
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_commit_count, 1, "Batch was not committed at once.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_pos_arr_i, POS_ARR_LEN, "Positions added before begin were committed.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_pos_arr[POS_ARR_LEN - 1].rect.left, POS_ARR_LEN - 1, "Positions are not in order.");
+	}
+
+	if (!error) {
+		b3_win_batch_commit(batch);
+		error = b3_test_check_int(g_commit_count, 1, "Batch was committed twice.");
+	}
+
+	b3_win_batch_free(batch);
+
+	return error;
+}
+
+int
+main(void)
+{
+	b3_test(setup, teardown, test_latest_pos_wins, "test_latest_pos_wins");
+	b3_test(setup, teardown, test_push_after_process, "test_push_after_process");
+	b3_test(setup, teardown, test_worker, "test_worker");
+	b3_test(setup, teardown, test_win_show, "test_win_show");
+	b3_test(setup, teardown, test_win_show_changed, "test_win_show_changed");
+	b3_test(setup, teardown, test_win_minimize, "test_win_minimize");
+	b3_test(setup, teardown, test_batch, "test_batch");
+
+	return 0;
+}
@@ -0,0 +1,230 @@
+/******************************************************************************
+  This file is part of b3.
+
+  Copyright 2020-2021 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * @author Richard Bäck <richard.baeck@mailbox.org>
+ * @date 2021-04-17
+ * @brief File contains the tests for the win_watcher class
+ */
+
+#include "../src/win_watcher.h"
+
+#include "test.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define STORM_EVENT_COUNT 100
+#define STORM_WIN_COUNT 4
+#define MANAGABLE_ARR_LEN 16
+
+static b3_director_t *g_director;
+static b3_win_factory_t *g_win_factory;
+static b3_win_watcher_t *g_win_watcher;
+
+static int g_managable_arr_i;
+static HWND g_managable_arr[MANAGABLE_ARR_LEN];
+
+/**
+ * Fake managability check. It records every window the handlers of the
+ * watcher ask for and never lets them reach the director.
+ */
+static int
+fake_managable(b3_win_watcher_t *win_watcher, HWND window_handler)
+{
+	if (g_managable_arr_i < MANAGABLE_ARR_LEN) {
+		g_managable_arr[g_managable_arr_i] = window_handler;
+	}
+	g_managable_arr_i++;
+
+	return 0;
+}
+
+/**
+ * Creates a message-only window using the window procedure of the watcher,
+ * like b3_win_watcher_start() does for the shell hook window.
+ */
+static HWND
+create_watcher_window(b3_win_watcher_t *win_watcher)
+{
+	HINSTANCE hInstance;
+	WNDCLASSEX wc;
+	HWND window_handler;
+	char classname[] = "b3 test win watcher";
+
+	hInstance = GetModuleHandle(NULL);
+
+	memset(&wc, 0, sizeof(WNDCLASSEX));
+	wc.cbSize = sizeof(WNDCLASSEX);
+	wc.lpfnWndProc = b3_win_watcher_wnd_proc;
+	wc.hInstance = hInstance;
+	wc.lpszClassName = classname;
+
+	/**
+	 * Fails from the second test on, because the class is already registered.
+	 */
+	RegisterClassEx(&wc);
+
+	window_handler = CreateWindowEx(0,
+									classname,
+									classname,
+									0,
+									0, 0,
+									0, 0,
+									HWND_MESSAGE, NULL, hInstance, NULL);
+	if (window_handler) {
+		win_watcher->shellhookid = RegisterWindowMessageW(L"SHELLHOOK");
+		SetWindowLongPtr(window_handler, GWLP_USERDATA, (LONG_PTR) win_watcher);
+
+		win_watcher->window_handler = window_handler;
+	}
+
+	return window_handler;
+}
+
+static void
+setup(void)
+{
+	g_managable_arr_i = 0;
+	memset(g_managable_arr, 0, sizeof(g_managable_arr));
+
+	g_director = b3_director_new(NULL);
+	b3_director_set_new_win_grace_period(g_director, 10000);
+
+	g_win_factory = b3_win_factory_new();
+	g_win_watcher = b3_win_watcher_new(g_win_factory, g_director);
+	g_win_watcher->b3_win_watcher_managable_window_handler = fake_managable;
+	create_watcher_window(g_win_watcher);
+}
+
+static void
+teardown(void)
+{
+	b3_win_watcher_free(g_win_watcher);
+	g_win_watcher = NULL;
+
+	b3_win_factory_free(g_win_factory);
+	g_win_factory = NULL;
+
+	b3_director_free(g_director);
+	g_director = NULL;
+}
+
+static int
+test_grace_period_configured(void)
+{
+	return b3_test_check_int(g_win_watcher->event_queue->grace_period, 10000, "Grace period of the director was not used.");
+}
+
+static int
+test_activation_storm(void)
+{
+	int error;
+	int i;
+
+	error = b3_test_check_int(g_win_watcher->window_handler != NULL, 1, "Window of the watcher was not created.");
+
+	for (i = 0; !error && i < STORM_EVENT_COUNT; i++) {
+		SendMessage(g_win_watcher->window_handler,
+					g_win_watcher->shellhookid,
+					HSHELL_WINDOWACTIVATED,
+					(LPARAM) (i % STORM_WIN_COUNT + 1));
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_win_watcher->event_queue->push_count, STORM_EVENT_COUNT, "Activations did not reach the queue.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(b3_win_event_queue_process(g_win_watcher->event_queue), 1, "Activations were not merged.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_win_watcher->event_queue->merge_count, STORM_EVENT_COUNT - 1, "Unexpected count of merged activations.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_managable_arr_i, 1, "Unexpected count of handled activations.");
+	}
+
+	if (!error) {
+		error = b3_test_check_void(g_managable_arr[0], (HWND) STORM_WIN_COUNT, "Last activation was not handled.");
+	}
+
+	return error;
+}
+
+static int
+test_short_lived(void)
+{
+	int error;
+
+	error = b3_test_check_int(g_win_watcher->window_handler != NULL, 1, "Window of the watcher was not created.");
+
+	if (!error) {
+		SendMessage(g_win_watcher->window_handler, g_win_watcher->shellhookid, HSHELL_WINDOWCREATED, (LPARAM) 1);
+		SendMessage(g_win_watcher->window_handler, g_win_watcher->shellhookid, HSHELL_WINDOWACTIVATED, (LPARAM) 1);
+		SendMessage(g_win_watcher->window_handler, g_win_watcher->shellhookid, HSHELL_WINDOWDESTROYED, (LPARAM) 1);
+
+		error = b3_test_check_int(b3_win_event_queue_process(g_win_watcher->event_queue), 0, "Events of the short-lived window were handled.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_win_watcher->event_queue->drop_count, 3, "Unexpected count of dropped events.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_managable_arr_i, 0, "Short-lived window was checked.");
+	}
+
+	return error;
+}
+
+static int
+test_ignore_other_messages(void)
+{
+	int error;
+
+	error = b3_test_check_int(g_win_watcher->window_handler != NULL, 1, "Window of the watcher was not created.");
+
+	if (!error) {
+		SendMessage(g_win_watcher->window_handler, g_win_watcher->shellhookid, HSHELL_GETMINRECT, (LPARAM) 1);
+		SendMessage(g_win_watcher->window_handler, WM_NULL, HSHELL_WINDOWCREATED, (LPARAM) 1);
+
+		error = b3_test_check_int(g_win_watcher->event_queue->push_count, 0, "Unknown message was queued.");
+	}
+
+	return error;
+}
+
+int
+main(void)
+{
+	b3_test(setup, teardown, test_grace_period_configured, "test_grace_period_configured");
+	b3_test(setup, teardown, test_activation_storm, "test_activation_storm");
+	b3_test(setup, teardown, test_short_lived, "test_short_lived");
+	b3_test(setup, teardown, test_ignore_other_messages, "test_ignore_other_messages");
+
+	return 0;
+}
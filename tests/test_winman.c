@@ -51,6 +51,16 @@ visitor(b3_winman_t *winman, void *data) {
 	}
 }
 
+static int
+visitor_until(b3_winman_t *winman, void *data) {
+	int *stop_after;
+
+	visitor(winman, NULL);
+
+	stop_after = (int *) data;
+	return stop_after && g_arr_i >= *stop_after;
+}
+
 static void
 setup(void)
 {
@@ -93,6 +103,114 @@ test_simple_tree(void)
 	return error;
 }
 
+static b3_winman_t *
+create_simple_tree(void)
+{
+	b3_winman_t *root;
+	b3_winman_t *inner;
+
+	root = b3_winman_new(VERTICAL);
+
+	inner = b3_winman_new(VERTICAL);
+	b3_winman_add_winman(root, inner);
+	b3_winman_add_winman(inner, b3_winman_new(VERTICAL));
+	b3_winman_add_winman(inner, b3_winman_new(VERTICAL));
+
+	inner = b3_winman_new(VERTICAL);
+	b3_winman_add_winman(root, inner);
+	b3_winman_add_winman(inner, b3_winman_new(VERTICAL));
+	b3_winman_add_winman(inner, b3_winman_new(VERTICAL));
+	b3_winman_add_winman(inner, b3_winman_new(VERTICAL));
+	b3_winman_add_winman(inner, b3_winman_new(VERTICAL));
+
+	return root;
+}
+
+static int
+test_traverse_until(void)
+{
+	b3_winman_t *root;
+	int stop_after;
+	int error;
+
+	root = create_simple_tree();
+
+	memset(g_arr, 0, ARR_LEN * sizeof(char));
+	g_arr_i = 0;
+	error = b3_winman_traverse_until(root, POST_ORDER, visitor_until, NULL);
+
+	if (!error) {
+		error = strcmp(g_arr, "LLILLLLII");
+	}
+
+	if (!error) {
+		memset(g_arr, 0, ARR_LEN * sizeof(char));
+		g_arr_i = 0;
+		stop_after = 4;
+		error = !b3_winman_traverse_until(root, PRE_ORDER, visitor_until, &stop_after);
+	}
+
+	if (!error) {
+		error = strcmp(g_arr, "IILL");
+	}
+
+	if (!error) {
+		memset(g_arr, 0, ARR_LEN * sizeof(char));
+		g_arr_i = 0;
+		stop_after = 3;
+		error = !b3_winman_traverse_until(root, POST_ORDER, visitor_until, &stop_after);
+	}
+
+	if (!error) {
+		error = strcmp(g_arr, "LLI");
+	}
+
+	b3_winman_free(root);
+
+	return error;
+}
+
+static int
+test_traverse_deep(void)
+{
+	b3_winman_t *root;
+	b3_winman_t *inner;
+	b3_winman_t *leaf;
+	int depth;
+	int error;
+	int i;
+
+	depth = 100000;
+
+	root = b3_winman_new(VERTICAL);
+	inner = root;
+	for (i = 1; i < depth; i++) {
+		leaf = b3_winman_new(VERTICAL);
+		b3_winman_add_winman(inner, leaf);
+		inner = leaf;
+	}
+
+	g_arr_i = 0;
+	error = b3_winman_traverse_until(root, POST_ORDER, visitor_until, NULL);
+
+	if (!error) {
+		error = b3_test_check_int(g_arr_i, depth % ARR_LEN, "Not all nodes were visited.");
+	}
+
+	/**
+	 * Free the chain from the bottom, so that freeing does not recurse.
+	 */
+	while (inner != root) {
+		leaf = inner;
+		inner = leaf->parent;
+		b3_winman_remove_winman(inner, leaf);
+		b3_winman_free(leaf);
+	}
+	b3_winman_free(root);
+
+	return error;
+}
+
 static int
 test_remove_winman(void)
 {
@@ -191,6 +309,188 @@ test_get_parent(void)
 	return error;
 }
 
+static int
+test_get_parent_after_reparent(void)
+{
+	b3_winman_t *root;
+	b3_winman_t *other_root;
+	b3_winman_t *inner_1;
+	b3_winman_t *inner_2;
+	b3_winman_t *leaf;
+	int error;
+
+	root = b3_winman_new(VERTICAL);
+	other_root = b3_winman_new(VERTICAL);
+
+	inner_1 = b3_winman_new(VERTICAL);
+	b3_winman_add_winman(root, inner_1);
+	inner_2 = b3_winman_new(VERTICAL);
+	b3_winman_add_winman(root, inner_2);
+
+	leaf = b3_winman_new(VERTICAL);
+	b3_winman_add_winman(inner_1, leaf);
+
+	error = b3_test_check_void(b3_winman_get_parent(root, leaf), inner_1,
+							   "Parent after adding.");
+
+	if (!error) {
+		error = b3_test_check_void(b3_winman_get_parent(root, root), NULL,
+								   "Parent of the root.");
+	}
+
+	if (!error) {
+		error = b3_test_check_void(b3_winman_get_parent(other_root, leaf), NULL,
+								   "Parent within a foreign root.");
+	}
+
+	if (!error) {
+		b3_winman_add_winman(inner_2, leaf);
+		error = b3_test_check_int(array_size(b3_winman_get_winman_arr(inner_1)), 0,
+								  "Old parent still contains the window manager.");
+	}
+
+	if (!error) {
+		error = b3_test_check_void(b3_winman_get_parent(root, leaf), inner_2,
+								   "Parent after re-adding.");
+	}
+
+	if (!error) {
+		error = b3_winman_remove_winman(root, leaf);
+	}
+
+	if (!error) {
+		error = b3_test_check_void(b3_winman_get_parent(root, leaf), NULL,
+								   "Parent after removing.");
+	}
+
+	b3_winman_free(root);
+	b3_winman_free(other_root);
+	b3_winman_free(leaf);
+
+	return error;
+}
+
+static int
+test_win_count(void)
+{
+	b3_winman_t *root;
+	b3_winman_t *inner;
+	b3_winman_t *leaf1;
+	b3_winman_t *leaf2;
+	b3_win_t *win1;
+	b3_win_t *win2;
+	int error;
+
+	win1 = b3_win_new((HWND) 1, 0);
+	win2 = b3_win_new((HWND) 2, 0);
+
+	root = b3_winman_new(VERTICAL);
+	inner = b3_winman_new(HORIZONTAL);
+	b3_winman_add_winman(root, inner);
+
+	leaf1 = b3_winman_new(UNSPECIFIED);
+	b3_winman_set_win(leaf1, win1);
+	b3_winman_add_winman(inner, leaf1);
+
+	leaf2 = b3_winman_new(UNSPECIFIED);
+	b3_winman_add_winman(inner, leaf2);
+	b3_winman_set_win(leaf2, win2);
+
+	error = b3_test_check_int(b3_winman_get_win_count(root), 2, "Count after adding.");
+
+	if (!error) {
+		error = b3_test_check_int(b3_winman_is_empty(inner, 1), 0, "Inner is empty.");
+	}
+
+	if (!error) {
+		b3_winman_remove_winman(root, leaf1);
+		error = b3_test_check_int(b3_winman_get_win_count(root), 1, "Count after removing.");
+	}
+
+	if (!error) {
+		b3_winman_add_winman(root, leaf1);
+		error = b3_test_check_int(b3_winman_get_win_count(inner), 1, "Count after moving.");
+	}
+
+	if (!error) {
+		b3_winman_set_win(leaf2, NULL);
+		error = b3_test_check_int(b3_winman_is_empty(inner, 1), 1, "Inner is not empty.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(b3_winman_get_win_count(root), 1, "Count after unsetting.");
+	}
+
+	b3_winman_free(root);
+	b3_win_free(win1);
+	b3_win_free(win2);
+
+	return error;
+}
+
+static int
+test_reorg_path(void)
+{
+	b3_winman_t *root;
+	b3_winman_t *sibling;
+	b3_winman_t *inner;
+	b3_winman_t *inner_inner;
+	b3_winman_t *leaf1;
+	b3_winman_t *leaf2;
+	b3_win_t *win1;
+	b3_win_t *win2;
+	int error;
+
+	win1 = b3_win_new((HWND) 1, 0);
+	win2 = b3_win_new((HWND) 2, 0);
+
+	root = b3_winman_new(VERTICAL);
+
+	sibling = b3_winman_new(HORIZONTAL);
+	b3_winman_add_winman(root, sibling);
+	leaf1 = b3_winman_new(UNSPECIFIED);
+	b3_winman_set_win(leaf1, win1);
+	b3_winman_add_winman(sibling, leaf1);
+
+	inner = b3_winman_new(HORIZONTAL);
+	b3_winman_add_winman(root, inner);
+	inner_inner = b3_winman_new(VERTICAL);
+	b3_winman_add_winman(inner, inner_inner);
+	leaf2 = b3_winman_new(UNSPECIFIED);
+	b3_winman_set_win(leaf2, win2);
+	b3_winman_add_winman(inner_inner, leaf2);
+
+	b3_winman_remove_winman(inner_inner, leaf2);
+	b3_winman_free(leaf2);
+
+	error = b3_winman_reorg_path(root, inner_inner);
+
+	if (!error) {
+		error = b3_test_check_int(array_size(b3_winman_get_winman_arr(root)), 1, "Root contains the empty path.");
+	}
+
+	if (!error) {
+		error = b3_test_check_void(b3_winman_get_parent(root, leaf1), sibling, "Non-empty sibling was modified.");
+	}
+
+	if (!error) {
+		b3_winman_remove_winman(sibling, leaf1);
+		b3_winman_free(leaf1);
+
+		error = b3_winman_reorg_path(root, sibling);
+	}
+
+	if (!error) {
+		error = b3_test_check_int(array_size(b3_winman_get_winman_arr(root)), 0, "Root was not kept.");
+	}
+
+	b3_winman_free(root);
+	b3_win_free(win1);
+	b3_win_free(win2);
+
+	return error;
+}
+
 static int
 test_contains_win(void)
 {
@@ -328,9 +628,14 @@ int
 main(void)
 {
 	b3_test(setup, teardown, test_simple_tree, "test_simple_tree");
+	b3_test(setup, teardown, test_traverse_until, "test_traverse_until");
+	b3_test(setup, teardown, test_traverse_deep, "test_traverse_deep");
 	b3_test(setup, teardown, test_remove_winman, "test_remove_winman");
 	b3_test(setup, teardown, test_get_parent, "test_get_parent");
+	b3_test(setup, teardown, test_get_parent_after_reparent, "test_get_parent_after_reparent");
 	b3_test(setup, teardown, test_contains_win, "test_contains_win");
+	b3_test(setup, teardown, test_win_count, "test_win_count");
+	b3_test(setup, teardown, test_reorg_path, "test_reorg_path");
 	b3_test(setup, teardown, test_simple_get_rel, "test_simple_get_rel");
 
 	return 0;
@@ -33,10 +33,15 @@
 #include "test.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <w32bindkeys/logger.h>
 
 #define ARR_LEN 10
 
+#define SCALING_ROUNDS 10
+
+#define LAYOUT_ROUNDS 100
+
 static wbk_logger_t logger = { "test_ws" };
 
 static int g_winman_arr_i;
@@ -1456,6 +1461,539 @@ test_complex_arrange(void)
 	return error;
 }
 
+static int g_traverse_count;
+static int (*g_traverse_until)(b3_winman_t *winman,
+							   b3_winman_traverse_order_t order,
+							   int visitor(b3_winman_t *winman, void *data),
+							   void *data);
+
+/**
+ * Counts the traversals of the tree of a workspace.
+ */
+static int
+counting_traverse_until(b3_winman_t *winman,
+						b3_winman_traverse_order_t order,
+						int visitor(b3_winman_t *winman, void *data),
+						void *data)
+{
+	g_traverse_count++;
+	return g_traverse_until(winman, order, visitor, data);
+}
+
+/**
+ * @param traverse_count Set to the number of traversals of the tree during
+ * the lookups.
+ * @return The average time of one b3_ws_contains_win() call in nanoseconds on
+ * a workspace containing win_count windows. Every tenth window is floating.
+ */
+static double
+measure_contains_win(int win_count, int *traverse_count)
+{
+	b3_ws_t *ws;
+	b3_win_t **win_arr;
+	LARGE_INTEGER frequency;
+	LARGE_INTEGER start;
+	LARGE_INTEGER end;
+	int found;
+	int i;
+	int j;
+
+	win_arr = malloc(sizeof(b3_win_t *) * win_count);
+
+	ws = b3_ws_new("test");
+	for (i = 0; i < win_count; i++) {
+		win_arr[i] = b3_win_new((HWND) (LONG_PTR) (i + 1), i % 10 == 0);
+		b3_ws_add_win(ws, win_arr[i]);
+	}
+
+	g_traverse_count = 0;
+	g_traverse_until = ws->winman->b3_winman_traverse_until;
+	ws->winman->b3_winman_traverse_until = counting_traverse_until;
+
+	found = 0;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&start);
+	for (j = 0; j < SCALING_ROUNDS; j++) {
+		for (i = 0; i < win_count; i++) {
+			if (b3_ws_contains_win(ws, win_arr[i])) {
+				found++;
+			}
+		}
+	}
+	QueryPerformanceCounter(&end);
+
+	ws->winman->b3_winman_traverse_until = g_traverse_until;
+	*traverse_count = g_traverse_count;
+
+	if (found != win_count * SCALING_ROUNDS) {
+		wbk_logger_log(&logger, SEVERE, "Only found %d of %d windows\n",
+					   found, win_count * SCALING_ROUNDS);
+	}
+
+	b3_ws_free(ws);
+	for (i = 0; i < win_count; i++) {
+		b3_win_free(win_arr[i]);
+	}
+	free(win_arr);
+
+	return (double) (end.QuadPart - start.QuadPart) * 1000000000.0
+		/ (double) frequency.QuadPart
+		/ (double) (win_count * SCALING_ROUNDS);
+}
+
+static int
+test_contains_win_scaling(void)
+{
+	int error;
+	double time;
+	int traverse_count;
+	int win_count_arr[] = { 1000, 2500, 5000, 10000 };
+	int i;
+
+	error = 0;
+
+	/**
+	 * The timings are only informative. The lookups must not walk the tree,
+	 * so they stay flat.
+	 */
+	for (i = 0; !error && i < 4; i++) {
+		time = measure_contains_win(win_count_arr[i], &traverse_count);
+		fprintf(stdout, "contains_win with %5d windows: %8.1f ns/lookup\n", win_count_arr[i], time);
+
+		error = b3_test_check_int(traverse_count, 0, "Lookups traversed the tree.");
+	}
+
+	return error;
+}
+
+static int
+test_winman_factory_steady_state(void)
+{
+	int error;
+	b3_ws_t *ws;
+	b3_win_t *win_arr[4];
+	size_t slab_count;
+	int i;
+
+	error = 0;
+
+	for (i = 0; i < 4; i++) {
+		win_arr[i] = b3_win_new((HWND) (LONG_PTR) (i + 1), 0);
+	}
+
+	ws = b3_ws_new("test");
+	b3_ws_add_win(ws, win_arr[0]);
+	b3_ws_add_win(ws, win_arr[1]);
+
+	/**
+	 * The factory only allocates by adding slabs.
+	 */
+	slab_count = array_size(ws->winman_factory->slab_arr);
+
+	for (i = 0; !error && i < 1000; i++) {
+		b3_ws_add_win(ws, win_arr[2]);
+		b3_ws_split(ws, VERTICAL);
+		b3_ws_add_win(ws, win_arr[3]);
+		b3_ws_split(ws, HORIZONTAL);
+		b3_ws_move_focused_win(ws, UP);
+		b3_ws_move_focused_win(ws, LEFT);
+		b3_ws_remove_win(ws, win_arr[3]);
+		b3_ws_remove_win(ws, win_arr[2]);
+
+		error = b3_test_check_int(array_size(ws->winman_factory->slab_arr),
+								  slab_count,
+								  "Window manager factory allocated in steady state.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(b3_ws_is_empty(ws), 0, "Workspace lost its windows.");
+	}
+
+	b3_ws_free(ws);
+	for (i = 0; i < 4; i++) {
+		b3_win_free(win_arr[i]);
+	}
+
+	return error;
+}
+
+/**
+ * @return 0 if the leaf areas of the last layout pass of ws exactly cover
+ * area, i.e. they do not overlap and leave no pixel uncovered.
+ */
+static int
+check_layout_cover(b3_ws_t *ws, RECT area)
+{
+	int error;
+	long covered;
+	RECT *a;
+	RECT *b;
+	int i;
+	int j;
+
+	error = 0;
+	covered = 0;
+	for (i = 0; !error && i < ws->leaf_area_count; i++) {
+		a = &(ws->leaf_area_arr[i]);
+		covered += (long) (a->right - a->left) * (long) (a->bottom - a->top);
+
+		if (a->left < area.left || a->right > area.right
+			|| a->top < area.top || a->bottom > area.bottom
+			|| a->left >= a->right || a->top >= a->bottom) {
+			fprintf(stdout, "Area %d is out of bounds or empty\n", i);
+			error = 1;
+		}
+
+		for (j = i + 1; !error && j < ws->leaf_area_count; j++) {
+			b = &(ws->leaf_area_arr[j]);
+			if (a->left < b->right && b->left < a->right
+				&& a->top < b->bottom && b->top < a->bottom) {
+				fprintf(stdout, "Area %d overlaps area %d\n", i, j);
+				error = 1;
+			}
+		}
+	}
+
+	if (!error) {
+		error = b3_test_check_int(covered,
+								  (area.right - area.left) * (area.bottom - area.top),
+								  "Areas do not cover the whole area.");
+	}
+
+	return error;
+}
+
+static int
+test_layout_exact_cover(void)
+{
+	int error;
+	b3_ws_t *ws;
+	RECT monitor_area;
+	b3_win_t *win_arr[5];
+	int i;
+
+	monitor_area.top = 7;
+	monitor_area.bottom = 1087;
+	monitor_area.left = -1001;
+	monitor_area.right = 0;
+
+	for (i = 0; i < 5; i++) {
+		win_arr[i] = b3_win_new((HWND) (LONG_PTR) (i + 1), 0);
+	}
+
+	ws = b3_ws_new("test");
+	b3_ws_add_win(ws, win_arr[0]);
+	b3_ws_add_win(ws, win_arr[1]);
+	b3_ws_add_win(ws, win_arr[2]);
+	b3_ws_split(ws, VERTICAL);
+	b3_ws_add_win(ws, win_arr[3]);
+	b3_ws_add_win(ws, win_arr[4]);
+	b3_ws_move_focused_win(ws, DOWN);
+
+	error = b3_ws_layout_wins(ws, monitor_area);
+
+	if (!error) {
+		error = b3_test_check_int(ws->leaf_area_count, 5, "Not all windows were laid out.");
+	}
+
+	if (!error) {
+		error = check_layout_cover(ws, monitor_area);
+	}
+
+	if (!error) {
+		/**
+		 * 1001 pixels on 3 columns: the first column gets the extra pixels.
+		 */
+		error = b3_test_check_int(ws->leaf_area_arr[0].right - ws->leaf_area_arr[0].left,
+								  334, "Remainder is not on the first column.");
+	}
+
+	b3_ws_free(ws);
+	for (i = 0; i < 5; i++) {
+		b3_win_free(win_arr[i]);
+	}
+
+	return error;
+}
+
+/**
+ * Opening a window only changes the tiles of the container it is added to. All
+ * other windows have the same area as before and are not shown again by
+ * b3_ws_arrange_wins().
+ */
+static int
+test_layout_changed_tiles(void)
+{
+	int error;
+	b3_ws_t *ws;
+	RECT monitor_area;
+	b3_win_t *win_arr[21];
+	RECT area_arr[21];
+	int changed;
+	int i;
+	int j;
+
+	monitor_area.top = 0;
+	monitor_area.bottom = 1080;
+	monitor_area.left = 0;
+	monitor_area.right = 1920;
+
+	for (i = 0; i < 21; i++) {
+		win_arr[i] = b3_win_new((HWND) (LONG_PTR) (i + 1), 0);
+	}
+
+	/**
+	 * 10 columns containing 2 windows each
+	 */
+	ws = b3_ws_new("test");
+	for (i = 0; i < 10; i++) {
+		b3_ws_add_win(ws, win_arr[i]);
+	}
+	for (i = 0; i < 10; i++) {
+		b3_ws_set_focused_win(ws, win_arr[i]);
+		b3_ws_split(ws, VERTICAL);
+		b3_ws_add_win(ws, win_arr[10 + i]);
+	}
+
+	error = b3_ws_layout_wins(ws, monitor_area);
+	if (!error) {
+		error = b3_test_check_int(ws->leaf_area_count, 20, "Not all windows were laid out.");
+	}
+
+	if (!error) {
+		for (i = 0; i < ws->leaf_area_count; i++) {
+			b3_win_set_rect(ws->leaf_win_arr[i], ws->leaf_area_arr[i]);
+		}
+		for (i = 0; i < 20; i++) {
+			area_arr[i] = b3_win_get_rect(win_arr[i]);
+		}
+
+		b3_ws_set_focused_win(ws, win_arr[3]);
+		b3_ws_add_win(ws, win_arr[20]);
+
+		error = b3_ws_layout_wins(ws, monitor_area);
+	}
+
+	if (!error) {
+		error = b3_test_check_int(ws->leaf_area_count, 21, "The new window was not laid out.");
+	}
+
+	if (!error) {
+		changed = 0;
+		for (i = 0; i < ws->leaf_area_count; i++) {
+			for (j = 0; j < 20; j++) {
+				if (ws->leaf_win_arr[i] == win_arr[j]
+					&& memcmp(&(ws->leaf_area_arr[i]), &(area_arr[j]), sizeof(RECT))) {
+					changed++;
+				}
+			}
+		}
+
+		error = b3_test_check_int(changed, 2, "Unexpected count of changed tiles.");
+	}
+
+	b3_ws_free(ws);
+	for (i = 0; i < 21; i++) {
+		b3_win_free(win_arr[i]);
+	}
+
+	return error;
+}
+
+static int g_commit_count;
+static int g_commit_length;
+static b3_win_pos_t g_commit_pos_arr[ARR_LEN];
+static RECT g_real_rect_arr[ARR_LEN];
+
+/**
+ * Recording backend of the positioning batch of a workspace. The windows are
+ * considered as moved to the committed positions.
+ */
+static int
+record_commit(const b3_win_pos_t *pos_arr, int length, void *data)
+{
+	int i;
+
+	g_commit_count++;
+	g_commit_length = length;
+	memcpy(g_commit_pos_arr, pos_arr, sizeof(b3_win_pos_t) * (length < ARR_LEN ? length : ARR_LEN));
+
+	for (i = 0; i < length; i++) {
+		if ((LONG_PTR) pos_arr[i].window_handler < ARR_LEN) {
+			g_real_rect_arr[(LONG_PTR) pos_arr[i].window_handler] = pos_arr[i].rect;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Fake placement reader returning the rects committed by record_commit().
+ */
+static int
+fake_placement_reader(HWND window_handler, RECT *rect, char *iconic)
+{
+	if ((LONG_PTR) window_handler >= ARR_LEN) {
+		return 1;
+	}
+
+	*rect = g_real_rect_arr[(LONG_PTR) window_handler];
+	*iconic = 0;
+
+	return 0;
+}
+
+static int
+test_arrange_batch(void)
+{
+	int error;
+	b3_ws_t *ws;
+	RECT monitor_area;
+	b3_win_t *win_arr[5];
+	int i;
+
+	g_commit_count = 0;
+	g_commit_length = 0;
+	memset(g_real_rect_arr, 0, sizeof(g_real_rect_arr));
+	b3_win_set_placement_reader(fake_placement_reader);
+
+	monitor_area.top = 0;
+	monitor_area.bottom = 1080;
+	monitor_area.left = 0;
+	monitor_area.right = 1920;
+
+	for (i = 0; i < 5; i++) {
+		win_arr[i] = b3_win_new((HWND) (LONG_PTR) (i + 1), 0);
+	}
+
+	ws = b3_ws_new("test");
+	ws->batch->commit = record_commit;
+	b3_ws_add_win(ws, win_arr[0]);
+	b3_ws_add_win(ws, win_arr[1]);
+	b3_ws_add_win(ws, win_arr[2]);
+	b3_ws_add_win(ws, win_arr[3]);
+	b3_ws_toggle_floating_win(ws, win_arr[3]);
+
+	b3_ws_arrange_wins(ws, monitor_area);
+
+	error = b3_test_check_int(g_commit_count, 1, "Arrangement was not committed at once.");
+
+	if (!error) {
+		error = b3_test_check_int(g_commit_length, 4, "Unexpected count of positions.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_commit_pos_arr[1].rect.left, 640, "Unexpected rect of a tile.");
+	}
+
+	if (!error) {
+		error = b3_test_check_void(g_commit_pos_arr[3].window_handler, (HWND) 4, "Floating window is not last.");
+	}
+
+	if (!error) {
+		error = b3_test_check_int(g_commit_pos_arr[3].topmost, 1, "Floating window is not on top.");
+	}
+
+	if (!error) {
+		/**
+		 * Nothing changed, only the floating window is raised again.
+		 */
+		b3_ws_arrange_wins(ws, monitor_area);
+		error = b3_test_check_int(g_commit_length, 1, "Unchanged tiles were positioned again.");
+	}
+
+	if (!error) {
+		b3_ws_set_focused_win(ws, win_arr[2]);
+		b3_ws_split(ws, VERTICAL);
+		b3_ws_add_win(ws, win_arr[4]);
+		b3_ws_arrange_wins(ws, monitor_area);
+
+		error = b3_test_check_int(g_commit_length, 3, "Unexpected count of changed windows.");
+	}
+
+	b3_ws_free(ws);
+	for (i = 0; i < 5; i++) {
+		b3_win_free(win_arr[i]);
+	}
+
+	b3_win_set_placement_reader(NULL);
+
+	return error;
+}
+
+static int
+test_layout_benchmark(void)
+{
+	int error;
+	b3_ws_t *ws;
+	RECT monitor_area;
+	b3_win_t **win_arr;
+	RECT *leaf_area_arr;
+	RECT *pending_area_arr;
+	LARGE_INTEGER frequency;
+	LARGE_INTEGER start;
+	LARGE_INTEGER end;
+	int win_count;
+	int i;
+
+	monitor_area.top = 0;
+	monitor_area.bottom = 1080;
+	monitor_area.left = 0;
+	monitor_area.right = 1920;
+
+	win_count = 1000;
+	win_arr = malloc(sizeof(b3_win_t *) * win_count);
+
+	/**
+	 * Nest every tenth window in a new split to get a deeper tree.
+	 */
+	ws = b3_ws_new("test");
+	for (i = 0; i < win_count; i++) {
+		win_arr[i] = b3_win_new((HWND) (LONG_PTR) (i + 1), 0);
+		b3_ws_add_win(ws, win_arr[i]);
+		if (i % 10 == 0) {
+			b3_ws_split(ws, i % 20 == 0 ? VERTICAL : HORIZONTAL);
+		}
+	}
+
+	error = b3_ws_layout_wins(ws, monitor_area);
+	leaf_area_arr = ws->leaf_area_arr;
+	pending_area_arr = ws->pending_area_arr;
+
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&start);
+	for (i = 0; !error && i < LAYOUT_ROUNDS; i++) {
+		error = b3_ws_layout_wins(ws, monitor_area);
+	}
+	QueryPerformanceCounter(&end);
+
+	fprintf(stdout, "layout of %d windows: %8.1f us/arrange\n",
+			win_count,
+			(double) (end.QuadPart - start.QuadPart) * 1000000.0
+			/ (double) frequency.QuadPart
+			/ (double) LAYOUT_ROUNDS);
+
+	if (!error) {
+		error = b3_test_check_int(ws->leaf_area_count, win_count, "Not all windows were laid out.");
+	}
+
+	if (!error) {
+		error = b3_test_check_void(ws->leaf_area_arr, leaf_area_arr, "Leaf areas were reallocated.");
+	}
+
+	if (!error) {
+		error = b3_test_check_void(ws->pending_area_arr, pending_area_arr, "Pending areas were reallocated.");
+	}
+
+	b3_ws_free(ws);
+	for (i = 0; i < win_count; i++) {
+		b3_win_free(win_arr[i]);
+	}
+	free(win_arr);
+
+	return error;
+}
+
 int
 main(void)
 {
@@ -1479,6 +2017,12 @@ main(void)
 	b3_test(setup, teardown, test_complex_win_rel, "test_complex_win_rel");
 	b3_test(setup, teardown, test_complex_move_1, "test_complex_move_1");
 	b3_test(setup, teardown, test_compled_remove_and_add, "test_complex_remove_and_add");
+	b3_test(setup, teardown, test_contains_win_scaling, "test_contains_win_scaling");
+	b3_test(setup, teardown, test_winman_factory_steady_state, "test_winman_factory_steady_state");
+	b3_test(setup, teardown, test_layout_exact_cover, "test_layout_exact_cover");
+	b3_test(setup, teardown, test_layout_changed_tiles, "test_layout_changed_tiles");
+	b3_test(setup, teardown, test_arrange_batch, "test_arrange_batch");
+	b3_test(setup, teardown, test_layout_benchmark, "test_layout_benchmark");
 
 	//b3_test(setup, teardown, test_simple_arrange, "test_simple_arrange");
 	//b3_test(setup, teardown, test_complex_arrange, "test_complex_arrange");